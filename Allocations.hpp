@@ -0,0 +1,8 @@
+#ifndef DEF_ALLOCATIONS
+#define DEF_ALLOCATIONS
+
+//counter of the allocations of the viewer, shown by the overlay of the performances
+//only compiled with SIMUWORLD_COUNT_ALLOCATIONS: it replaces operator new for the whole program (every thread counts on the same atomic)
+long long get_allocations(); //number of allocations (operator new) since the start
+
+#endif
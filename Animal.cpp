@@ -1,72 +1,63 @@
 #include <SDL2/SDL.h>
 #include <cstdlib>
-#include <fstream>
 #include <iostream>
 #include <cmath>
+#include <limits>
+#include <algorithm>
 #include "Animal.hpp"
-#include "speed.hpp"
 #include "Population.hpp"
-#include "FileReader.hpp"
 
-Animal::Animal(Vector2d const& pos, int specie, int color, Animal *father, Animal *mother)
+Animal::Animal(int id, Vector2d const& pos, int specie, SpecieSettings const& settings, Random const& random, int now, int color, Animal *father, Animal *mother)
 {
+    m_settings = &settings;
+
+    m_id = id;
     m_pos = pos;
     m_dest = pos;
 
     m_specie = specie;
-    m_male = rand() % 2;
+    m_male = random_int(random, 2, RANDOM_SEX, id, now);
 
-    m_parents[0] = father;
-    m_parents[1] = mother;
+    m_parents[0] = father ? father->get_id() : 0;
+    m_parents[1] = mother ? mother->get_id() : 0;
 
-    m_direction = rand() % 4;
+    m_direction = random_int(random, 4, RANDOM_DIRECTION, id, now);
     m_animation = 0;
 
-    m_last_move = SDL_GetTicks();
-    m_last_animation = SDL_GetTicks();
-    m_last_attack = SDL_GetTicks();
-    m_last_update = SDL_GetTicks();
+    m_last_move = now;
+    m_last_animation = now;
+    m_last_attack = now;
+    m_origin = now;
+    m_anchor = 0;
+    m_timer = -1;
 
-    m_alive = true;
+    m_death = -1;
     m_hungry = true;
 
-    FileReader fr;
-    fr.read("settings//specie_" + std::to_string(specie) + ".txt");
-
-    m_damage = fr.getInt("damage");
-    m_speed = fr.getDouble("speed");
-    m_life_expectancy = fr.getInt("life_expectancy");
-    m_maximum_health = fr.getInt("maximum_health");
-    m_hunger_threshold = fr.getInt("hunger_threshold");
-    m_satiated_threshold = fr.getInt("satiated_threshold");
-    m_agressive = fr.getInt("agressive");
-    m_plant_range_detection = fr.getInt("plant_range_detection");
-    m_prey_range_detection = fr.getInt("prey_range_detection");
-    m_partner_range_detection = fr.getInt("partner_range_detection");
-    m_agressivity_range = fr.getInt("agressivity_range");
-    m_search_distance = fr.getInt("search_distance");
-    m_reproduction_time = fr.getInt("reproduction_time");
-    m_decomposition_time = fr.getInt("decomposition_time");
-    m_plants = fr.getVectorInt("plants");
-    m_preys = fr.getVectorInt("preys");
-
-    std::vector <int> colors = fr.getVectorInt("colors");
+    m_life_expectancy = m_settings->life_expectancy;
+
+    std::vector <int> const& colors = m_settings->colors;
     if(color >= 0)
         m_color = color;
     else if(colors.size())
-        m_color = colors[rand() % colors.size()] - 1;
+        m_color = colors[random_int(random, colors.size(), RANDOM_COLOR, id, now)] - 1;
     else
-        m_color = rand() % 8;
+        m_color = random_int(random, 8, RANDOM_COLOR, id, now);
 
-    m_time_before_reproduction = m_reproduction_time;
-    m_time_before_decomposition = m_decomposition_time;
+    m_time_before_reproduction = m_settings->reproduction_time;
+    m_time_before_decomposition = m_settings->decomposition_time;
 
-    m_health = m_hunger_threshold; //starts at his hunger threshold so he immediatly starts looking for food
+    m_health = m_settings->hunger_threshold; //starts at his hunger threshold so he immediatly starts looking for food
 }
 
 Animal::~Animal()
 {}
 
+int Animal::get_id() const
+{
+    return m_id;
+}
+
 int Animal::get_direction() const
 {
     return m_direction;
@@ -79,7 +70,7 @@ int Animal::get_specie() const
 
 double Animal::get_speed() const
 {
-    return m_speed;
+    return m_settings->speed;
 }
 
 int Animal::get_color() const
@@ -92,21 +83,26 @@ int Animal::get_animation() const
     return m_animation;
 }
 
-int Animal::get_health() const
+int Animal::get_health(int now) const
 {
-    return m_health;
+    return get_vitals(now).health;
 }
 
-bool Animal::is_alive() const
+int Animal::get_origin() const
 {
-    return m_alive;
+    return m_origin;
+}
+
+bool Animal::is_alive(int now) const
+{
+    return m_death < 0 && get_update(now) < get_death();
 }
 
 int Animal::get_diet() const
 {
-    if(m_preys.size() && m_plants.size())
+    if(m_settings->preys.size() && m_settings->plants.size())
         return OMNIVORE;
-    if(m_preys.size())
+    if(m_settings->preys.size())
         return CARNIVORE;
     return HERBIVORE;
 }
@@ -126,20 +122,23 @@ void Animal::set_destination(Vector2d const& dest)
     m_dest = dest;
 }
 
-bool Animal::move()
+bool Animal::move(int now)
 {
-    if(SDL_GetTicks() - m_last_move >= 1) //moves at most every ms (and requires at least to move every 0.5s)
+    if(now - m_last_move >= 1) //moves at most every ms of simulated time
     {
         double diff_x = m_dest.x - m_pos.x;
         double diff_y = m_dest.y - m_pos.y;
 
         double distance = sqrt(pow(diff_x, 2) + pow(diff_y, 2));
         if(distance <= 0.25) //has already arrived to his destination
+        {
+            m_last_move = now; //the wait does not count as walking time once he has a new destination
             return true;
+        }
 
         double angle = atan2(diff_y, diff_x);
 
-        double actual_speed = std::min(distance, m_speed * simulation_speed() * std::min(0.5, (SDL_GetTicks() - m_last_move)/1000.0)); //cannot exceed its destination (Could exit the map !)
+        double actual_speed = std::min(distance, m_settings->speed * std::min(0.5, (now - m_last_move)/1000.0)); //at most 0.5s of walking per move, cannot exceed its destination (Could exit the map !)
         m_pos.x += actual_speed * cos(angle);
         m_pos.y += actual_speed * sin(angle);
 
@@ -158,68 +157,103 @@ bool Animal::move()
                 m_direction = TOP;
         }
 
-        if(SDL_GetTicks() - m_last_animation >= 100/simulation_speed()) //update the animation cycle
+        if(now - m_last_animation >= 100) //update the animation cycle
         {
             if(m_animation < 2)
                 m_animation += 1;
             else
                 m_animation = 0;
-            m_last_animation = SDL_GetTicks();
+            m_last_animation = now;
         }
 
-        m_last_move = SDL_GetTicks();
+        m_last_move = now;
     }
     return false;
 }
 
-void Animal::regenerate(int health)
+void Animal::regenerate(int health, int now)
 {
+    settle(now);
     m_health += health;
-    if(m_health > m_maximum_health)
-        m_health = m_maximum_health;
+    if(m_health > m_settings->maximum_health)
+        m_health = m_settings->maximum_health;
+}
+
+int Animal::get_update(int now) const //last update of the vital stats, the first one after m_origin is 1
+{
+    return std::max(m_anchor, (now - m_origin) / 1000);
+}
+
+int Animal::get_death() const //update at which the health or the life expectancy reaches 0
+{
+    if(m_death >= 0)
+        return m_death;
+    return m_anchor + std::max(1, std::min(m_health, m_life_expectancy));
 }
 
-void Animal::update_stats() //update the vital stats (even if he is dead to update the time before his decomposition)
+Animal::Vitals Animal::get_vitals(int now) const //the vital stats at the last update, without stepping through the ones since the anchor
 {
-    if(SDL_GetTicks() - m_last_update >= 1000 / simulation_speed())
+    int update = get_update(now);
+    Vitals vitals = {m_health, m_life_expectancy, m_time_before_reproduction, m_time_before_decomposition, m_death, m_hungry};
+    if(m_death < 0)
     {
-        if(m_alive)
+        int death = get_death();
+        int elapsed = std::min(update, death) - m_anchor; //updates lived since the anchor
+        if(elapsed > 0)
         {
-            m_life_expectancy -= 1;
-            m_health -= 1;
-            m_time_before_reproduction -= 1;
-
-            if(m_health < m_hunger_threshold) //starts hunting again
-                m_hungry = true;
-            else if(m_health > m_satiated_threshold) //stops hunting
-                m_hungry = false;
-
-            if(m_life_expectancy <= 0 || m_health <= 0) //death statement
-            {
-                m_health = 0;
-                m_alive = false;
-            }
+            vitals.health -= elapsed;
+            vitals.life_expectancy -= elapsed;
+            vitals.time_before_reproduction -= elapsed;
+
+            //the hunger changes at the updates only, while the health decreases
+            if(vitals.health < m_settings->hunger_threshold) //starts hunting again
+                vitals.hungry = true;
+            else if(m_health - 1 > m_settings->satiated_threshold) //stopped hunting at the first update
+                vitals.hungry = false;
+        }
+        if(update >= death) //death statement
+        {
+            vitals.health = 0;
+            vitals.death = death;
         }
-        else
-            m_time_before_decomposition -= 1;
-
-        m_last_update = SDL_GetTicks();
     }
+    if(vitals.death >= 0) //the time before his decomposition decreases after his death
+        vitals.time_before_decomposition -= update - vitals.death;
+    return vitals;
 }
 
-void Animal::take_damage(int damage)
+void Animal::settle(int now) //stores the vital stats at the last update, before changing them
 {
+    Vitals vitals = get_vitals(now);
+    m_anchor = get_update(now);
+    m_health = vitals.health;
+    m_life_expectancy = vitals.life_expectancy;
+    m_time_before_reproduction = vitals.time_before_reproduction;
+    m_hungry = vitals.hungry;
+    if(vitals.death >= 0)
+        m_death = vitals.death; //m_time_before_decomposition stays the one at the death
+}
+
+int Animal::get_decomposition_time() const
+{
+    long long update = get_death() + std::max(0, m_time_before_decomposition);
+    return std::min<long long>(m_origin + update * 1000, std::numeric_limits<int>::max());
+}
+
+void Animal::take_damage(int damage, int now)
+{
+    settle(now);
     m_health -= damage;
-    if(m_health <= 0)
-        m_alive = false;
+    if(m_health <= 0 && m_death < 0)
+        m_death = m_anchor;
 }
 
-bool Animal::attack(Animal &target) //returnes if the animal was able to attack (used to add blood)
+bool Animal::attack(Animal &target, int now) //returnes if the animal was able to attack (used to add blood)
 {
-    if(SDL_GetTicks() - m_last_attack >= 1000 / simulation_speed() && m_damage > 0) //animal ready to attack (and can actually do it)
+    if(now - m_last_attack >= 1000 && m_settings->damage > 0) //animal ready to attack (and can actually do it)
     {
-        target.take_damage(m_damage);
-        m_last_attack = SDL_GetTicks();
+        target.take_damage(m_settings->damage, now);
+        m_last_attack = now;
         return true;
     }
     return false;
@@ -228,16 +262,18 @@ bool Animal::attack(Animal &target) //returnes if the animal was able to attack
 bool Animal::is_my_prey(Animal const& target) const
 {
     int target_specie = target.get_specie();
-    for(int n = 0; n < m_preys.size(); n++)
-        if(m_preys[n] == target_specie)
+    std::vector <int> const& preys = m_settings->preys;
+    for(int n = 0; n < preys.size(); n++)
+        if(preys[n] == target_specie)
             return true;
     return false;
 }
 
 bool Animal::is_my_plant(int plant) const
 {
-    for(int n = 0; n < m_plants.size(); n++)
-        if(plant == m_plants[n])
+    std::vector <int> const& plants = m_settings->plants;
+    for(int n = 0; n < plants.size(); n++)
+        if(plant == plants[n])
             return true;
     return false;
 }
@@ -247,67 +283,140 @@ bool Animal::is_male() const
     return m_male;
 }
 
-bool Animal::is_ready_to_reproduce() const
+bool Animal::is_ready_to_reproduce(int now) const
 {
-    return !is_hungry() && (m_time_before_reproduction <= 0 || m_male);
+    Vitals vitals = get_vitals(now);
+    return !vitals.hungry && (vitals.time_before_reproduction <= 0 || m_male);
 }
 
-void Animal::reproduce()
+void Animal::reproduce(int now)
 {
-    m_time_before_reproduction = m_reproduction_time;
+    settle(now);
+    m_time_before_reproduction = m_settings->reproduction_time;
 }
 
-bool Animal::is_decomposed() const
+bool Animal::is_decomposed(int now) const
 {
-    return m_time_before_decomposition <= 0;
+    Vitals vitals = get_vitals(now);
+    return vitals.death >= 0 && vitals.time_before_decomposition <= 0;
 }
 
-bool Animal::is_hungry() const
+bool Animal::is_hungry(int now) const
 {
-    return m_hungry;
+    return get_vitals(now).hungry;
 }
 
-bool Animal::is_agressive() const
+bool Animal::is_agressive(int now) const
 {
-    return m_agressive && m_male && m_health > m_hunger_threshold;
+    return m_settings->agressive && m_male && get_health(now) > m_settings->hunger_threshold;
 }
 
-bool Animal::is_agressive_with(Animal const* target) const
+bool Animal::is_agressive_with(Animal const* target, int now) const
 {
-    return is_agressive() && target->is_alive() && (m_specie == target->get_specie()) && !is_my_parent(target) && !target->is_my_parent(this) && target->is_agressive();
+    return is_agressive(now) && target->is_alive(now) && (m_specie == target->get_specie()) && !is_my_parent(target) && !target->is_my_parent(this) && target->is_agressive(now);
 }
 
-bool Animal::is_my_type(Animal const& target) const
+bool Animal::is_my_type(Animal const& target, int now) const
 {
-    return is_ready_to_reproduce() && target.is_ready_to_reproduce() && target.is_alive() && (m_specie == target.get_specie()) && (m_male != target.is_male());
+    return is_ready_to_reproduce(now) && target.is_ready_to_reproduce(now) && target.is_alive(now) && (m_specie == target.get_specie()) && (m_male != target.is_male());
 }
 
 int Animal::get_plant_range_detection() const
 {
-    return m_plant_range_detection;
+    return m_settings->plant_range_detection;
 }
 
 int Animal::get_prey_range_detection() const
 {
-    return m_prey_range_detection;
+    return m_settings->prey_range_detection;
 }
 
 int Animal::get_partner_range_dection() const
 {
-    return m_partner_range_detection;
+    return m_settings->partner_range_detection;
 }
 
 int Animal::get_agressivity_range() const
 {
-    return m_agressivity_range;
+    return m_settings->agressivity_range;
 }
 
 bool Animal::is_my_parent(Animal const* target) const
 {
-    return (m_parents[0] == target) || (m_parents[1] == target);
+    return (m_parents[0] == target->get_id()) || (m_parents[1] == target->get_id());
 }
 
 int Animal::get_search_distance() const
 {
-    return m_search_distance;
+    return m_settings->search_distance;
+}
+
+int Animal::get_damage() const
+{
+    return m_settings->damage;
+}
+
+int Animal::get_timer() const
+{
+    return m_timer;
+}
+
+void Animal::set_timer(int timer)
+{
+    m_timer = timer;
+}
+
+AnimalState Animal::get_state(int now) const
+{
+    Vitals vitals = get_vitals(now);
+    AnimalState state;
+    state.pos = m_pos;
+    state.dest = m_dest;
+    state.id = m_id;
+    state.father = m_parents[0];
+    state.mother = m_parents[1];
+    state.specie = m_specie;
+    state.color = m_color;
+    state.direction = m_direction;
+    state.animation = m_animation;
+    state.male = m_male;
+    state.alive = vitals.death < 0;
+    state.hungry = vitals.hungry;
+    state.health = vitals.health;
+    state.life_expectancy = vitals.life_expectancy;
+    state.time_before_reproduction = vitals.time_before_reproduction;
+    state.time_before_decomposition = vitals.time_before_decomposition;
+
+    //the timers are saved relatively to now
+    state.since_last_move = now - m_last_move;
+    state.since_last_animation = now - m_last_animation;
+    state.since_last_attack = now - m_last_attack;
+    state.since_last_update = (now - m_origin) % 1000;
+    return state;
+}
+
+void Animal::set_state(AnimalState const& state, int now)
+{
+    m_pos = state.pos;
+    m_dest = state.dest;
+    m_id = state.id;
+    m_parents[0] = state.father;
+    m_parents[1] = state.mother;
+    m_specie = state.specie;
+    m_color = state.color;
+    m_direction = state.direction;
+    m_animation = state.animation;
+    m_male = state.male;
+    m_death = state.alive ? -1 : 0;
+    m_hungry = state.hungry;
+    m_health = state.health;
+    m_life_expectancy = state.life_expectancy;
+    m_time_before_reproduction = state.time_before_reproduction;
+    m_time_before_decomposition = state.time_before_decomposition;
+
+    m_last_move = now - state.since_last_move;
+    m_last_animation = now - state.since_last_animation;
+    m_last_attack = now - state.since_last_attack;
+    m_origin = now - state.since_last_update; //the state is the one of the last update
+    m_anchor = 0;
 }
@@ -3,6 +3,9 @@
 
 #include <SDL2/SDL.h>
 #include <vector>
+#include <cstdint>
+#include "Scenario.hpp"
+#include "Random.hpp"
 
 enum direction
 {
@@ -20,18 +23,30 @@ struct Vector2d
     double x, y;
 };
 
+struct AnimalState //everything that changes during the life of an animal (the rest comes from the settings of its specie)
+{
+    Vector2d pos, dest;
+    int32_t id, father, mother;
+    int32_t specie, color, direction, animation;
+    int32_t male, alive, hungry;
+    int32_t health, life_expectancy, time_before_reproduction, time_before_decomposition;
+    int32_t since_last_move, since_last_animation, since_last_attack, since_last_update; //in ms
+};
+
 class Animal
 {
 public:
-    Animal(Vector2d const& pos, int specie, int color = -1, Animal *father = NULL, Animal *mother = NULL);
+    Animal(int id, Vector2d const& pos, int specie, SpecieSettings const& settings, Random const& random, int now, int color = -1, Animal *father = NULL, Animal *mother = NULL);
     ~Animal();
 
+    int get_id() const;
     int get_direction() const;
     int get_specie() const;
     double get_speed() const;
     int get_color() const;
     int get_animation() const;
-    int get_health() const;
+    int get_health(int now) const;
+    int get_origin() const; //the vital stats decrease by one every second after it
     int get_diet() const;
     Vector2d get_position() const;
     Vector2d get_destination() const;
@@ -40,31 +55,53 @@ public:
     int get_partner_range_dection() const;
     int get_agressivity_range() const;
     int get_search_distance() const;
+    int get_damage() const;
+    int get_decomposition_time() const; //predicted from the current state, a later damage can bring it forward
+
+    int get_timer() const;
+    void set_timer(int timer);
+
+    AnimalState get_state(int now) const;
+    void set_state(AnimalState const& state, int now);
 
     void set_destination(Vector2d const& des);
 
-    void regenerate(int health);
+    void regenerate(int health, int now);
 
-    bool move();
-    void update_stats();
+    bool move(int now);
 
-    void take_damage(int damage);
-    bool attack(Animal &target);
-    void reproduce();
+    void take_damage(int damage, int now);
+    bool attack(Animal &target, int now);
+    void reproduce(int now);
 
-    bool is_alive() const;
+    bool is_alive(int now) const;
     bool is_male() const;
-    bool is_hungry() const;
+    bool is_hungry(int now) const;
     bool is_my_prey(Animal const& target) const;
     bool is_my_plant(int plant) const;
-    bool is_my_type(Animal const& target) const;
+    bool is_my_type(Animal const& target, int now) const;
     bool is_my_parent(Animal const* target) const;
-    bool is_agressive() const;
-    bool is_agressive_with(Animal const* target) const;
-    bool is_ready_to_reproduce() const;
-    bool is_decomposed() const;
+    bool is_agressive(int now) const;
+    bool is_agressive_with(Animal const* target, int now) const;
+    bool is_ready_to_reproduce(int now) const;
+    bool is_decomposed(int now) const;
 
 private:
+    struct Vitals
+    {
+        int health, life_expectancy, time_before_reproduction, time_before_decomposition;
+        int death; //update at which the animal died, -1 if it is alive
+        bool hungry;
+    };
+
+    int get_update(int now) const;
+    int get_death() const;
+    Vitals get_vitals(int now) const;
+    void settle(int now);
+
+    SpecieSettings const* m_settings; //shared by all the animals of the specie
+
+    int m_id;
     int m_specie;
     int m_color;
     int m_direction;
@@ -75,38 +112,24 @@ private:
     Vector2d m_pos;
     Vector2d m_dest;
 
-    int m_last_update;
+    //the vital stats decrease by one every second after m_origin (an update): they are only stored at the last update
+    //where they have been changed (m_anchor) and computed from there for the following ones
+    int m_origin;
+    int m_anchor;
+    int m_timer; //handle in the timers of the population, -1 if not scheduled
     int m_health;
-    int m_maximum_health;
-    double m_speed;
     int m_life_expectancy;
 
     int m_last_attack;
-    int m_damage;
 
     bool m_male;
     int m_time_before_reproduction;
-    int m_time_before_decomposition;
+    int m_time_before_decomposition; //at the death
+    int m_death; //update, -1 if the animal was alive at the anchor
 
     bool m_hungry;
-    int m_hunger_threshold;
-    int m_satiated_threshold;
-
-    bool m_agressive;
-    bool m_alive;
-
-    int m_plant_range_detection;
-    int m_prey_range_detection;
-    int m_partner_range_detection;
-    int m_agressivity_range;
-    int m_search_distance;
-
-    int m_reproduction_time;
-    int m_decomposition_time;
 
-    std::vector <int> m_preys;
-    std::vector <int> m_plants;
-    Animal* m_parents[2];
+    int m_parents[2]; //ids of the parents (0 if unknown), they may have disappeared since
 };
 
 
@@ -0,0 +1,281 @@
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include "Benchmark.hpp"
+#include "World.hpp"
+
+static std::vector <int> parse_list(std::string const& text) //"1000,10000" -> {1000, 10000}
+{
+    std::vector <int> values;
+    size_t start = 0;
+    while(start < text.size())
+    {
+        size_t end = text.find(',', start);
+        if(end == std::string::npos)
+            end = text.size();
+        if(end > start)
+            values.push_back(std::stoi(text.substr(start, end - start)));
+        start = end + 1;
+    }
+    return values;
+}
+
+Benchmark::Benchmark()
+{
+    m_settings = "settings";
+    m_seed = 1;
+    m_repetitions = 5;
+    m_sizes = {1000, 10000};
+    m_ranges = {5, 20};
+    m_herbivore = 0;
+    m_carnivore = 0;
+}
+
+bool Benchmark::load(int argc, char *argv[])
+{
+    for(int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string option = argv[i], value = argv[i + 1];
+        try
+        {
+            if(option == "--settings")
+                m_settings = value;
+            else if(option == "--seed")
+                m_seed = std::stoul(value);
+            else if(option == "--repetitions")
+                m_repetitions = std::max(1, std::stoi(value));
+            else if(option == "--sizes")
+                m_sizes = parse_list(value);
+            else if(option == "--ranges")
+                m_ranges = parse_list(value);
+            else if(option == "--output")
+                m_output_name = value;
+            else
+            {
+                std::cerr << "option inconnue : " << option << std::endl;
+                return false;
+            }
+        }
+        catch(std::exception const&) //std::stoi and parse_list
+        {
+            std::cerr << "valeur invalide pour " << option << " : " << value << std::endl;
+            return false;
+        }
+    }
+    if(argc % 2 == 0)
+    {
+        std::cerr << "valeur manquante pour " << argv[argc - 1] << std::endl;
+        return false;
+    }
+    if(m_sizes.empty() || m_ranges.empty() || *std::min_element(m_sizes.begin(), m_sizes.end()) <= 0 || *std::min_element(m_ranges.begin(), m_ranges.end()) <= 0)
+    {
+        std::cerr << "--sizes et --ranges doivent etre des listes de nombres positifs" << std::endl;
+        return false;
+    }
+
+    if(!m_base.load(m_settings))
+    {
+        for(int i = 0; i < m_base.get_errors().size(); i++)
+            std::cerr << m_base.get_errors()[i] << std::endl;
+        return false;
+    }
+
+    //the first herbivore of the settings, and the first carnivore (made to hunt it)
+    for(int i = 0; i < m_base.species.size(); i++)
+    {
+        SpecieSettings const& specie = m_base.species[i];
+        if(!m_herbivore && specie.plants.size() && specie.preys.empty())
+            m_herbivore = i + 1;
+        else if(!m_carnivore && specie.preys.size() && specie.plants.empty())
+            m_carnivore = i + 1;
+    }
+    if(!m_herbivore || !m_carnivore)
+    {
+        std::cerr << m_settings << " : il faut au moins un herbivore et un carnivore" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+Scenario Benchmark::make_scenario(int animals, int range) const
+{
+    Scenario scenario = m_base;
+
+    //a quarter of carnivores, only hunting the herbivore
+    std::fill(scenario.species_init.begin(), scenario.species_init.end(), 0);
+    scenario.species_init[m_herbivore - 1] = animals - animals / 4;
+    scenario.species_init[m_carnivore - 1] = animals / 4;
+    scenario.species[m_carnivore - 1].preys.assign(1, m_herbivore);
+
+    int const species[2] = {m_herbivore, m_carnivore};
+    for(int i = 0; i < 2; i++)
+    {
+        SpecieSettings &specie = scenario.species[species[i] - 1];
+        specie.plant_range_detection = range;
+        specie.prey_range_detection = range;
+        specie.partner_range_detection = range;
+        specie.search_distance = range;
+    }
+    return scenario;
+}
+
+void Benchmark::measure(std::string const& stage, Scenario const& scenario, int animals, int range,
+                        std::function<void(World&)> const& prepare, std::function<long long(World&)> const& stage_function)
+{
+    BenchmarkResult result = {stage, animals, range, 0, 0, 0, 0};
+    for(int r = 0; r < m_repetitions; r++)
+    {
+        //not timed: a new world, with its grid of animals up to date
+        World world(scenario, m_seed + r);
+        world.generate();
+        world.get_population().update_grid(*world.get_population().m_tiles[0]);
+        if(prepare)
+            prepare(world);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        result.calls += stage_function(world);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        result.total_ms += ms;
+        result.min_ms = r ? std::min(result.min_ms, ms) : ms;
+    }
+    result.ns_per_call = result.calls ? result.total_ms * 1e6 / result.calls : 0;
+    m_results.push_back(result);
+
+    std::cerr << stage << " (" << animals << " animaux, portee " << range << ") : " << result.ns_per_call << " ns" << std::endl;
+}
+
+void Benchmark::run()
+{
+    int herbivore = m_herbivore, carnivore = m_carnivore;
+    for(int s = 0; s < m_sizes.size(); s++)
+    {
+        for(int r = 0; r < m_ranges.size(); r++)
+        {
+            int animals = m_sizes[s], range = m_ranges[r];
+            Scenario scenario = make_scenario(animals, range);
+
+            measure("grid_rebuild", scenario, animals, range, nullptr, [](World &world)
+            {
+                for(int i = 0; i < 10; i++)
+                    world.get_population().update_grid(*world.get_population().m_tiles[0]);
+                return 10LL;
+            });
+
+            measure("AI_find_plant", scenario, animals, range, nullptr, [herbivore](World &world)
+            {
+                Population &population = world.get_population();
+                Tile &tile = *population.m_tiles[0]; //a single tile: the whole map
+                long long calls = 0;
+                for(int i = 0; i < tile.animals.size(); i++)
+                    if(tile.animals[i]->get_specie() == herbivore)
+                    {
+                        population.AI_find_plant(tile, i, world.get_map());
+                        calls += 1;
+                    }
+                return calls;
+            });
+
+            measure("AI_find_prey", scenario, animals, range, nullptr, [carnivore](World &world)
+            {
+                Population &population = world.get_population();
+                Tile &tile = *population.m_tiles[0];
+                long long calls = 0;
+                for(int i = 0; i < tile.animals.size(); i++)
+                    if(tile.animals[i]->get_specie() == carnivore)
+                    {
+                        population.AI_find_prey(tile, i);
+                        calls += 1;
+                    }
+                return calls;
+            });
+
+            measure("AI_find_partner", scenario, animals, range, nullptr, [](World &world)
+            {
+                Population &population = world.get_population();
+                Tile &tile = *population.m_tiles[0];
+                for(int i = 0; i < tile.animals.size(); i++)
+                    population.AI_find_partner(tile, i, 0);
+                return (long long)tile.animals.size();
+            });
+
+            measure("AI_check_current_location", scenario, animals, range, nullptr, [](World &world)
+            {
+                Population &population = world.get_population();
+                Tile &tile = *population.m_tiles[0];
+                long long calls = 0;
+                for(int i = 0; i < tile.animals.size(); i++, calls++) //animals can be eaten during the pass
+                    population.AI_check_current_location(tile, i, world.get_map(), 0);
+                return calls;
+            });
+
+            //every animal has somewhere to go
+            measure("Animal::move", scenario, animals, range, [](World &world)
+            {
+                Population &population = world.get_population();
+                Tile &tile = *population.m_tiles[0];
+                for(int i = 0; i < tile.animals.size(); i++)
+                    population.AI_simulate_search(tile, i, 0);
+            }, [](World &world)
+            {
+                Population &population = world.get_population();
+                Tile &tile = *population.m_tiles[0];
+                for(int i = 0; i < tile.animals.size(); i++)
+                    tile.animals[i]->move(100);
+                return (long long)tile.animals.size();
+            });
+
+            measure("Map::update", scenario, animals, range, nullptr, [](World &world)
+            {
+                for(int t = 1; t <= 10; t++)
+                    world.get_map().update(t * 1000);
+                return 10LL;
+            });
+
+            measure("stats_sampling", scenario, animals, range, nullptr, [](World &world)
+            {
+                for(int t = 1; t <= 10; t++)
+                    world.get_stats().update(world.get_population(), world.get_map(), t * 1000);
+                return 10LL;
+            });
+        }
+    }
+}
+
+bool Benchmark::write_json() const
+{
+    std::ofstream file;
+    if(!m_output_name.empty())
+    {
+        file.open(m_output_name);
+        if(!file)
+        {
+            std::cerr << m_output_name << " n'a pas pu etre ouvert" << std::endl;
+            return false;
+        }
+    }
+    std::ostream &output = m_output_name.empty() ? std::cout : file;
+
+    output << "{\n";
+    output << "  \"settings\": \"" << m_settings << "\",\n";
+    output << "  \"seed\": " << m_seed << ",\n";
+    output << "  \"repetitions\": " << m_repetitions << ",\n";
+    output << "  \"map\": [" << m_base.width << ", " << m_base.height << "],\n";
+    output << "  \"herbivore\": " << m_herbivore << ",\n";
+    output << "  \"carnivore\": " << m_carnivore << ",\n";
+    output << "  \"results\": [\n";
+    for(int i = 0; i < m_results.size(); i++)
+    {
+        BenchmarkResult const& result = m_results[i];
+        output << "    {\"stage\": \"" << result.stage << "\", \"animals\": " << result.animals << ", \"range\": " << result.range
+               << ", \"calls\": " << result.calls << ", \"total_ms\": " << result.total_ms << ", \"min_ms\": " << result.min_ms
+               << ", \"ns_per_call\": " << result.ns_per_call << "}" << (i + 1 < m_results.size() ? "," : "") << "\n";
+    }
+    output << "  ]\n";
+    output << "}" << std::endl;
+    return true;
+}
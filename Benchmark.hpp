@@ -0,0 +1,52 @@
+#ifndef DEF_BENCHMARK
+#define DEF_BENCHMARK
+
+#include <string>
+#include <vector>
+#include <functional>
+#include "Scenario.hpp"
+
+class World;
+
+struct BenchmarkResult
+{
+    std::string stage;
+    int animals;
+    int range;
+    long long calls; //over all the repetitions
+    double total_ms;
+    double min_ms; //fastest repetition
+    double ns_per_call;
+};
+
+//times each stage of the update in isolation, on synthetic worlds generated from a seed
+//each repetition starts from a new world so that every stage always works on the same data
+class Benchmark
+{
+public:
+    Benchmark();
+
+    bool load(int argc, char *argv[]); //--settings, --seed, --repetitions, --sizes a,b,c, --ranges a,b,c, --output
+    void run();
+    bool write_json() const; //to --output, or to the standard output
+
+private:
+    Scenario make_scenario(int animals, int range) const;
+    void measure(std::string const& stage, Scenario const& scenario, int animals, int range,
+                 std::function<void(World&)> const& prepare, std::function<long long(World&)> const& stage_function);
+
+    Scenario m_base;
+    std::string m_settings;
+    unsigned int m_seed;
+    int m_repetitions;
+    std::vector <int> m_sizes;
+    std::vector <int> m_ranges;
+    std::string m_output_name;
+
+    int m_herbivore; //species used by the synthetic worlds
+    int m_carnivore;
+
+    std::vector <BenchmarkResult> m_results;
+};
+
+#endif
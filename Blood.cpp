@@ -4,15 +4,14 @@
 #include <fstream>
 #include "Blood.hpp"
 #include "Camera.hpp"
-#include "FileReader.hpp"
 
-Blood::Blood(SDL_Renderer *renderer)
+Blood::Blood(SDL_Renderer *renderer, int disappearance_time)
 {
-    m_texture = IMG_LoadTexture(renderer, "map//blood.png");
+    m_textured = (renderer != NULL);
+    m_texture = m_textured ? IMG_LoadTexture(renderer, "map//blood.png") : NULL;
 
-    FileReader fr;
-    fr.read("settings//blood.txt");
-    m_disappearance_time = fr.getInt("disappearance_time");
+    m_disappearance_time = disappearance_time;
+    m_time = 0;
 }
 
 Blood::~Blood()
@@ -22,7 +21,7 @@ Blood::~Blood()
 
 bool Blood::get_error() const
 {
-    if(!m_texture)
+    if(!m_texture && m_textured)
     {
         SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Erreur de texture", "map//blood.png n'a pas pu etre ouvert", NULL);
         return true;
@@ -30,32 +29,77 @@ bool Blood::get_error() const
     return false;
 }
 
-void Blood::update()
+void Blood::update(int now)
 {
+    m_time = now;
     for(int i = 0; i < m_blood.size(); i++)
-        if(SDL_GetTicks() - m_blood[i]->t >= m_disappearance_time)
+        if(m_time - m_blood[i]->t >= m_disappearance_time)
             m_blood.erase(m_blood.begin() + i);
 }
 
-void Blood::render(SDL_Renderer *renderer, SDL_Point const& winsize, Camera const& camera)
+void Blood::render(SDL_Renderer *renderer, SDL_Point const& winsize, Camera const& camera, std::vector <StainSnapshot> const& stains) const
 {
     SDL_Point camera_pos = camera.get_position();
     int camera_zoom = camera.get_zoom();
 
     SDL_Rect position = {0, 0, camera_zoom, camera_zoom};
-    for(int i = 0; i < m_blood.size(); i++)
+    for(int i = 0; i < stains.size(); i++)
     {
-        SDL_SetTextureAlphaMod(m_texture, 1.0 * (m_disappearance_time - (SDL_GetTicks() - m_blood[i]->t)) / m_disappearance_time * 255); //smooth disappearance
-        position.x = m_blood[i]->pos.x * camera_zoom - camera_pos.x - camera_zoom/2;
-        position.y = m_blood[i]->pos.y * camera_zoom - camera_pos.y - camera_zoom/2;
+        SDL_SetTextureAlphaMod(m_texture, stains[i].alpha);
+        position.x = stains[i].pos.x * camera_zoom - camera_pos.x - camera_zoom/2;
+        position.y = stains[i].pos.y * camera_zoom - camera_pos.y - camera_zoom/2;
         if(position.x + camera_zoom > 0 && position.x < winsize.x && position.y + camera_zoom > 0 && position.y < winsize.y)
             SDL_RenderCopy(renderer, m_texture, NULL, &position);
     }
 }
 
+void Blood::snapshot(SDL_Rect const& area, std::vector <StainSnapshot> &stains) const
+{
+    stains.clear();
+    for(int i = 0; i < m_blood.size(); i++)
+    {
+        Vector2d const& pos = m_blood[i]->pos;
+        if(pos.x + 1 >= area.x && pos.x - 1 < area.x + area.w && pos.y + 1 >= area.y && pos.y - 1 < area.y + area.h)
+            stains.push_back({pos, int(1.0 * (m_disappearance_time - (m_time - m_blood[i]->t)) / m_disappearance_time * 255)}); //smooth disappearance
+    }
+}
+
+void Blood::save_state(CheckpointWriter &cp) const
+{
+    cp.add_value(int32_t(m_blood.size()));
+    for(int i = 0; i < m_blood.size(); i++)
+    {
+        cp.add_value(m_blood[i]->pos);
+        cp.add_value(int32_t(m_time - m_blood[i]->t)); //age of the stain
+    }
+}
+
+bool Blood::load_state(CheckpointReader &cp, int now)
+{
+    m_time = now;
+    int32_t number = 0;
+    if(!cp.read_value(number) || number < 0)
+        return false;
+
+    for(int i = 0; i < m_blood.size(); i++)
+        delete m_blood[i];
+    m_blood.clear();
+
+    Vector2d pos;
+    int32_t age = 0;
+    for(int i = 0; i < number; i++)
+    {
+        if(!cp.read_value(pos) || !cp.read_value(age))
+            return false;
+        add_stain(pos);
+        m_blood.back()->t = m_time - age;
+    }
+    return true;
+}
+
 void Blood::add_stain(Vector2d const& pos)
 {
     m_blood.push_back(new Stain);
     m_blood[m_blood.size()-1]->pos = pos;
-    m_blood[m_blood.size()-1]->t = SDL_GetTicks();
+    m_blood[m_blood.size()-1]->t = m_time;
 }
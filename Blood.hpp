@@ -4,6 +4,8 @@
 #include <SDL2/SDL.h>
 #include <vector>
 #include "Camera.hpp"
+#include "Checkpoint.hpp"
+#include "Snapshot.hpp"
 
 struct Stain
 {
@@ -14,21 +16,27 @@ struct Stain
 class Blood
 {
 public:
-    Blood(SDL_Renderer *renderer);
+    Blood(SDL_Renderer *renderer, int disappearance_time);
     ~Blood();
 
     bool get_error() const;
 
-    void update();
-    void render(SDL_Renderer *renderer, SDL_Point const& winsize, class Camera const& camera);
+    void update(int now);
+    void render(SDL_Renderer *renderer, SDL_Point const& winsize, class Camera const& camera, std::vector <StainSnapshot> const& stains) const;
+    void snapshot(SDL_Rect const& area, std::vector <StainSnapshot> &stains) const;
 
     void add_stain(Vector2d const& pos);
 
+    void save_state(CheckpointWriter &cp) const;
+    bool load_state(CheckpointReader &cp, int now);
+
 private:
     std::vector <Stain*> m_blood;
     SDL_Texture *m_texture;
+    bool m_textured;
 
     int m_disappearance_time;
+    int m_time; //simulated time of the last update
 };
 
 #endif
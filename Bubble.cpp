@@ -19,19 +19,19 @@ Bubble::~Bubble()
     TTF_CloseFont(m_font);
 }
 
-void Bubble::render(SDL_Renderer *renderer, SDL_Point const& pos, Animal *target, int camera_zoom)
+void Bubble::render(SDL_Renderer *renderer, SDL_Point const& pos, AnimalSnapshot const& target, int camera_zoom)
 {
     std::string text;
-    int health = target->get_health();
+    int health = target.health;
     if(health > 0)
         text = std::to_string(health) + " PV";
-    else if(target->is_male())
+    else if(target.male)
         text = "mort";
     else
         text = "morte";
     render_text(renderer, pos, text, 0, camera_zoom);
 
-    if(target->is_male())
+    if(target.male)
         text = "male";
     else
         text = "femelle";
@@ -4,7 +4,7 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include <string>
-#include "Animal.hpp"
+#include "Snapshot.hpp"
 
 class Bubble
 {
@@ -12,7 +12,7 @@ public:
     Bubble();
     ~Bubble();
 
-    void render(SDL_Renderer *renderer, SDL_Point const& pos, Animal *target, int camera_zoom);
+    void render(SDL_Renderer *renderer, SDL_Point const& pos, AnimalSnapshot const& target, int camera_zoom);
 
 private:
     void render_text(SDL_Renderer *renderer, SDL_Point const& pos, std::string text, int line, int camera_zoom);
@@ -1,22 +1,34 @@
 #include <SDL2/SDL.h>
+#include <algorithm>
 #include "Camera.hpp"
 
 Camera::Camera()
 {
     m_pos = {0, 0};
     m_zoom = 32;
-    m_focus = NULL;
+    m_focus = 0;
 }
 
 Camera::~Camera()
 {}
 
+void Camera::set_focus(int id)
+{
+    m_focus = id;
+}
+
+void Camera::center_on(Vector2d const& pos, SDL_Point const& winsize)
+{
+    m_pos.x = (pos.x * m_zoom) - winsize.x/2;
+    m_pos.y = (pos.y * m_zoom) - winsize.y/2;
+}
+
 void Camera::move(int x, int y)
 {
     m_pos.x -= x;
     m_pos.y -= y;
 
-    m_focus = NULL;
+    m_focus = 0;
 }
 
 void Camera::zoom(SDL_Point const& mouse_pos, bool in)
@@ -53,26 +65,30 @@ int Camera::get_zoom() const
     return m_zoom;
 }
 
-void Camera::update(Population const& population, SDL_Point const& winsize) //keeps the camera following the animal focused (if there is one)
+void Camera::update(Snapshot const& snapshot, Snapshot const& previous, double progress, SDL_Point const& winsize) //keeps the camera following the animal focused (if there is one)
 {
-    if(population.is_inside(m_focus)) //the animal still exists
-    {
-        m_pos.x = (m_focus->get_position().x * m_zoom) - winsize.x/2;
-        m_pos.y = (m_focus->get_position().y * m_zoom) - winsize.y/2;
-    }
+    AnimalSnapshot const* focus = m_focus ? snapshot.get_animal(m_focus) : NULL;
+    if(focus) //the animal still exists
+        center_on(snapshot.get_position(*focus, previous, progress), winsize);
 }
 
-void Camera::focus_on_animal(Population const& population, Stats const& stats, SDL_Point const& mouse_pos)
+int Camera::focus_on_animal(Snapshot const& snapshot, Stats const& stats, SDL_Point const& mouse_pos)
 {
     if(mouse_pos.x < 100) //search an animal of the specified specie (if there is one)
+        return std::max(0, stats.get_mouse_focus(mouse_pos));
+
+    //focus on the animal targeted by the mouse (if there is one), the nearest less than half a block away
+    Vector2d pos = {1.0*(mouse_pos.x + m_pos.x)/m_zoom, 1.0*(mouse_pos.y + m_pos.y)/m_zoom};
+    double shortest = 0.25; //squared distance
+    m_focus = 0;
+    for(int i = 0; i < snapshot.animals.size(); i++)
     {
-        int specie = stats.get_mouse_focus(mouse_pos);
-        if(specie > 0) //the mouse is focused on a specie
-            m_focus = population.get_animal(specie);
-    }
-    else //focus on the animal targeted by the mouse (if there is one)
-    {
-        Vector2d pos = {1.0*(mouse_pos.x + m_pos.x)/m_zoom, 1.0*(mouse_pos.y + m_pos.y)/m_zoom};
-        m_focus = population.get_animal(pos);
+        double dx = snapshot.animals[i].pos.x - pos.x, dy = snapshot.animals[i].pos.y - pos.y;
+        if(dx * dx + dy * dy <= shortest)
+        {
+            shortest = dx * dx + dy * dy;
+            m_focus = snapshot.animals[i].id;
+        }
     }
+    return 0;
 }
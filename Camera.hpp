@@ -5,6 +5,7 @@
 #include "Population.hpp"
 #include "Animal.hpp"
 #include "Stats.hpp"
+#include "Snapshot.hpp"
 
 class Camera
 {
@@ -12,21 +13,22 @@ public:
     Camera();
     ~Camera();
 
-    void set_focus(Animal *focus);
+    void set_focus(int id); //0 for none
+    void center_on(Vector2d const& pos, SDL_Point const& winsize);
 
-    void focus_on_animal(class Population const& population, class Stats const& stats, SDL_Point const& mouse_pos);
+    int focus_on_animal(Snapshot const& snapshot, class Stats const& stats, SDL_Point const& mouse_pos); //returns the specie clicked in the stats (the animal is chosen in the world), 0 otherwise
 
     int get_zoom() const;
     SDL_Point get_position() const;
 
     void move(int x, int y);
     void zoom(SDL_Point const& winsize, bool in);
-    void update(class Population const& population, SDL_Point const& winsize);
+    void update(Snapshot const& snapshot, Snapshot const& previous, double progress, SDL_Point const& winsize);
 
 private:
     SDL_Point m_pos;
     int m_zoom;
-    Animal *m_focus;
+    int m_focus; //id of the animal followed
 };
 
 #endif
@@ -0,0 +1,205 @@
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include "Checkpoint.hpp"
+
+#ifndef WIN32
+    #include <sys/types.h>
+    #include <sys/stat.h>
+    #include <sys/mman.h>
+    #include <sys/uio.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <limits.h>
+#endif
+
+CheckpointWriter::CheckpointWriter()
+{}
+
+void CheckpointWriter::add(void const* data, size_t size)
+{
+    if(size)
+        m_blocks.push_back({data, size});
+}
+
+void CheckpointWriter::add_copy(void const* data, size_t size)
+{
+    m_copies.push_back(std::string(static_cast<char const*>(data), size)); //a deque never moves its elements
+    add(m_copies.back().data(), size);
+}
+
+bool CheckpointWriter::write(std::string const& file_name)
+{
+    std::string temporary = file_name + ".tmp";
+#ifndef WIN32
+    int file = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if(file < 0)
+        return false;
+
+    //the blocks go straight from the arrays of the simulation to the file, IOV_MAX at a time
+    std::vector <struct iovec> vectors;
+    bool success = true;
+    for(int first = 0; first < m_blocks.size() && success; first += IOV_MAX)
+    {
+        vectors.clear();
+        size_t expected = 0;
+        for(int i = first; i < std::min<int>(m_blocks.size(), first + IOV_MAX); i++)
+        {
+            vectors.push_back({const_cast<void*>(m_blocks[i].data), m_blocks[i].size});
+            expected += m_blocks[i].size;
+        }
+
+        int current = 0;
+        while(expected > 0 && success) //writev may stop in the middle of a block
+        {
+            ssize_t written = writev(file, &vectors[current], vectors.size() - current);
+            if(written <= 0)
+            {
+                success = false;
+                break;
+            }
+            expected -= written;
+            while(current < vectors.size() && written >= vectors[current].iov_len)
+            {
+                written -= vectors[current].iov_len;
+                current += 1;
+            }
+            if(current < vectors.size())
+            {
+                vectors[current].iov_base = static_cast<char*>(vectors[current].iov_base) + written;
+                vectors[current].iov_len -= written;
+            }
+        }
+    }
+    if(success)
+        success = fsync(file) == 0;
+    ::close(file);
+#else
+    std::ofstream file(temporary.c_str(), std::ios::binary);
+    for(int i = 0; i < m_blocks.size() && file; i++)
+        file.write(static_cast<char const*>(m_blocks[i].data), m_blocks[i].size);
+    bool success = bool(file);
+    file.close();
+    std::remove(file_name.c_str()); //rename does not overwrite on windows
+#endif
+
+    if(!success || std::rename(temporary.c_str(), file_name.c_str()))
+    {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+void CheckpointWriter::write(std::vector <unsigned char> &buffer) const
+{
+    size_t size = 0;
+    for(int i = 0; i < m_blocks.size(); i++)
+        size += m_blocks[i].size;
+
+    buffer.resize(size);
+    size_t position = 0;
+    for(int i = 0; i < m_blocks.size(); i++)
+    {
+        memcpy(buffer.data() + position, m_blocks[i].data, m_blocks[i].size);
+        position += m_blocks[i].size;
+    }
+}
+
+CheckpointReader::CheckpointReader()
+{
+    m_data = NULL;
+    m_size = 0;
+    m_cursor = 0;
+    m_error = false;
+    m_mapped = false;
+}
+
+CheckpointReader::~CheckpointReader()
+{
+    close();
+}
+
+bool CheckpointReader::open(std::string const& file_name)
+{
+    close();
+#ifndef WIN32
+    int file = ::open(file_name.c_str(), O_RDONLY);
+    if(file < 0)
+        return false;
+
+    struct stat info;
+    if(fstat(file, &info) == 0 && info.st_size > 0)
+    {
+        void *mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if(mapping != MAP_FAILED)
+        {
+            m_data = static_cast<unsigned char const*>(mapping);
+            m_size = info.st_size;
+            m_mapped = true;
+        }
+    }
+    ::close(file); //the mapping stays valid
+#else
+    std::ifstream file(file_name.c_str(), std::ios::binary);
+    if(file)
+    {
+        m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+    }
+#endif
+    m_cursor = 0;
+    m_error = (m_data == NULL);
+    return !m_error;
+}
+
+void CheckpointReader::open(std::vector <unsigned char> const& buffer)
+{
+    close();
+    m_data = buffer.data();
+    m_size = buffer.size();
+    m_cursor = 0;
+    m_error = false;
+}
+
+void CheckpointReader::close()
+{
+#ifndef WIN32
+    if(m_data && m_mapped)
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+    m_mapped = false;
+    m_buffer.clear();
+    m_data = NULL;
+    m_size = 0;
+    m_cursor = 0;
+}
+
+void const* CheckpointReader::view(size_t size)
+{
+    if(m_error || size > m_size - m_cursor)
+    {
+        m_error = true;
+        return NULL;
+    }
+    void const* data = m_data + m_cursor;
+    m_cursor += size;
+    return data;
+}
+
+bool CheckpointReader::read(void *data, size_t size)
+{
+    void const* source = view(size);
+    if(source && size)
+        memcpy(data, source, size);
+    return source != NULL;
+}
+
+bool CheckpointReader::get_error() const
+{
+    return m_error;
+}
@@ -0,0 +1,62 @@
+#ifndef DEF_CHECKPOINT
+#define DEF_CHECKPOINT
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstddef>
+#include <cstdint>
+
+//checkpoint file: "SWCHKPT" magic, version, then the sections written by World::save_checkpoint (map, population, blood, scent, stats)
+//the values are written with the memory layout of the machine, the version and the record sizes are checked when reading
+static const int32_t CHECKPOINT_VERSION = 7;
+
+class CheckpointWriter
+{
+public:
+    CheckpointWriter();
+
+    void add(void const* data, size_t size); //the data is written from its place, it must stay valid until write()
+    void add_copy(void const* data, size_t size);
+    template <typename T> void add_value(T const& value) { add_copy(&value, sizeof(T)); }
+
+    bool write(std::string const& file_name); //writes into a temporary file renamed at the end (never leaves a half checkpoint)
+    void write(std::vector <unsigned char> &buffer) const; //in memory, for example a message between the processes of a cluster
+
+private:
+    struct Block
+    {
+        void const* data;
+        size_t size;
+    };
+
+    std::vector <Block> m_blocks;
+    std::deque <std::string> m_copies;
+};
+
+class CheckpointReader
+{
+public:
+    CheckpointReader();
+    ~CheckpointReader();
+
+    bool open(std::string const& file_name); //maps the whole file in memory
+    void open(std::vector <unsigned char> const& buffer); //reads a buffer in memory, it must stay valid until close()
+    void close();
+
+    void const* view(size_t size); //pointer to the next bytes inside the mapping (NULL if the file is too short)
+    bool read(void *data, size_t size);
+    template <typename T> bool read_value(T &value) { return read(&value, sizeof(T)); }
+
+    bool get_error() const;
+
+private:
+    unsigned char const* m_data;
+    size_t m_size;
+    size_t m_cursor;
+    bool m_error;
+    bool m_mapped;
+    std::vector <unsigned char> m_buffer; //used instead of the mapping where mmap is not available
+};
+
+#endif
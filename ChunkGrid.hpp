@@ -0,0 +1,151 @@
+#ifndef DEF_CHUNKGRID
+#define DEF_CHUNKGRID
+
+#include <vector>
+#include <cstddef>
+
+//grid of a value per block of the map, stored in square chunks of 2^SHIFT blocks allocated only where a block differs from the fill value
+//the directory of the chunks is a flat array (O(1) lookup), the memory used grows with the occupied area instead of the size of the map
+template <typename T, int SHIFT = 6>
+class ChunkGrid
+{
+public:
+    static const int CHUNK_SIZE = 1 << SHIFT;
+
+    ChunkGrid(): m_width(0), m_height(0), m_columns(0), m_chunks_number(0)
+    {}
+
+    ~ChunkGrid()
+    {
+        clear();
+    }
+
+    void reset(int width, int height, T const& fill) //every block takes the fill value
+    {
+        clear();
+        m_width = width;
+        m_height = height;
+        m_fill = fill;
+        m_columns = (width + CHUNK_SIZE - 1) >> SHIFT;
+        m_directory.assign(size_t(m_columns) * ((height + CHUNK_SIZE - 1) >> SHIFT), NULL);
+    }
+
+    int get_width() const
+    {
+        return m_width;
+    }
+
+    int get_height() const
+    {
+        return m_height;
+    }
+
+    int get_chunks_number() const //allocated chunks
+    {
+        return m_chunks_number;
+    }
+
+    size_t get_directory_size() const
+    {
+        return m_directory.size();
+    }
+
+    T const& get(int x, int y) const //the fill value where no chunk is allocated
+    {
+        Chunk const* chunk = m_directory[get_chunk_index(x, y)];
+        return chunk ? chunk->blocks[get_block_index(x, y)] : m_fill;
+    }
+
+    T& at(int x, int y) //allocates the chunk if needed, the caller keeps the count of used blocks with add_used
+    {
+        Chunk *&chunk = m_directory[get_chunk_index(x, y)];
+        if(!chunk)
+        {
+            chunk = new Chunk(m_fill);
+            m_chunks_number += 1;
+        }
+        return chunk->blocks[get_block_index(x, y)];
+    }
+
+    void set(int x, int y, T const& value) //keeps the count of used blocks and frees the chunk once it only contains the fill value
+    {
+        size_t index = get_chunk_index(x, y);
+        if(!m_directory[index] && value == m_fill)
+            return;
+        T &block = at(x, y);
+        add_used(x, y, (value != m_fill) - (block != m_fill));
+        block = value;
+        release_if_unused(x, y);
+    }
+
+    void add_used(int x, int y, int delta) //blocks of the chunk of (x, y) which are not the fill value
+    {
+        Chunk *chunk = m_directory[get_chunk_index(x, y)];
+        if(chunk)
+            chunk->used += delta;
+    }
+
+    void release_if_unused(int x, int y) //frees the chunk of (x, y) if none of its blocks is used
+    {
+        Chunk *&chunk = m_directory[get_chunk_index(x, y)];
+        if(chunk && chunk->used <= 0)
+        {
+            delete chunk;
+            chunk = NULL;
+            m_chunks_number -= 1;
+        }
+    }
+
+    size_t get_chunk_index(int x, int y) const
+    {
+        return size_t(y >> SHIFT) * m_columns + (x >> SHIFT);
+    }
+
+    T const* get_chunk(size_t index) const //blocks of a chunk row after row, NULL if it is not allocated
+    {
+        return m_directory[index] ? m_directory[index]->blocks : NULL;
+    }
+
+    void get_chunk_origin(size_t index, int &x, int &y) const //first block of a chunk
+    {
+        x = int(index % m_columns) << SHIFT;
+        y = int(index / m_columns) << SHIFT;
+    }
+
+private:
+    struct Chunk
+    {
+        explicit Chunk(T const& fill): used(0)
+        {
+            for(int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; i++)
+                blocks[i] = fill;
+        }
+
+        T blocks[CHUNK_SIZE * CHUNK_SIZE];
+        int used;
+    };
+
+    ChunkGrid(ChunkGrid const&);
+    ChunkGrid& operator=(ChunkGrid const&);
+
+    static size_t get_block_index(int x, int y)
+    {
+        return size_t(y & (CHUNK_SIZE - 1)) * CHUNK_SIZE + (x & (CHUNK_SIZE - 1));
+    }
+
+    void clear()
+    {
+        for(size_t i = 0; i < m_directory.size(); i++)
+            delete m_directory[i];
+        m_directory.clear();
+        m_chunks_number = 0;
+    }
+
+    int m_width, m_height;
+    int m_columns; //chunks per row of the directory
+    T m_fill;
+    std::vector <Chunk*> m_directory;
+    int m_chunks_number;
+};
+
+#endif
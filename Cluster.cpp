@@ -0,0 +1,537 @@
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <unordered_map>
+#include "Cluster.hpp"
+#include "Population.hpp"
+
+template <typename T> static void add_records(CheckpointWriter &message, std::vector <T> const& records) //the records must stay valid until the message is sent
+{
+    message.add_value(int32_t(records.size()));
+    message.add(records.data(), records.size() * sizeof(T));
+}
+
+template <typename T> static bool read_records(CheckpointReader &message, std::vector <T> &records) //appended to the records
+{
+    int32_t number = 0;
+    if(!message.read_value(number) || number < 0)
+        return false;
+    void const* data = message.view(size_t(number) * sizeof(T));
+    if(!data)
+        return false;
+    size_t first = records.size();
+    records.resize(first + number);
+    if(number)
+        memcpy(&records[first], data, size_t(number) * sizeof(T)); //the buffer gives no alignment guarantee
+    return true;
+}
+
+ClusterCoordinator::ClusterCoordinator(Scenario const& scenario, std::vector <Transport*> const& transports): m_scenario(scenario), m_transports(transports), m_stats(scenario, false)
+{
+    int workers = m_transports.size();
+    for(int i = 0; i < workers; i++)
+        m_ends.push_back((long long)m_scenario.width * (i + 1) / workers); //same widths until the first recut
+
+    m_bucket = std::max(1, (m_scenario.width + 1023) / 1024);
+    m_histogram.assign((m_scenario.width + m_bucket - 1) / m_bucket, 0);
+    m_owned.assign(workers, 0);
+    m_borders.resize(workers);
+    m_newcomers.resize(workers);
+    m_values.assign(m_scenario.get_species_number() + m_scenario.get_resources_number(), 0);
+
+    m_next_id = 1;
+    m_time = 0;
+}
+
+bool ClusterCoordinator::start(std::string const& settings, uint64_t seed)
+{
+    //every worker generates the whole world and keeps the animals of its strip: the ids of the first animals are the same everywhere
+    for(int i = 0; i < m_scenario.species_init.size(); i++)
+        m_next_id += m_scenario.species_init[i];
+
+    for(int w = 0; w < m_transports.size(); w++)
+    {
+        CheckpointWriter message;
+        message.add_value(int32_t(CLUSTER_HELLO));
+        message.add_value(int32_t(settings.size()));
+        message.add(settings.data(), settings.size());
+        message.add_value(uint64_t(seed));
+        message.add_value(int32_t(w));
+        message.add_value(int32_t(w ? m_ends[w - 1] : 0));
+        message.add_value(int32_t(m_ends[w]));
+        message.add_value(int32_t(m_bucket));
+        if(!send(w, message))
+            return false;
+    }
+
+    std::fill(m_histogram.begin(), m_histogram.end(), 0);
+    std::fill(m_values.begin(), m_values.end(), 0);
+    for(int w = 0; w < m_transports.size(); w++)
+    {
+        CheckpointReader message;
+        if(!receive(w, CLUSTER_REPORT, message) || !read_report(w, message))
+            return false;
+    }
+    return true;
+}
+
+bool ClusterCoordinator::update(int dt)
+{
+    m_time += dt;
+    int workers = m_transports.size();
+    int width = Population::get_halo_width(m_scenario, dt);
+
+    for(int w = 0; w < workers; w++)
+    {
+        CheckpointWriter message;
+        message.add_value(int32_t(CLUSTER_STEP));
+        message.add_value(int32_t(m_time));
+        message.add_value(int32_t(width));
+        add_records(message, m_newcomers[w]);
+        if(!send(w, message))
+            return false;
+        m_newcomers[w].clear();
+    }
+
+    for(int w = 0; w < workers; w++)
+    {
+        CheckpointReader message;
+        m_borders[w].clear();
+        if(!receive(w, CLUSTER_BORDER, message) || !read_records(message, m_borders[w]))
+            return false;
+    }
+
+    //each worker gets the animals of the others which are near its strip
+    std::vector <AnimalState> halo;
+    for(int j = 0; j < workers; j++)
+    {
+        int begin = j ? m_ends[j - 1] : 0;
+        halo.clear();
+        for(int w = 0; w < workers; w++)
+            for(int i = 0; i < m_borders[w].size() && w != j; i++)
+                if(m_borders[w][i].pos.x >= begin - width && m_borders[w][i].pos.x < m_ends[j] + width)
+                    halo.push_back(m_borders[w][i]);
+
+        CheckpointWriter message;
+        message.add_value(int32_t(CLUSTER_HALO));
+        add_records(message, halo);
+        if(!send(j, message))
+            return false;
+    }
+
+    m_effects.clear();
+    m_plants.clear();
+    m_births.assign(workers, 0);
+    for(int w = 0; w < workers; w++)
+    {
+        CheckpointReader message;
+        if(!receive(w, CLUSTER_RESULT, message) || !read_records(message, m_effects) || !read_records(message, m_plants) || !message.read_value(m_births[w]))
+            return false;
+    }
+
+    //every worker applies all the results in the same order: their maps stay the same, and the ids of the newborns follow the order of the workers
+    recut();
+    for(int w = 0; w < workers; w++)
+    {
+        CheckpointWriter message;
+        message.add_value(int32_t(CLUSTER_MERGE));
+        add_records(message, m_effects);
+        add_records(message, m_plants);
+        message.add_value(int32_t(m_next_id));
+        add_records(message, m_ends);
+        if(!send(w, message))
+            return false;
+        m_next_id += m_births[w];
+    }
+
+    std::fill(m_histogram.begin(), m_histogram.end(), 0);
+    std::fill(m_values.begin(), m_values.end(), 0);
+    for(int w = 0; w < workers; w++)
+    {
+        CheckpointReader message;
+        if(!receive(w, CLUSTER_REPORT, message) || !read_report(w, message))
+            return false;
+    }
+
+    m_stats.update(m_values, m_time);
+    return true;
+}
+
+void ClusterCoordinator::stop()
+{
+    CheckpointWriter message;
+    message.add_value(int32_t(CLUSTER_STOP));
+    for(int w = 0; w < m_transports.size(); w++)
+        send(w, message);
+}
+
+bool ClusterCoordinator::read_report(int worker, CheckpointReader &message)
+{
+    std::vector <int32_t> values, histogram;
+    std::vector <AnimalState> leaving;
+    int32_t owned = 0;
+    if(!read_records(message, values) || !message.read_value(owned) || !read_records(message, histogram) || !read_records(message, leaving))
+        return false;
+    if(values.size() != m_values.size() || histogram.size() != m_histogram.size())
+        return false;
+
+    for(int i = 0; i < m_scenario.get_species_number(); i++)
+        m_values[i] += values[i];
+    for(int i = m_scenario.get_species_number(); i < m_values.size() && worker == 0; i++) //all the workers have the same map
+        m_values[i] = values[i];
+
+    m_owned[worker] = owned;
+    for(int i = 0; i < m_histogram.size(); i++)
+        m_histogram[i] += histogram[i];
+
+    for(int i = 0; i < leaving.size(); i++)
+        m_newcomers[get_worker(leaving[i].pos.x)].push_back(leaving[i]);
+    return true;
+}
+
+void ClusterCoordinator::recut() //on the histograms of the last reports, when a worker has 25% more animals than the average
+{
+    int workers = m_transports.size(), total = 0, largest = 0;
+    for(int w = 0; w < workers; w++)
+    {
+        total += m_owned[w];
+        largest = std::max(largest, m_owned[w]);
+    }
+    if(largest <= total * 5 / (4 * workers) + 64)
+        return;
+
+    std::vector <int> ends;
+    Population::cut(m_histogram, workers, ends);
+    for(int w = 0; w < workers; w++)
+        m_ends[w] = std::min(m_scenario.width, ends[w] * m_bucket);
+    m_ends.back() = m_scenario.width;
+}
+
+int ClusterCoordinator::get_worker(double x) const
+{
+    for(int w = 0; w < m_ends.size() - 1; w++)
+        if(x < m_ends[w])
+            return w;
+    return m_ends.size() - 1;
+}
+
+bool ClusterCoordinator::send(int worker, CheckpointWriter const& message)
+{
+    message.write(m_buffer);
+    return m_transports[worker]->send(m_buffer);
+}
+
+bool ClusterCoordinator::receive(int worker, int type, CheckpointReader &message)
+{
+    if(!m_transports[worker]->receive(m_buffer))
+        return false;
+    message.open(m_buffer);
+    int32_t received = 0;
+    return message.read_value(received) && received == type;
+}
+
+int ClusterCoordinator::get_time() const
+{
+    return m_time;
+}
+
+int ClusterCoordinator::get_animals_number() const
+{
+    int number = 0;
+    for(int w = 0; w < m_owned.size(); w++)
+        number += m_owned[w];
+    return number;
+}
+
+Stats& ClusterCoordinator::get_stats()
+{
+    return m_stats;
+}
+
+
+ClusterWorker::ClusterWorker(Transport &transport): m_transport(transport)
+{
+    m_world = NULL;
+    m_index = 0;
+    m_begin = 0;
+    m_end = 0;
+    m_bucket = 1;
+    m_time = 0;
+}
+
+ClusterWorker::~ClusterWorker()
+{
+    delete m_world;
+}
+
+int ClusterWorker::run()
+{
+    CheckpointReader message;
+    if(!receive(CLUSTER_HELLO, message) || !hello(message) || !send_report(0))
+        return 1;
+
+    while(m_transport.receive(m_buffer))
+    {
+        message.open(m_buffer);
+        int32_t type = 0;
+        if(!message.read_value(type))
+            return 1;
+        if(type == CLUSTER_STOP)
+            return 0;
+        if(type != CLUSTER_STEP || !step(message))
+            return 1;
+    }
+    return 1; //the coordinator has stopped without warning
+}
+
+bool ClusterWorker::hello(CheckpointReader &message)
+{
+    int32_t length = 0, index = 0, begin = 0, end = 0, bucket = 0;
+    uint64_t seed = 0;
+    char const* settings = NULL;
+    if(!message.read_value(length) || length < 0 || !(settings = static_cast<char const*>(message.view(length))))
+        return false;
+    if(!message.read_value(seed) || !message.read_value(index) || !message.read_value(begin) || !message.read_value(end) || !message.read_value(bucket) || bucket < 1)
+        return false;
+
+    if(!m_scenario.load(std::string(settings, length)))
+    {
+        for(int i = 0; i < m_scenario.get_errors().size(); i++)
+            std::cerr << m_scenario.get_errors()[i] << std::endl;
+        return false;
+    }
+    m_index = index;
+    m_begin = begin;
+    m_end = end;
+    m_bucket = bucket;
+
+    m_world = new World(m_scenario, seed);
+    m_world->generate();
+
+    //the animals of the other strips are only known through the halo
+    Population &population = m_world->get_population();
+    Tile &tile = *population.m_tiles[0];
+    tile.deferred = true;
+    int kept = 0;
+    for(int i = 0; i < tile.animals.size(); i++)
+    {
+        double x = tile.animals[i]->get_position().x;
+        if(x >= m_begin && x < m_end)
+            tile.animals[kept++] = tile.animals[i];
+        else
+        {
+            population.unschedule(tile.animals[i]);
+            delete tile.animals[i];
+        }
+    }
+    tile.animals.resize(kept);
+    population.m_animals = tile.animals;
+    return true;
+}
+
+bool ClusterWorker::step(CheckpointReader &message)
+{
+    Population &population = m_world->get_population();
+    Map &map = m_world->get_map();
+    Tile &tile = *population.m_tiles[0];
+
+    int32_t now = 0, width = 0;
+    std::vector <AnimalState> states;
+    if(!message.read_value(now) || !message.read_value(width) || !read_records(message, states))
+        return false;
+    for(int i = 0; i < states.size(); i++) //the animals which have entered the strip
+    {
+        Animal *animal = make_animal(states[i], m_time);
+        if(!animal)
+            return false;
+        tile.animals.push_back(animal);
+        population.schedule(animal);
+    }
+
+    map.update(now);
+    population.update_timers(now); //before the states are sent to the halos of the other workers
+    population.update_scent(now); //only the animals of the strip leave a scent in the grids of this worker
+
+    //the animals near the borders, for the halos of the other workers
+    states.clear();
+    for(int i = 0; i < tile.animals.size(); i++)
+    {
+        double x = tile.animals[i]->get_position().x;
+        if(x < m_begin + width || x >= m_end - width)
+            states.push_back(tile.animals[i]->get_state(m_time));
+    }
+    CheckpointWriter border;
+    border.add_value(int32_t(CLUSTER_BORDER));
+    add_records(border, states);
+    if(!send(border))
+        return false;
+
+    states.clear();
+    if(!receive(CLUSTER_HALO, message) || !read_records(message, states))
+        return false;
+    tile.halo.clear();
+    for(int i = 0; i < states.size(); i++)
+    {
+        Animal *copy = make_animal(states[i], m_time);
+        if(!copy)
+            return false;
+        tile.halo.push_back(*copy);
+        delete copy;
+    }
+
+    population.update_grid(tile);
+    population.AI_main(tile, map, now);
+
+    //what the animals of the strip have done to the halo, the plants eaten and the number of births
+    std::vector <ClusterEffect> effects(tile.effects.size());
+    for(int i = 0; i < tile.effects.size(); i++)
+        effects[i] = {tile.effects[i].type, tile.halo[tile.effects[i].halo].get_id(), tile.effects[i].value};
+    std::vector <ClusterPlant> plants(tile.plants.size());
+    for(int i = 0; i < tile.plants.size(); i++)
+        plants[i] = {tile.plants[i].x, tile.plants[i].y};
+    tile.effects.clear();
+    tile.plants.clear();
+
+    CheckpointWriter result;
+    result.add_value(int32_t(CLUSTER_RESULT));
+    add_records(result, effects);
+    add_records(result, plants);
+    result.add_value(int32_t(tile.births.size()));
+    if(!send(result))
+        return false;
+
+    //the results of all the workers
+    int32_t first_id = 0;
+    std::vector <int32_t> ends;
+    effects.clear();
+    plants.clear();
+    if(!receive(CLUSTER_MERGE, message) || !read_records(message, effects) || !read_records(message, plants) || !message.read_value(first_id) || !read_records(message, ends))
+        return false;
+    if(ends.size() <= m_index)
+        return false;
+
+    if(!effects.empty())
+    {
+        std::unordered_map <int, Animal*> owned;
+        for(int i = 0; i < tile.animals.size(); i++)
+            owned[tile.animals[i]->get_id()] = tile.animals[i];
+
+        for(int i = 0; i < effects.size(); i++)
+        {
+            std::unordered_map <int, Animal*>::iterator target = owned.find(effects[i].target);
+            if(target == owned.end())
+                continue;
+            switch(effects[i].type)
+            {
+            case EFFECT_DAMAGE:
+                target->second->take_damage(effects[i].value, now);
+                if(!target->second->is_alive(now))
+                    population.schedule(target->second);
+                break;
+            case EFFECT_REPRODUCE:
+                target->second->reproduce(now);
+                break;
+            case EFFECT_EATEN:
+                tile.animals.erase(std::remove(tile.animals.begin(), tile.animals.end(), target->second), tile.animals.end());
+                population.unschedule(target->second);
+                break;
+            }
+        }
+    }
+
+    for(int i = 0; i < plants.size(); i++)
+        map.remove_resource(plants[i].x, plants[i].y);
+
+    for(int i = 0; i < tile.births.size(); i++)
+    {
+        TileBirth const& birth = tile.births[i];
+        tile.animals.push_back(new Animal(first_id + i, birth.pos, birth.specie, m_scenario.species[birth.specie - 1], population.m_random, now, birth.color, birth.father, birth.mother));
+        population.schedule(tile.animals.back());
+    }
+    tile.births.clear();
+
+    for(int i = 0; i < tile.killed.size(); i++)
+        population.schedule(tile.killed[i]);
+    tile.killed.clear();
+    for(int i = 0; i < tile.eaten.size(); i++)
+        population.unschedule(tile.eaten[i]);
+    tile.eaten.clear();
+
+    for(int i = 0; i < tile.stains.size(); i++)
+        population.m_blood->add_stain(tile.stains[i]);
+    tile.stains.clear();
+    population.m_blood->update(now);
+
+    m_begin = m_index ? ends[m_index - 1] : 0;
+    m_end = ends[m_index];
+    m_time = now;
+    population.m_time = now;
+    return send_report(now);
+}
+
+bool ClusterWorker::send_report(int now)
+{
+    Population &population = m_world->get_population();
+    Map &map = m_world->get_map();
+    Tile &tile = *population.m_tiles[0];
+
+    //the animals which have left the strip go to their new worker
+    std::vector <AnimalState> leaving;
+    int kept = 0;
+    for(int i = 0; i < tile.animals.size(); i++)
+    {
+        double x = tile.animals[i]->get_position().x;
+        if(x >= m_begin && x < m_end)
+            tile.animals[kept++] = tile.animals[i];
+        else
+        {
+            leaving.push_back(tile.animals[i]->get_state(now));
+            population.unschedule(tile.animals[i]);
+            delete tile.animals[i];
+        }
+    }
+    tile.animals.resize(kept);
+    population.m_animals = tile.animals;
+
+    std::vector <int32_t> values;
+    for(int specie = 0; specie < m_scenario.get_species_number(); specie++)
+        values.push_back(population.get_number(specie + 1));
+    for(int resource = 0; resource < m_scenario.get_resources_number(); resource++)
+        values.push_back(map.get_number(resource + 1));
+
+    std::vector <int32_t> histogram((m_scenario.width + m_bucket - 1) / m_bucket, 0);
+    for(int i = 0; i < tile.animals.size(); i++)
+        histogram[std::min<int>(histogram.size() - 1, int(tile.animals[i]->get_position().x) / m_bucket)] += 1;
+
+    CheckpointWriter report;
+    report.add_value(int32_t(CLUSTER_REPORT));
+    add_records(report, values);
+    report.add_value(int32_t(tile.animals.size()));
+    add_records(report, histogram);
+    add_records(report, leaving);
+    return send(report);
+}
+
+Animal* ClusterWorker::make_animal(AnimalState const& state, int now) const //NULL if the state does not come from this scenario
+{
+    if(state.specie < 1 || state.specie > m_scenario.get_species_number())
+        return NULL;
+    Animal *animal = new Animal(state.id, state.pos, state.specie, m_scenario.species[state.specie - 1], m_world->get_population().m_random, now, state.color);
+    animal->set_state(state, now);
+    return animal;
+}
+
+bool ClusterWorker::send(CheckpointWriter const& message)
+{
+    message.write(m_buffer);
+    return m_transport.send(m_buffer);
+}
+
+bool ClusterWorker::receive(int type, CheckpointReader &message)
+{
+    if(!m_transport.receive(m_buffer))
+        return false;
+    message.open(m_buffer);
+    int32_t received = 0;
+    return message.read_value(received) && received == type;
+}
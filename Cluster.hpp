@@ -0,0 +1,106 @@
+#ifndef DEF_CLUSTER
+#define DEF_CLUSTER
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Scenario.hpp"
+#include "Stats.hpp"
+#include "World.hpp"
+#include "Transport.hpp"
+#include "Checkpoint.hpp"
+
+//a world split between processes: each worker simulates the animals of a vertical strip of the map, like the tiles of Population,
+//and the coordinator drives the clock, passes on what crosses the borders of the strips and gathers the stats
+//
+//a step is three exchanges between the coordinator and every worker:
+//STEP (time, newcomers) -> BORDER (animals near the borders of the strip)
+//HALO (the animals of the others near the strip) -> RESULT (what was done to them, plants eaten, births)
+//MERGE (the results of all the workers, new strips) -> REPORT (stats, animals which have left the strip)
+enum ClusterMessageType
+{
+    CLUSTER_HELLO = 1, CLUSTER_STEP, CLUSTER_BORDER, CLUSTER_HALO, CLUSTER_RESULT, CLUSTER_MERGE, CLUSTER_REPORT, CLUSTER_STOP
+};
+
+struct ClusterEffect //done by an animal to an animal of another worker
+{
+    int32_t type;
+    int32_t target; //id
+    int32_t value;
+};
+
+struct ClusterPlant
+{
+    int32_t x, y;
+};
+
+class ClusterCoordinator
+{
+public:
+    ClusterCoordinator(Scenario const& scenario, std::vector <Transport*> const& transports);
+
+    bool start(std::string const& settings, uint64_t seed); //the workers generate the same world and keep their strip
+    bool update(int dt); //advances the whole world by dt ms of simulated time
+    void stop();
+
+    int get_time() const;
+    int get_animals_number() const;
+    Stats& get_stats();
+
+private:
+    bool send(int worker, CheckpointWriter const& message);
+    bool receive(int worker, int type, CheckpointReader &message);
+    bool read_report(int worker, CheckpointReader &message);
+    void recut();
+    int get_worker(double x) const;
+
+    Scenario const& m_scenario;
+    std::vector <Transport*> m_transports;
+    std::vector <unsigned char> m_buffer;
+
+    std::vector <int> m_ends; //last column (excluded) of the strip of each worker
+    int m_bucket; //columns per bucket of the histograms sent by the workers
+    std::vector <int> m_histogram; //animals of each bucket
+    std::vector <int> m_owned; //animals of each worker
+
+    std::vector < std::vector <AnimalState> > m_borders; //of each worker, during a step
+    std::vector < std::vector <AnimalState> > m_newcomers; //for each worker, at the next step
+    std::vector <ClusterEffect> m_effects;
+    std::vector <ClusterPlant> m_plants;
+    std::vector <int32_t> m_births;
+    std::vector <int> m_values; //stats of the last step, summed over the workers
+
+    int m_next_id;
+    int m_time;
+    Stats m_stats;
+};
+
+class ClusterWorker
+{
+public:
+    explicit ClusterWorker(Transport &transport);
+    ~ClusterWorker();
+
+    int run(); //until the coordinator stops it, returns the exit code of the process
+
+private:
+    bool hello(CheckpointReader &message);
+    bool step(CheckpointReader &message);
+    bool receive(int type, CheckpointReader &message);
+    bool send(CheckpointWriter const& message);
+    bool send_report(int now);
+
+    Animal* make_animal(AnimalState const& state, int now) const;
+
+    Transport &m_transport;
+    std::vector <unsigned char> m_buffer;
+
+    Scenario m_scenario;
+    World *m_world;
+    int m_index;
+    int m_begin, m_end; //columns of the strip
+    int m_bucket;
+    int m_time;
+};
+
+#endif
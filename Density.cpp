@@ -0,0 +1,209 @@
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include "Density.hpp"
+#include "Population.hpp"
+#include "Profiler.hpp"
+
+static int floor_divide(int value, int divisor) //rounded down for the negative values too
+{
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+DensityMap::DensityMap(int width, int height, int species_number, int cell)
+{
+    m_width = std::max(1, width);
+    m_height = std::max(1, height);
+    m_cell = std::max(1, cell);
+    m_columns = (m_width + m_cell - 1) / m_cell;
+    m_rows = (m_height + m_cell - 1) / m_cell;
+    m_species_number = species_number;
+    m_time = -1;
+    m_tables.resize(m_species_number + 1);
+    m_error = false;
+}
+
+DensityMap::~DensityMap()
+{
+    m_file.close();
+}
+
+void DensityMap::build(Population const& population, int now)
+{
+    PROFILE_ZONE("DensityMap::build");
+    std::vector <Animal*> const& animals = population.m_animals;
+    WorkerPool *pool = population.m_pool;
+    int parts = pool ? pool->get_threads_number() : 1;
+    m_parts.resize(parts, std::vector < std::vector <int32_t> >(m_species_number + 1));
+
+    //each part of the animals is counted in its own cells, the tables then sum the parts
+    std::function<void(int)> count = [this, &animals, now, parts](int part)
+    {
+        std::vector < std::vector <int32_t> > &counts = m_parts[part];
+        for(int specie = 0; specie < counts.size(); specie++)
+            counts[specie].clear(); //the memory is kept for the next build
+        size_t end = animals.size() * (part + 1) / parts;
+        for(size_t i = animals.size() * part / parts; i < end; i++)
+        {
+            Animal const& animal = *animals[i];
+            if(!animal.is_alive(now))
+                continue;
+            Vector2d pos = animal.get_position();
+            int x = std::max(0, std::min(m_columns - 1, int(pos.x) / m_cell)), y = std::max(0, std::min(m_rows - 1, int(pos.y) / m_cell));
+            std::vector <int32_t> &cells = counts[animal.get_specie()];
+            if(cells.empty())
+                cells.assign(m_columns * m_rows, 0);
+            cells[y * m_columns + x] += 1;
+        }
+    };
+    std::function<void(int)> build = [this](int table)
+    {
+        build_table(table);
+    };
+    if(pool)
+    {
+        pool->run(parts, count);
+        pool->run(m_tables.size(), build);
+    }
+    else
+    {
+        count(0);
+        for(int table = 0; table < m_tables.size(); table++)
+            build_table(table);
+    }
+
+    m_time = now;
+    if(m_file.is_open())
+        write_raster();
+}
+
+void DensityMap::build_table(int table)
+{
+    std::vector <int32_t const*> sources; //counts of the parts to sum
+    for(int part = 0; part < m_parts.size(); part++)
+        for(int specie = (table ? table : 1); specie <= (table ? table : m_species_number); specie++)
+            if(!m_parts[part][specie].empty())
+                sources.push_back(m_parts[part][specie].data());
+
+    std::vector <int32_t> &sums = m_tables[table];
+    if(sources.empty())
+    {
+        sums.clear();
+        return;
+    }
+    sums.assign((m_columns + 1) * (m_rows + 1), 0);
+    for(int y = 0; y < m_rows; y++)
+    {
+        int32_t row = 0;
+        for(int x = 0; x < m_columns; x++)
+        {
+            for(int s = 0; s < sources.size(); s++)
+                row += sources[s][y * m_columns + x];
+            sums[(y + 1) * (m_columns + 1) + x + 1] = sums[y * (m_columns + 1) + x + 1] + row;
+        }
+    }
+}
+
+int DensityMap::get_sum(int table, int x, int y) const
+{
+    return m_tables[table][y * (m_columns + 1) + x];
+}
+
+SDL_Rect DensityMap::get_cells(SDL_Rect const& area) const
+{
+    int x0 = std::max(0, floor_divide(area.x, m_cell)), y0 = std::max(0, floor_divide(area.y, m_cell));
+    int x1 = std::min(m_columns, floor_divide(area.x + area.w + m_cell - 1, m_cell)), y1 = std::min(m_rows, floor_divide(area.y + area.h + m_cell - 1, m_cell));
+    SDL_Rect cells = {x0, y0, std::max(0, x1 - x0), std::max(0, y1 - y0)};
+    return cells;
+}
+
+int DensityMap::count(int specie, SDL_Rect const& area) const
+{
+    if(specie < 0 || specie > m_species_number || m_tables[specie].empty())
+        return 0;
+    SDL_Rect cells = get_cells(area);
+    if(!cells.w || !cells.h)
+        return 0;
+    return get_sum(specie, cells.x + cells.w, cells.y + cells.h) - get_sum(specie, cells.x, cells.y + cells.h) - get_sum(specie, cells.x + cells.w, cells.y) + get_sum(specie, cells.x, cells.y);
+}
+
+double DensityMap::get_density(int specie, SDL_Rect const& area) const
+{
+    int x0 = std::max(0, floor_divide(area.x, m_cell)) * m_cell, y0 = std::max(0, floor_divide(area.y, m_cell)) * m_cell;
+    int x1 = std::min(m_width, floor_divide(area.x + area.w + m_cell - 1, m_cell) * m_cell), y1 = std::min(m_height, floor_divide(area.y + area.h + m_cell - 1, m_cell) * m_cell);
+    if(x1 <= x0 || y1 <= y0)
+        return 0;
+    return double(count(specie, area)) / (double(x1 - x0) * (y1 - y0));
+}
+
+bool DensityMap::export_rasters(std::string const& file_name)
+{
+    m_file.close();
+    m_file.open(file_name.c_str(), std::ios::binary | std::ios::trunc);
+    if(!m_file)
+        return false;
+    int32_t header[] = {DENSITY_VERSION, m_columns, m_rows, m_cell, m_species_number};
+    m_file.write("SWDENS\0", 8);
+    m_file.write(reinterpret_cast<char const*>(header), sizeof(header));
+    m_error = false;
+    return bool(m_file);
+}
+
+void DensityMap::write_raster()
+{
+    int32_t present = 0;
+    for(int specie = 1; specie <= m_species_number; specie++)
+        present += !m_tables[specie].empty();
+
+    size_t cells = m_columns * m_rows;
+    m_buffer.resize(2 * sizeof(int32_t) + present * (sizeof(int32_t) + cells * sizeof(uint16_t)));
+    unsigned char *data = m_buffer.data();
+    int32_t time = m_time;
+    memcpy(data, &time, sizeof(int32_t));
+    memcpy(data + sizeof(int32_t), &present, sizeof(int32_t));
+    data += 2 * sizeof(int32_t);
+    for(int32_t specie = 1; specie <= m_species_number; specie++)
+    {
+        if(m_tables[specie].empty())
+            continue;
+        memcpy(data, &specie, sizeof(int32_t));
+        data += sizeof(int32_t);
+        for(int y = 0; y < m_rows; y++)
+        {
+            for(int x = 0; x < m_columns; x++)
+            {
+                int number = get_sum(specie, x + 1, y + 1) - get_sum(specie, x, y + 1) - get_sum(specie, x + 1, y) + get_sum(specie, x, y);
+                uint16_t value = std::min(number, 65535);
+                memcpy(data, &value, sizeof(uint16_t));
+                data += sizeof(uint16_t);
+            }
+        }
+    }
+    if(!m_file.write(reinterpret_cast<char const*>(m_buffer.data()), m_buffer.size()) || !m_file.flush())
+        m_error = true;
+}
+
+bool DensityMap::get_error() const
+{
+    return m_error;
+}
+
+int DensityMap::get_time() const
+{
+    return m_time;
+}
+
+int DensityMap::get_cell() const
+{
+    return m_cell;
+}
+
+int DensityMap::get_columns() const
+{
+    return m_columns;
+}
+
+int DensityMap::get_rows() const
+{
+    return m_rows;
+}
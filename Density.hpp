@@ -0,0 +1,54 @@
+#ifndef DEF_DENSITY
+#define DEF_DENSITY
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+//number of animals alive of each specie on a coarse grid of cells, kept as summed-area tables: any rectangle of cells is counted in O(1)
+//the tables are rebuilt from the animals at a fixed interval (the stats one by default), each rebuild can be appended to a raster file:
+//"SWDENS" magic, version, columns, rows, size of a cell in blocks, number of species,
+//then for each rebuild the time, the number of species present and for each of them its number and the count of each cell (uint16, row after row)
+static const int32_t DENSITY_VERSION = 1;
+static const int DENSITY_CELL = 10; //blocks per side of a cell by default
+
+class DensityMap
+{
+public:
+    DensityMap(int width, int height, int species_number, int cell = DENSITY_CELL); //size of the map in blocks
+    ~DensityMap();
+
+    void build(class Population const& population, int now); //counts the animals in parallel on the threads of the population
+    bool export_rasters(std::string const& file_name); //every following build is appended to the file
+    bool get_error() const; //a raster could not be written
+
+    int get_time() const; //of the last build, -1 before the first one
+    int get_cell() const;
+    int get_columns() const;
+    int get_rows() const;
+    SDL_Rect get_cells(SDL_Rect const& area) const; //cells touched by the area, clipped to the map
+    int count(int specie, SDL_Rect const& area) const; //animals of the specie (0 for all of them) in the area in blocks, extended to the cells it touches
+    double get_density(int specie, SDL_Rect const& area) const; //animals per block of the area extended to its cells
+
+private:
+    void build_table(int table); //sums the counts of the parts into the summed-area table
+    int get_sum(int table, int x, int y) const; //animals of the cells before column x and row y
+    void write_raster();
+
+    int m_width, m_height;
+    int m_cell;
+    int m_columns, m_rows;
+    int m_species_number;
+    int m_time;
+
+    std::vector < std::vector < std::vector <int32_t> > > m_parts; //counts of each cell by part of the animals then by specie, empty where a part has none of it
+    std::vector < std::vector <int32_t> > m_tables; //summed-area table of all the animals (0) and of each specie, (columns + 1) x (rows + 1), empty for a specie absent from the map
+
+    std::ofstream m_file;
+    bool m_error;
+    std::vector <unsigned char> m_buffer;
+};
+
+#endif
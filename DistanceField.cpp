@@ -0,0 +1,162 @@
+#include <algorithm>
+#include "DistanceField.hpp"
+
+DistanceField::DistanceField(): m_range(0)
+{}
+
+void DistanceField::reset(int width, int height, int range)
+{
+    m_offsets.reset(width, height, 0);
+    m_range = std::max(0, std::min(range, 127));
+    m_queue.clear();
+}
+
+int DistanceField::get_range() const
+{
+    return m_range;
+}
+
+unsigned short DistanceField::encode(int dx, int dy)
+{
+    return ((dx + 128) << 8) | (dy + 128); //never 0 since |dx| < 128
+}
+
+void DistanceField::decode(unsigned short value, int &dx, int &dy)
+{
+    dx = (value >> 8) - 128;
+    dy = (value & 255) - 128;
+}
+
+bool DistanceField::get_source(int x, int y, int &sx, int &sy) const
+{
+    unsigned short value = m_offsets.get(x, y);
+    if(!value)
+        return false;
+    decode(value, sx, sy);
+    sx += x;
+    sy += y;
+    return true;
+}
+
+void DistanceField::set_source(int x, int y, int sx, int sy)
+{
+    m_offsets.set(x, y, encode(sx - x, sy - y));
+}
+
+bool DistanceField::get_nearest(int x, int y, SDL_Point &source) const
+{
+    if(x < 0 || y < 0 || x >= m_offsets.get_width() || y >= m_offsets.get_height())
+        return false;
+    return get_source(x, y, source.x, source.y);
+}
+
+void DistanceField::add_source(int x, int y)
+{
+    set_source(x, y, x, y);
+    m_queue.push_back({x, y});
+    propagate();
+}
+
+void DistanceField::add_source_later(int x, int y)
+{
+    set_source(x, y, x, y);
+    m_queue.push_back({x, y});
+}
+
+void DistanceField::spread()
+{
+    propagate();
+}
+
+void DistanceField::save_state(CheckpointWriter &cp) const
+{
+    cp.add_value(int32_t(m_range));
+    cp.add_value(int32_t(m_offsets.get_chunks_number()));
+    for(size_t i = 0; i < m_offsets.get_directory_size(); i++)
+    {
+        if(m_offsets.get_chunk(i))
+        {
+            cp.add_value(int64_t(i));
+            cp.add(m_offsets.get_chunk(i), ChunkGrid<unsigned short>::CHUNK_SIZE * ChunkGrid<unsigned short>::CHUNK_SIZE * sizeof(unsigned short));
+        }
+    }
+}
+
+bool DistanceField::load_state(CheckpointReader &cp, int width, int height)
+{
+    int32_t range = 0, chunks = 0;
+    if(!cp.read_value(range) || !cp.read_value(chunks) || range < 0 || range > 127 || chunks < 0)
+        return false;
+    reset(width, height, range);
+
+    int const size = ChunkGrid<unsigned short>::CHUNK_SIZE;
+    std::vector <unsigned short> blocks(size * size);
+    for(int c = 0; c < chunks; c++)
+    {
+        int64_t index = 0;
+        if(!cp.read_value(index) || index < 0 || index >= m_offsets.get_directory_size() || !cp.read(blocks.data(), blocks.size() * sizeof(unsigned short)))
+            return false;
+
+        int origin_x = 0, origin_y = 0;
+        m_offsets.get_chunk_origin(index, origin_x, origin_y);
+        for(int b = 0; b < size * size; b++)
+        {
+            int x = origin_x + b % size, y = origin_y + b / size;
+            if(blocks[b] && (x >= width || y >= height))
+                return false;
+            if(blocks[b])
+                m_offsets.set(x, y, blocks[b]);
+        }
+    }
+    return true;
+}
+
+void DistanceField::remove_source(int x, int y)
+{
+    //the blocks of the source are cleared (all within the range: a block can keep a source without any neighbor keeping it)
+    int width = m_offsets.get_width(), height = m_offsets.get_height();
+    int sx = 0, sy = 0;
+    for(int i = std::max(0, x - m_range); i <= std::min(width - 1, x + m_range); i++)
+        for(int j = std::max(0, y - m_range); j <= std::min(height - 1, y + m_range); j++)
+            if(get_source(i, j, sx, sy) && sx == x && sy == y)
+            {
+                m_offsets.set(i, j, 0);
+                m_cleared.push_back({i, j});
+            }
+
+    //the sources of the neighbors of the cleared blocks spread back into them
+    for(size_t c = 0; c < m_cleared.size(); c++)
+        for(int i = std::max(0, m_cleared[c].x - 1); i <= std::min(width - 1, m_cleared[c].x + 1); i++)
+            for(int j = std::max(0, m_cleared[c].y - 1); j <= std::min(height - 1, m_cleared[c].y + 1); j++)
+                if(m_offsets.get(i, j))
+                    m_queue.push_back({i, j});
+    m_cleared.clear();
+    propagate();
+}
+
+void DistanceField::propagate() //each block of the queue offers its source to its neighbors, until no block gets closer to a source
+{
+    int width = m_offsets.get_width(), height = m_offsets.get_height();
+    int range_squared = m_range * m_range;
+    for(size_t q = 0; q < m_queue.size(); q++)
+    {
+        int x = m_queue[q].x, y = m_queue[q].y, sx = 0, sy = 0;
+        if(!get_source(x, y, sx, sy))
+            continue;
+        for(int i = std::max(0, x - 1); i <= std::min(width - 1, x + 1); i++)
+        {
+            for(int j = std::max(0, y - 1); j <= std::min(height - 1, y + 1); j++)
+            {
+                int distance = (i - sx) * (i - sx) + (j - sy) * (j - sy);
+                if(distance > range_squared)
+                    continue;
+                int cx = 0, cy = 0;
+                if(get_source(i, j, cx, cy) && (i - cx) * (i - cx) + (j - cy) * (j - cy) <= distance)
+                    continue;
+                set_source(i, j, sx, sy);
+                m_queue.push_back({i, j});
+            }
+        }
+    }
+    m_queue.clear();
+}
@@ -0,0 +1,46 @@
+#ifndef DEF_DISTANCEFIELD
+#define DEF_DISTANCEFIELD
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include "ChunkGrid.hpp"
+#include "Checkpoint.hpp"
+
+//nearest source of each block of the map, within a range: finding the nearest source from anywhere is a lookup
+//an added source spreads to the blocks it is closer to (brushfire), a removed one clears its blocks which take the sources of their neighbors,
+//so the cost follows the changes of the sources instead of the searches; only the chunks within the range of a source are allocated
+//the propagation from neighbor to neighbor can give a source slightly further than the nearest one (less than a block)
+class DistanceField
+{
+public:
+    DistanceField();
+
+    void reset(int width, int height, int range); //no source, range below 128
+    int get_range() const;
+
+    bool get_nearest(int x, int y, SDL_Point &source) const; //false if there is no source within the range
+    void add_source(int x, int y);
+    void remove_source(int x, int y);
+
+    void add_source_later(int x, int y); //many sources at once (a new map): they spread together at the next spread
+    void spread();
+
+    //the field depends on the order of the changes (ties, propagation): a restored world needs the field itself, not one rebuilt from its sources
+    void save_state(CheckpointWriter &cp) const;
+    bool load_state(CheckpointReader &cp, int width, int height);
+
+private:
+    static unsigned short encode(int dx, int dy);
+    static void decode(unsigned short value, int &dx, int &dy);
+
+    bool get_source(int x, int y, int &sx, int &sy) const;
+    void set_source(int x, int y, int sx, int sy);
+    void propagate();
+
+    ChunkGrid <unsigned short> m_offsets; //offset to the nearest source on each axis (+128 each on a byte), 0 without source within the range
+    int m_range;
+    std::vector <SDL_Point> m_queue;
+    std::vector <SDL_Point> m_cleared;
+};
+
+#endif
@@ -0,0 +1,80 @@
+#include <cmath>
+#include <algorithm>
+#include "Distribution.hpp"
+
+SpecieDistribution::SpecieDistribution()
+{
+    number = 0;
+    males = 0;
+    hungry = 0;
+    ready = 0;
+    health = 0;
+    health_squares = 0;
+    age = 0;
+    age_squares = 0;
+    std::fill(health_bins, health_bins + DISTRIBUTION_BINS, 0);
+    std::fill(age_bins, age_bins + DISTRIBUTION_BINS, 0);
+}
+
+void SpecieDistribution::add(AnimalState const& state, SpecieSettings const& settings)
+{
+    int age = std::max(0, settings.life_expectancy - state.life_expectancy); //the life expectancy decreases by one every second
+    number += 1;
+    males += state.male;
+    hungry += state.hungry;
+    ready += !state.hungry && (state.time_before_reproduction <= 0 || state.male); //as Animal::is_ready_to_reproduce
+    health += state.health;
+    health_squares += double(state.health) * state.health;
+    this->age += age;
+    age_squares += double(age) * age;
+    health_bins[std::max(0, std::min(DISTRIBUTION_BINS - 1, state.health * DISTRIBUTION_BINS / std::max(1, settings.maximum_health)))] += 1;
+    age_bins[std::min(DISTRIBUTION_BINS - 1, age * DISTRIBUTION_BINS / std::max(1, settings.life_expectancy))] += 1;
+}
+
+void SpecieDistribution::merge(SpecieDistribution const& other)
+{
+    number += other.number;
+    males += other.males;
+    hungry += other.hungry;
+    ready += other.ready;
+    health += other.health;
+    health_squares += other.health_squares;
+    age += other.age;
+    age_squares += other.age_squares;
+    for(int i = 0; i < DISTRIBUTION_BINS; i++)
+    {
+        health_bins[i] += other.health_bins[i];
+        age_bins[i] += other.age_bins[i];
+    }
+}
+
+void SpecieDistribution::get_columns(int *columns) const
+{
+    double health_mean = number ? health / number : 0, age_mean = number ? age / number : 0;
+    columns[DISTRIBUTION_MALES] = males;
+    columns[DISTRIBUTION_HUNGRY] = hungry;
+    columns[DISTRIBUTION_READY] = ready;
+    columns[DISTRIBUTION_HEALTH] = int(std::lround(health_mean));
+    columns[DISTRIBUTION_HEALTH_DEVIATION] = number ? int(std::lround(sqrt(std::max(0.0, health_squares / number - health_mean * health_mean)))) : 0;
+    columns[DISTRIBUTION_AGE] = int(std::lround(age_mean));
+    columns[DISTRIBUTION_AGE_DEVIATION] = number ? int(std::lround(sqrt(std::max(0.0, age_squares / number - age_mean * age_mean)))) : 0;
+    std::copy(health_bins, health_bins + DISTRIBUTION_BINS, columns + DISTRIBUTION_HEALTH_BINS);
+    std::copy(age_bins, age_bins + DISTRIBUTION_BINS, columns + DISTRIBUTION_AGE_BINS);
+}
+
+std::vector <std::string> get_distribution_names(Scenario const& scenario)
+{
+    static const char* const names[] = {"males", "affames", "prets", "sante", "sante_ecart", "age", "age_ecart"};
+    std::vector <std::string> columns;
+    for(int specie = 0; specie < scenario.species_name.size(); specie++)
+    {
+        std::string const& name = scenario.species_name[specie];
+        for(int i = 0; i < DISTRIBUTION_HEALTH_BINS; i++)
+            columns.push_back(name + "_" + names[i]);
+        for(int i = 0; i < DISTRIBUTION_BINS; i++)
+            columns.push_back(name + "_sante_" + std::to_string(i + 1));
+        for(int i = 0; i < DISTRIBUTION_BINS; i++)
+            columns.push_back(name + "_age_" + std::to_string(i + 1));
+    }
+    return columns;
+}
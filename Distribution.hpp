@@ -0,0 +1,44 @@
+#ifndef DEF_DISTRIBUTION
+#define DEF_DISTRIBUTION
+
+#include <string>
+#include <vector>
+#include "Animal.hpp"
+#include "Scenario.hpp"
+
+//distribution of the animals alive of a specie, added to the stats after the headcounts: sex ratio, hunger, readiness to reproduce,
+//mean and standard deviation of the health and of the age, and their histograms (the health up to the maximum of the specie, the age up to its life expectancy)
+static const int DISTRIBUTION_BINS = 8;
+
+enum DistributionColumn //columns of a specie in the stats
+{
+    DISTRIBUTION_MALES,
+    DISTRIBUTION_HUNGRY,
+    DISTRIBUTION_READY,
+    DISTRIBUTION_HEALTH, //mean
+    DISTRIBUTION_HEALTH_DEVIATION,
+    DISTRIBUTION_AGE, //mean, in simulated seconds
+    DISTRIBUTION_AGE_DEVIATION,
+    DISTRIBUTION_HEALTH_BINS,
+    DISTRIBUTION_AGE_BINS = DISTRIBUTION_HEALTH_BINS + DISTRIBUTION_BINS,
+    DISTRIBUTION_COLUMNS = DISTRIBUTION_AGE_BINS + DISTRIBUTION_BINS
+};
+
+//partial sums of the animals seen by one thread, merged with those of the others at the end
+struct SpecieDistribution
+{
+    SpecieDistribution();
+
+    void add(AnimalState const& state, SpecieSettings const& settings);
+    void merge(SpecieDistribution const& other);
+    void get_columns(int *columns) const; //DISTRIBUTION_COLUMNS values
+
+    int number, males, hungry, ready;
+    double health, health_squares, age, age_squares;
+    int health_bins[DISTRIBUTION_BINS];
+    int age_bins[DISTRIBUTION_BINS];
+};
+
+std::vector <std::string> get_distribution_names(Scenario const& scenario); //names of the columns of all the species ("name_males"...)
+
+#endif
@@ -0,0 +1,470 @@
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include "EventLog.hpp"
+#include "World.hpp"
+#include "Checkpoint.hpp"
+#include "Profiler.hpp"
+
+#ifdef SIMUWORLD_ZLIB
+    #include <zlib.h>
+#endif
+
+static const char EVENT_LOG_MAGIC[8] = {'S', 'W', 'E', 'V', 'L', 'O', 'G', 0};
+static const int EVENT_LOG_BLOCK = 10000; //simulated ms between two events blocks
+
+static void put_varint(std::vector <unsigned char> &data, uint64_t value) //7 bits per byte, the highest bit tells that another byte follows
+{
+    while(value >= 128)
+    {
+        data.push_back((value & 127) | 128);
+        value >>= 7;
+    }
+    data.push_back(value);
+}
+
+static void put_signed(std::vector <unsigned char> &data, int64_t value) //zigzag: the small negative values stay short too
+{
+    put_varint(data, (uint64_t(value) << 1) ^ uint64_t(value >> 63));
+}
+
+static void put_position(std::vector <unsigned char> &data, double value) //in 1/256 of block
+{
+    put_signed(data, llround(value * 256));
+}
+
+static bool get_varint(std::vector <unsigned char> const& data, size_t &cursor, uint64_t &value)
+{
+    value = 0;
+    for(int shift = 0; shift < 64 && cursor < data.size(); shift += 7)
+    {
+        unsigned char byte = data[cursor++];
+        value |= uint64_t(byte & 127) << shift;
+        if(!(byte & 128))
+            return true;
+    }
+    return false;
+}
+
+static bool get_signed(std::vector <unsigned char> const& data, size_t &cursor, int64_t &value)
+{
+    uint64_t raw = 0;
+    if(!get_varint(data, cursor, raw))
+        return false;
+    value = int64_t(raw >> 1) ^ -int64_t(raw & 1);
+    return true;
+}
+
+static bool get_int(std::vector <unsigned char> const& data, size_t &cursor, int32_t &value)
+{
+    int64_t raw = 0;
+    if(!get_signed(data, cursor, raw))
+        return false;
+    value = raw;
+    return true;
+}
+
+static bool get_position(std::vector <unsigned char> const& data, size_t &cursor, double &value)
+{
+    int64_t raw = 0;
+    if(!get_signed(data, cursor, raw))
+        return false;
+    value = raw / 256.0;
+    return true;
+}
+
+void encode_events(std::vector <LogEvent> const& events, std::vector <unsigned char> &data)
+{
+    //each value is written as the difference with the previous event, the time and the ids only grow a little from one to the next
+    data.clear();
+    int32_t time = 0, id = 0, x = 0, y = 0;
+    for(size_t i = 0; i < events.size(); i++)
+    {
+        LogEvent const& event = events[i];
+        put_varint(data, event.type);
+        put_signed(data, event.time - time);
+        time = event.time;
+        if(event.type == EVENT_RESOURCE)
+        {
+            put_signed(data, event.id - x);
+            put_signed(data, event.other - y);
+            put_varint(data, event.value);
+            x = event.id;
+            y = event.other;
+            continue;
+        }
+
+        put_signed(data, event.id - id);
+        id = event.id;
+        switch(event.type)
+        {
+        case EVENT_SPAWN:
+            put_signed(data, event.value);
+            put_signed(data, event.other);
+            put_signed(data, event.extra);
+            put_signed(data, event.time - event.origin);
+            put_position(data, event.pos.x);
+            put_position(data, event.pos.y);
+            put_position(data, event.dest.x - event.pos.x);
+            put_position(data, event.dest.y - event.pos.y);
+            break;
+        case EVENT_DEATH:
+            put_position(data, event.pos.x);
+            put_position(data, event.pos.y);
+            break;
+        case EVENT_DESTINATION:
+            put_position(data, event.pos.x);
+            put_position(data, event.pos.y);
+            put_position(data, event.dest.x - event.pos.x);
+            put_position(data, event.dest.y - event.pos.y);
+            break;
+        case EVENT_ATTACK:
+        case EVENT_MEAL:
+            put_signed(data, event.other ? event.other - event.id : 0);
+            put_signed(data, event.value);
+            if(event.type == EVENT_MEAL)
+                put_signed(data, event.extra);
+            put_position(data, event.pos.x);
+            put_position(data, event.pos.y);
+            break;
+        }
+    }
+}
+
+bool decode_events(std::vector <unsigned char> const& data, uint32_t count, std::vector <LogEvent> &events)
+{
+    events.clear();
+    events.reserve(count);
+    size_t cursor = 0;
+    int32_t time = 0, id = 0, x = 0, y = 0;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        LogEvent event;
+        memset(&event, 0, sizeof(LogEvent));
+        uint64_t type = 0;
+        int32_t delta = 0;
+        if(!get_varint(data, cursor, type) || type > EVENT_RESOURCE || !get_int(data, cursor, delta))
+            return false;
+        event.type = type;
+        event.time = time += delta;
+
+        bool valid = true;
+        if(event.type == EVENT_RESOURCE)
+        {
+            int32_t dx = 0, dy = 0;
+            uint64_t resource = 0;
+            valid = get_int(data, cursor, dx) && get_int(data, cursor, dy) && get_varint(data, cursor, resource);
+            event.id = x += dx;
+            event.other = y += dy;
+            event.value = resource;
+            if(!valid)
+                return false;
+            events.push_back(event);
+            continue;
+        }
+
+        valid = get_int(data, cursor, delta);
+        event.id = id += delta;
+        switch(event.type)
+        {
+        case EVENT_SPAWN:
+            valid = valid && get_int(data, cursor, event.value) && get_int(data, cursor, event.other) && get_int(data, cursor, event.extra) && get_int(data, cursor, event.origin);
+            event.origin = event.time - event.origin;
+            valid = valid && get_position(data, cursor, event.pos.x) && get_position(data, cursor, event.pos.y);
+            valid = valid && get_position(data, cursor, event.dest.x) && get_position(data, cursor, event.dest.y);
+            event.dest.x += event.pos.x;
+            event.dest.y += event.pos.y;
+            break;
+        case EVENT_DEATH:
+            valid = valid && get_position(data, cursor, event.pos.x) && get_position(data, cursor, event.pos.y);
+            break;
+        case EVENT_DESTINATION:
+            valid = valid && get_position(data, cursor, event.pos.x) && get_position(data, cursor, event.pos.y);
+            valid = valid && get_position(data, cursor, event.dest.x) && get_position(data, cursor, event.dest.y);
+            event.dest.x += event.pos.x;
+            event.dest.y += event.pos.y;
+            break;
+        case EVENT_ATTACK:
+        case EVENT_MEAL:
+            valid = valid && get_int(data, cursor, event.other) && get_int(data, cursor, event.value);
+            if(event.type == EVENT_MEAL)
+                valid = valid && get_int(data, cursor, event.extra);
+            valid = valid && get_position(data, cursor, event.pos.x) && get_position(data, cursor, event.pos.y);
+            if(event.other)
+                event.other += event.id;
+            break;
+        }
+        if(!valid)
+            return false;
+        events.push_back(event);
+    }
+    return cursor == data.size();
+}
+
+void encode_rows(std::vector < std::vector <int> > const& rows, int first, int end, std::vector <unsigned char> &data)
+{
+    //each value as the difference with the same value of the previous row
+    data.clear();
+    for(int r = first; r < end; r++)
+        for(int i = 0; i < rows[r].size(); i++)
+            put_signed(data, rows[r][i] - (r > first ? rows[r - 1][i] : 0));
+}
+
+bool decode_rows(std::vector <unsigned char> const& data, uint32_t count, int columns, std::vector < std::vector <int> > &rows)
+{
+    size_t cursor = 0;
+    for(uint32_t r = 0; r < count; r++)
+    {
+        std::vector <int> row(columns);
+        for(int i = 0; i < columns; i++)
+        {
+            int32_t delta = 0;
+            if(!get_int(data, cursor, delta))
+                return false;
+            row[i] = (r > 0 ? rows.back()[i] : 0) + delta;
+        }
+        rows.push_back(row);
+    }
+    return cursor == data.size();
+}
+
+void compress_block(std::vector <unsigned char> const& raw, std::vector <unsigned char> &stored)
+{
+#ifdef SIMUWORLD_ZLIB
+    uLongf size = compressBound(raw.size());
+    stored.resize(size);
+    if(compress2(stored.data(), &size, raw.data(), raw.size(), Z_BEST_SPEED) == Z_OK && size < raw.size())
+    {
+        stored.resize(size);
+        return;
+    }
+#endif
+    stored = raw;
+}
+
+bool uncompress_block(std::vector <unsigned char> const& stored, uint32_t raw_size, std::vector <unsigned char> &raw)
+{
+    if(stored.size() == raw_size)
+    {
+        raw = stored;
+        return true;
+    }
+#ifdef SIMUWORLD_ZLIB
+    raw.resize(raw_size);
+    uLongf size = raw_size;
+    return uncompress(raw.data(), &size, stored.data(), stored.size()) == Z_OK && size == raw_size;
+#else
+    return false; //written by a version compressing the blocks
+#endif
+}
+
+EventRecorder::EventRecorder()
+{
+    m_error = false;
+    m_keyframe_interval = 60000;
+    m_block_interval = EVENT_LOG_BLOCK;
+    m_last_keyframe = 0;
+    m_block_start = 0;
+    m_rows = 0;
+    m_steps = 0;
+}
+
+EventRecorder::~EventRecorder()
+{
+    close();
+}
+
+bool EventRecorder::open(std::string const& file_name, World &world, int keyframe_interval)
+{
+    close();
+    m_file.open(file_name.c_str(), std::ios::binary | std::ios::trunc);
+    if(!m_file)
+        return false;
+    m_error = false;
+    m_keyframe_interval = std::max(1, keyframe_interval) * 1000;
+    m_block_interval = std::min(EVENT_LOG_BLOCK, m_keyframe_interval);
+    m_rows = 0;
+    m_steps = 0;
+    m_tracked.clear();
+    m_events.clear();
+
+    Scenario const& scenario = world.get_scenario();
+    CheckpointWriter header;
+    header.add(EVENT_LOG_MAGIC, sizeof(EVENT_LOG_MAGIC));
+    header.add_value(EVENT_LOG_VERSION);
+    header.add_value(int32_t(world.get_map().get_size().x));
+    header.add_value(int32_t(world.get_map().get_size().y));
+    header.add_value(int32_t(scenario.species.size()));
+    for(int i = 0; i < scenario.species.size(); i++)
+        header.add_value(scenario.species[i].speed); //the replay moves the animals with the speeds of the recording
+    header.write(m_raw);
+    m_file.write(reinterpret_cast<char const*>(m_raw.data()), m_raw.size());
+
+    //the state at the start, then only what changes
+    Population &population = world.get_population();
+    Map &map = world.get_map();
+    int now = world.get_time();
+    for(int i = 0; i < population.m_animals.size(); i++)
+        m_tracked[population.m_animals[i]->get_id()] = {population.m_animals[i]->get_destination(), population.m_animals[i]->is_alive(now), 0};
+    population.m_logging = true;
+    population.m_logged.clear();
+    map.m_logging = true;
+    map.m_changes.clear();
+
+    m_block_start = now;
+    write_keyframe(world);
+    return !get_error();
+}
+
+void EventRecorder::flush(World &world)
+{
+    if(!m_file.is_open())
+        return;
+    write_events(world.get_time());
+    write_stats(world, world.get_time());
+}
+
+void EventRecorder::close()
+{
+    if(m_file.is_open())
+        m_file.close();
+}
+
+bool EventRecorder::get_error() const
+{
+    return m_error || !m_file;
+}
+
+void EventRecorder::add_animal(Animal const& animal, int now)
+{
+    bool alive = animal.is_alive(now);
+    LogEvent spawn = {EVENT_SPAWN, now, animal.get_id(), animal.get_color(), animal.get_specie(), (animal.get_health(now) << 1) | animal.is_male(), animal.get_position(), animal.get_destination(), animal.get_origin()};
+    m_events.push_back(spawn);
+    if(!alive)
+        m_events.push_back({EVENT_DEATH, now, animal.get_id(), 0, 0, 0, animal.get_position(), animal.get_position(), 0});
+    m_tracked[animal.get_id()] = {animal.get_destination(), alive, m_steps};
+}
+
+void EventRecorder::record(World &world)
+{
+    if(!m_file.is_open())
+        return;
+    PROFILE_ZONE("EventRecorder::record");
+    Population &population = world.get_population();
+    Map &map = world.get_map();
+    int now = world.get_time();
+    m_steps += 1;
+
+    //the replay applies the events in this order: the resources, the attacks and the meals, then the animals
+    for(int i = 0; i < map.m_changes.size(); i++)
+        m_events.push_back({EVENT_RESOURCE, now, map.m_changes[i].x, map.m_changes[i].y, map.get_resource(map.m_changes[i].x, map.m_changes[i].y), 0, {0, 0}, {0, 0}, 0});
+    map.m_changes.clear();
+    for(int i = 0; i < population.m_logged.size(); i++)
+    {
+        m_events.push_back(population.m_logged[i]);
+        m_events.back().time = now;
+    }
+    population.m_logged.clear();
+
+    for(int i = 0; i < population.m_animals.size(); i++)
+    {
+        Animal const& animal = *population.m_animals[i];
+        std::unordered_map <int, Tracked>::iterator found = m_tracked.find(animal.get_id());
+        if(found == m_tracked.end())
+        {
+            add_animal(animal, now);
+            continue;
+        }
+
+        Tracked &tracked = found->second;
+        tracked.seen = m_steps;
+        if(!tracked.alive)
+            continue;
+        Vector2d dest = animal.get_destination();
+        if(!animal.is_alive(now))
+        {
+            m_events.push_back({EVENT_DEATH, now, animal.get_id(), 0, 0, 0, animal.get_position(), animal.get_position(), 0});
+            tracked.alive = false;
+        }
+        else if(dest.x != tracked.dest.x || dest.y != tracked.dest.y)
+        {
+            m_events.push_back({EVENT_DESTINATION, now, animal.get_id(), 0, 0, 0, animal.get_position(), dest, 0});
+            tracked.dest = dest;
+        }
+    }
+
+    for(std::unordered_map <int, Tracked>::iterator it = m_tracked.begin(); it != m_tracked.end();)
+    {
+        if(it->second.seen != m_steps)
+        {
+            m_events.push_back({EVENT_REMOVE, now, it->first, 0, 0, 0, {0, 0}, {0, 0}, 0});
+            it = m_tracked.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    if(now - m_block_start >= m_block_interval || now - m_last_keyframe >= m_keyframe_interval)
+    {
+        write_events(now);
+        write_stats(world, now);
+    }
+    if(now - m_last_keyframe >= m_keyframe_interval)
+        write_keyframe(world);
+}
+
+void EventRecorder::write_keyframe(World &world)
+{
+    int now = world.get_time();
+    Population &population = world.get_population();
+
+    CheckpointWriter cp;
+    world.get_map().save_state(cp, now, false); //the replay does without the fields
+    population.m_blood->save_state(cp);
+    cp.add_value(int32_t(population.m_animals.size()));
+    for(int i = 0; i < population.m_animals.size(); i++)
+    {
+        Animal const& animal = *population.m_animals[i];
+        cp.add_value(int32_t(animal.get_id()));
+        cp.add_value(int32_t(animal.get_specie()));
+        cp.add_value(int32_t(animal.get_color()));
+        cp.add_value(int32_t(animal.is_male()));
+        cp.add_value(int32_t(animal.is_alive(now)));
+        cp.add_value(int32_t(animal.get_health(now)));
+        cp.add_value(int32_t(animal.get_origin()));
+        cp.add_value(animal.get_position());
+        cp.add_value(animal.get_destination());
+    }
+    cp.write(m_raw);
+    write_block(LOG_KEYFRAME, now, now, population.m_animals.size(), m_raw);
+    m_last_keyframe = now;
+}
+
+void EventRecorder::write_events(int end)
+{
+    encode_events(m_events, m_raw);
+    write_block(LOG_EVENTS, m_block_start, end, m_events.size(), m_raw);
+    m_events.clear();
+    m_block_start = end;
+}
+
+void EventRecorder::write_stats(World &world, int end)
+{
+    std::vector < std::vector <int> > const& rows = world.get_stats().get_values();
+    if(m_rows >= rows.size())
+        return;
+    encode_rows(rows, m_rows, rows.size(), m_raw);
+    write_block(LOG_STATS, m_rows * 1000, end, rows.size() - m_rows, m_raw);
+    m_rows = rows.size();
+}
+
+void EventRecorder::write_block(int kind, int start, int end, uint32_t count, std::vector <unsigned char> const& raw)
+{
+    compress_block(raw, m_stored);
+    LogBlockHeader header = {kind, start, end, uint32_t(raw.size()), uint32_t(m_stored.size()), count};
+    m_file.write(reinterpret_cast<char const*>(&header), sizeof(LogBlockHeader));
+    m_file.write(reinterpret_cast<char const*>(m_stored.data()), m_stored.size());
+    m_file.flush(); //a log interrupted with the simulation stays readable up to its last block
+    if(!m_file)
+        m_error = true;
+}
@@ -0,0 +1,105 @@
+#ifndef DEF_EVENTLOG
+#define DEF_EVENTLOG
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <unordered_map>
+#include <cstdint>
+#include "Animal.hpp"
+
+//event log of a simulation: "SWEVLOG" magic, version, size of the map, speed of each specie, then blocks of a header and their data
+//a keyframe block holds the whole state (map, stains, animals) every few simulated seconds, an events block what happened since the previous block
+//and a stats block the rows of the stats of the same seconds; the events are delta-encoded as variable length integers and each block is compressed
+//(zlib, when it is available at the compilation): a replay seeks to a keyframe and applies the events, the positions follow from the destinations and the speeds
+static const int32_t EVENT_LOG_VERSION = 4;
+
+enum EventType
+{
+    EVENT_SPAWN, //an animal appears (birth, or first step of the log)
+    EVENT_DEATH,
+    EVENT_REMOVE, //decomposed or eaten
+    EVENT_DESTINATION, //the animal leaves its position for a new destination
+    EVENT_ATTACK,
+    EVENT_MEAL, //the health gained by the eater, after the decrease of its vital stats since their last update
+    EVENT_RESOURCE //a block gets a resource or loses it
+};
+
+enum LogBlockKind
+{
+    LOG_KEYFRAME, LOG_EVENTS, LOG_STATS
+};
+
+struct LogEvent
+{
+    int32_t type;
+    int32_t time;
+    int32_t id; //the animal (the attacker, the eater), the column of the block for a resource
+    int32_t other; //the target, the prey eaten (0 for a plant), the color of a new animal, the row of the block for a resource
+    int32_t value; //the damage, the specie of a new animal, the resource of the block (0 when removed)
+    int32_t extra; //a new animal: its health, and 1 in the lowest bit for a male; a meal: the health gained
+    Vector2d pos, dest;
+    int32_t origin; //a new animal: the time from which its vital stats decrease by one every second (Animal::get_origin)
+};
+
+struct LogBlockHeader
+{
+    int32_t kind;
+    int32_t start, end; //simulated ms covered
+    uint32_t raw_size; //size of the encoded data
+    uint32_t stored_size; //size in the file, raw_size if the block could not be compressed
+    uint32_t count; //events or rows
+};
+
+//encoding of the events of a block (ascending times), shared by the recorder and the replay
+void encode_events(std::vector <LogEvent> const& events, std::vector <unsigned char> &data);
+bool decode_events(std::vector <unsigned char> const& data, uint32_t count, std::vector <LogEvent> &events);
+void encode_rows(std::vector < std::vector <int> > const& rows, int first, int end, std::vector <unsigned char> &data);
+bool decode_rows(std::vector <unsigned char> const& data, uint32_t count, int columns, std::vector < std::vector <int> > &rows);
+void compress_block(std::vector <unsigned char> const& raw, std::vector <unsigned char> &stored); //stored is raw when the compression does not help
+bool uncompress_block(std::vector <unsigned char> const& stored, uint32_t raw_size, std::vector <unsigned char> &raw);
+
+//writes the event log of a world while it runs: World::update calls record() after each step
+//the destinations, the births, the deaths and the removals are found by comparing the animals with the previous step,
+//the attacks and the meals are kept by the population and the changes of resources by the map
+class EventRecorder
+{
+public:
+    EventRecorder();
+    ~EventRecorder();
+
+    bool open(std::string const& file_name, class World &world, int keyframe_interval); //simulated seconds between two keyframes
+    void record(class World &world);
+    void flush(class World &world); //writes the events and the stats not written yet, before closing
+    void close();
+    bool get_error() const;
+
+private:
+    struct Tracked
+    {
+        Vector2d dest;
+        bool alive;
+        int seen; //step of the last record where the animal was there
+    };
+
+    void add_animal(Animal const& animal, int now);
+    void write_keyframe(class World &world);
+    void write_events(int end);
+    void write_stats(class World &world, int end);
+    void write_block(int kind, int start, int end, uint32_t count, std::vector <unsigned char> const& raw);
+
+    std::ofstream m_file;
+    bool m_error;
+    int m_keyframe_interval; //ms
+    int m_block_interval; //ms between two events blocks
+    int m_last_keyframe;
+    int m_block_start;
+    int m_rows; //rows of stats already written
+    int m_steps;
+
+    std::unordered_map <int, Tracked> m_tracked; //by id
+    std::vector <LogEvent> m_events; //since the last events block
+    std::vector <unsigned char> m_raw, m_stored;
+};
+
+#endif
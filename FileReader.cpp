@@ -1,28 +1,46 @@
 #include "FileReader.hpp"
 #include <fstream>
+#include <stdexcept>
 #include <SDL2/SDL.h>
 
+FileReader::FileReader(std::vector <std::string> *errors): m_errors(errors)
+{
+    m_opened = false;
+}
+
 void FileReader::read(std::string const& file_name)
 {
     m_file_name = file_name;
     m_content.clear();
     std::ifstream file(file_name);
+    m_opened = bool(file);
     if(file)
     {
         std::string buffer;
         while(getline(file, buffer))
         {
+            if(!buffer.empty() && buffer[buffer.size() - 1] == '\r') //files saved on windows
+                buffer.erase(buffer.size() - 1);
             m_content[buffer.substr(0, buffer.find('='))] = buffer.substr(buffer.find('=') + 1);
         }
         file.close();
     }
+    else if(m_errors)
+        m_errors->push_back(m_file_name + " : le fichier n'a pas pu etre ouvert");
     else
+        report("le fichier n'a pas pu etre ouvert");
+}
+
+void FileReader::report(std::string const& body) const //without list of errors, the error is fatal
+{
+    if(m_errors)
     {
-        std::string title = m_file_name;
-        std::string body = "le fichier n'a pas pu etre ouvert";
-        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, title.c_str(), body.c_str(), NULL);
-        exit(0);
+        if(m_opened) //the values of a missing file are not reported one by one
+            m_errors->push_back(m_file_name + " : " + body);
+        return;
     }
+    SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, m_file_name.c_str(), body.c_str(), NULL);
+    exit(0);
 }
 
 std::string FileReader::getString(std::string const& data) const
@@ -31,13 +49,11 @@ std::string FileReader::getString(std::string const& data) const
     {
         return m_content.at(data);
     }
-    catch (std::out_of_range const& oor) 
+    catch (std::out_of_range const& oor)
     {
-        std::string title = m_file_name;
-        std::string body = "la valeur \"" + data + "\" est manquante";
-        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, title.c_str(), body.c_str(), NULL);
-        exit(0);
+        report("la valeur \"" + data + "\" est manquante");
     }
+    return "";
 }
 
 int FileReader::getInt(std::string const& data) const
@@ -46,20 +62,15 @@ int FileReader::getInt(std::string const& data) const
     {
         return std::stoi(m_content.at(data));
     }
-    catch (std::out_of_range const& oor) 
+    catch (std::out_of_range const& oor)
     {
-        std::string title = m_file_name;
-        std::string body = "la valeur \"" + data + "\" est manquante";
-        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, title.c_str(), body.c_str(), NULL);
-        exit(0);
+        report("la valeur \"" + data + "\" est manquante");
     }
     catch(std::invalid_argument const& ia)
     {
-        std::string title = m_file_name;
-        std::string body = "la valeur \"" + data + "\" n'est pas un entier";
-        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, title.c_str(), body.c_str(), NULL);
-        exit(0);
+        report("la valeur \"" + data + "\" n'est pas un entier");
     }
+    return 0;
 }
 
 double FileReader::getDouble(std::string const& data) const
@@ -68,20 +79,15 @@ double FileReader::getDouble(std::string const& data) const
     {
         return std::stod(m_content.at(data));
     }
-    catch (std::out_of_range const& oor) 
+    catch (std::out_of_range const& oor)
     {
-        std::string title = m_file_name;
-        std::string body = "la valeur \"" + data + "\" est manquante";
-        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, title.c_str(), body.c_str(), NULL);
-        exit(0);
+        report("la valeur \"" + data + "\" est manquante");
     }
     catch(std::invalid_argument const& ia)
     {
-        std::string title = m_file_name;
-        std::string body = "la valeur \"" + data + "\" n'est pas un nombre decimal";
-        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, title.c_str(), body.c_str(), NULL);
-        exit(0);
+        report("la valeur \"" + data + "\" n'est pas un nombre decimal");
     }
+    return 0;
 }
 
 std::vector<int> FileReader::getVectorInt(std::string const& data) const
@@ -91,18 +97,44 @@ std::vector<int> FileReader::getVectorInt(std::string const& data) const
     {
         buffer = m_content.at(data);
     }
-    catch (std::out_of_range const& oor) 
+    catch (std::out_of_range const& oor)
     {
-        std::string title = m_file_name;
-        std::string body = "la valeur \"" + data + "\" est manquante";
-        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, title.c_str(), body.c_str(), NULL);
-        exit(0);
+        report("la valeur \"" + data + "\" est manquante");
     }
     std::vector <int> values;
-    while(buffer.find(',') != std::string::npos)
+    try
     {
-        values.push_back(std::stoi(buffer.substr(0, buffer.find(','))));
-        buffer = buffer.substr(buffer.find(',') + 1);
+        while(buffer.find(',') != std::string::npos)
+        {
+            values.push_back(std::stoi(buffer.substr(0, buffer.find(','))));
+            buffer = buffer.substr(buffer.find(',') + 1);
+        }
+    }
+    catch(std::exception const& e)
+    {
+        report("la valeur \"" + data + "\" n'est pas une liste d'entiers");
+        values.clear();
+    }
+    return values;
+}
+
+std::vector<double> FileReader::getVectorDouble(std::string const& data) const
+{
+    std::string buffer = getString(data) + ","; //the last value does not need to be followed by a comma
+    std::vector <double> values;
+    try
+    {
+        while(buffer.find(',') != std::string::npos)
+        {
+            if(buffer.find(',') > 0)
+                values.push_back(std::stod(buffer.substr(0, buffer.find(','))));
+            buffer = buffer.substr(buffer.find(',') + 1);
+        }
+    }
+    catch(std::exception const& e)
+    {
+        report("la valeur \"" + data + "\" n'est pas une liste de nombres");
+        values.clear();
     }
     return values;
 }
@@ -110,4 +142,9 @@ std::vector<int> FileReader::getVectorInt(std::string const& data) const
 int FileReader::getCount() const
 {
     return m_content.size();
-}
\ No newline at end of file
+}
+
+bool FileReader::has(std::string const& data) const
+{
+    return m_content.count(data) > 0;
+}
\ No newline at end of file
@@ -3,21 +3,32 @@
 
 #include <map>
 #include <vector>
+#include <string>
 
 
+//reads the "key=value" files of the settings
+//an error (missing file or value, wrong number) is fatal, unless a list of errors is given: it is then added to it and a default value is returned
 class FileReader
 {
 public:
+    FileReader(std::vector <std::string> *errors = NULL);
+
     void read(std::string const& file_name);
     std::string getString(std::string const& data) const;
     int getInt(std::string const& data) const;
     double getDouble(std::string const& data) const;
     std::vector<int> getVectorInt(std::string const& data) const;
+    std::vector<double> getVectorDouble(std::string const& data) const;
     int getCount() const;
+    bool has(std::string const& data) const;
 
 private:
+    void report(std::string const& body) const;
+
     std::map <std::string, std::string> m_content;
     std::string m_file_name;
+    std::vector <std::string> *m_errors;
+    bool m_opened;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include "Hud.hpp"
+#include "FileReader.hpp"
+#ifdef SIMUWORLD_COUNT_ALLOCATIONS
+    #include "Allocations.hpp"
+#endif
+
+static const int HUD_FRAMES = 120; //length of the rolling history
+static const int HUD_WIDTH = 330; //width of the overlay in pixels
+
+Hud::Hud()
+{
+    FileReader fr;
+    fr.read("settings//font.txt");
+    m_font = TTF_OpenFont("font.ttf", fr.getInt("size") * 3/4);
+    m_color = {255, 255, 255, 255};
+    m_color_warning = {255, 0, 0, 255};
+    m_spacing = fr.getInt("spacing") * 3/4;
+    m_show = false;
+
+    //the stages of a frame, from the zones of the threads of the simulation and of its workers (update and snapshot) and of Simulation::render
+    char const* zones[] = {"update_timers", "update_scent", "update_grid", "AI_main", "Animal::move", "Map::update", "Blood::update", "Stats::update", "Simulation::publish_snapshot", "Map::render", "Population::render", "Stats::render", "SDL_RenderPresent"};
+    char const* labels[] = {"minuteries", "odeurs", "grille", "IA", "deplacements", "ressources", "sang", "statistiques", "instantane", "carte", "animaux", "texte", "presentation"};
+    for(int i = 0; i < sizeof(zones) / sizeof(zones[0]); i++)
+        m_stages.push_back({zones[i], labels[i], std::vector <double>(HUD_FRAMES, 0)});
+    m_allocations.assign(HUD_FRAMES, 0);
+    m_frame = 0;
+
+#ifdef SIMUWORLD_COUNT_ALLOCATIONS
+    m_last_allocations = get_allocations();
+#else
+    m_last_allocations = 0;
+#endif
+
+    m_animals = 0;
+    m_steps_per_second = 0;
+    m_last_steps = 0;
+    m_last_second = SDL_GetTicks();
+}
+
+Hud::~Hud()
+{
+    if(m_font)
+        TTF_CloseFont(m_font);
+}
+
+bool Hud::get_error() const
+{
+    return !m_font;
+}
+
+void Hud::show_hide()
+{
+    m_show = !m_show;
+}
+
+void Hud::update(int animals, int steps)
+{
+    m_frame = (m_frame + 1) % HUD_FRAMES;
+
+    //time spent in each stage since the last frame (a zone can appear several times, for example several updates per frame)
+    //the workers run the same stage at the same time on their tiles: the stage lasts as long as its slowest thread
+    for(int s = 0; s < m_stages.size(); s++)
+        m_stages[s].history[m_frame] = 0;
+    Profiler::get_threads(m_threads);
+    std::vector <double> durations(m_stages.size());
+    for(int t = 0; t < m_threads.size(); t++)
+    {
+        Profiler::get_events(m_threads[t], m_cursors[m_threads[t]], m_events);
+        std::fill(durations.begin(), durations.end(), 0);
+        for(int e = 0; e < m_events.size(); e++)
+            for(int s = 0; s < m_stages.size(); s++)
+                if(strcmp(m_events[e].name, m_stages[s].zone) == 0)
+                    durations[s] += m_events[e].duration / 1e6;
+        for(int s = 0; s < m_stages.size(); s++)
+            m_stages[s].history[m_frame] = std::max(m_stages[s].history[m_frame], durations[s]);
+    }
+
+#ifdef SIMUWORLD_COUNT_ALLOCATIONS
+    long long allocations = get_allocations();
+    m_allocations[m_frame] = allocations - m_last_allocations;
+    m_last_allocations = allocations;
+#endif
+
+    m_animals = animals;
+    if(SDL_GetTicks() - m_last_second >= 1000)
+    {
+        m_steps_per_second = (steps - m_last_steps) * 1000 / int(SDL_GetTicks() - m_last_second);
+        m_last_steps = steps;
+        m_last_second = SDL_GetTicks();
+    }
+}
+
+void Hud::render(SDL_Renderer *renderer, SDL_Point const& winsize)
+{
+    if(!m_show)
+        return;
+
+    int x = std::max(0, winsize.x - HUD_WIDTH);
+    int lines = m_stages.size() + 4;
+
+    //dark background so that the text stays readable over the map
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+    SDL_Rect background = {x, 0, HUD_WIDTH, lines * m_spacing + m_spacing/2};
+    SDL_RenderFillRect(renderer, &background);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+    char text[64];
+    int line = 0;
+    for(int s = 0; s < m_stages.size(); s++, line++)
+    {
+        snprintf(text, sizeof(text), "%s: %.2f ms", m_stages[s].label.c_str(), get_average(m_stages[s].history));
+        render_text(renderer, text, x + 5, line * m_spacing);
+        SDL_Rect area = {x + HUD_WIDTH - HUD_FRAMES - 5, line * m_spacing + 2, HUD_FRAMES, m_spacing - 4};
+        render_sparkline(renderer, m_stages[s].history, area);
+    }
+
+    line += 1;
+    render_text(renderer, "animaux: " + std::to_string(m_animals), x + 5, line++ * m_spacing);
+#ifdef SIMUWORLD_COUNT_ALLOCATIONS
+    snprintf(text, sizeof(text), "allocations: %.0f / image", get_average(m_allocations));
+#else
+    snprintf(text, sizeof(text), "allocations: non comptees");
+#endif
+    render_text(renderer, text, x + 5, line++ * m_spacing);
+    render_text(renderer, "pas par seconde: " + std::to_string(m_steps_per_second), x + 5, line++ * m_spacing);
+}
+
+void Hud::render_text(SDL_Renderer *renderer, std::string const& text, int x, int y)
+{
+    SDL_Surface *surface = TTF_RenderText_Blended(m_font, text.c_str(), m_color);
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_Rect rect = {x, y, surface->w, surface->h};
+    SDL_RenderCopy(renderer, texture, NULL, &rect);
+    SDL_FreeSurface(surface);
+    SDL_DestroyTexture(texture);
+}
+
+void Hud::render_sparkline(SDL_Renderer *renderer, std::vector <double> const& history, SDL_Rect const& area) //the oldest frame on the left
+{
+    double maximum = *std::max_element(history.begin(), history.end());
+    if(maximum <= 0)
+        return;
+
+    //the last frame is drawn in red when it is a spike (twice the average)
+    bool spike = history[m_frame] > 2 * get_average(history) && history[m_frame] > 1;
+    SDL_Color color = spike ? m_color_warning : m_color;
+    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
+
+    for(int i = 1; i < HUD_FRAMES; i++)
+    {
+        double previous = history[(m_frame + i) % HUD_FRAMES], current = history[(m_frame + i + 1) % HUD_FRAMES];
+        SDL_RenderDrawLine(renderer, area.x + i - 1, area.y + area.h - area.h * previous / maximum, area.x + i, area.y + area.h - area.h * current / maximum);
+    }
+}
+
+double Hud::get_average(std::vector <double> const& history) const
+{
+    double total = 0;
+    for(int i = 0; i < history.size(); i++)
+        total += history[i];
+    return total / history.size();
+}
@@ -0,0 +1,59 @@
+#ifndef DEF_HUD
+#define DEF_HUD
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include "Profiler.hpp"
+
+struct HudStage
+{
+    char const* zone; //name of the profiler zone
+    std::string label;
+    std::vector <double> history; //ms of the last frames (ring)
+};
+
+//overlay of the performances: time of each stage during the last frames, animals, allocations and steps per second
+//it reads the profiler zones recorded by every thread: the display, the simulation and its workers
+class Hud
+{
+public:
+    Hud();
+    ~Hud();
+
+    bool get_error() const;
+
+    void show_hide();
+    void update(int animals, int steps); //once per frame: collects the zones of the frame and the steps done meanwhile
+    void render(SDL_Renderer *renderer, SDL_Point const& winsize);
+
+private:
+    void render_text(SDL_Renderer *renderer, std::string const& text, int x, int y);
+    void render_sparkline(SDL_Renderer *renderer, std::vector <double> const& history, SDL_Rect const& area);
+    double get_average(std::vector <double> const& history) const;
+
+    TTF_Font *m_font;
+    SDL_Color m_color;
+    SDL_Color m_color_warning;
+    int m_spacing;
+    bool m_show;
+
+    std::vector <HudStage> m_stages;
+    std::vector <double> m_allocations; //per frame (ring)
+    int m_frame; //index of the current frame in the rings
+
+    std::vector <int> m_threads;
+    std::map <int, uint64_t> m_cursors; //position in the events of each thread of the profiler
+    std::vector <ProfileEvent> m_events;
+    long long m_last_allocations;
+
+    int m_animals;
+    int m_steps_per_second;
+    int m_last_steps;
+    unsigned int m_last_second;
+};
+
+#endif
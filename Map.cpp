@@ -2,41 +2,37 @@
 #include <SDL2/SDL_image.h>
 #include <cstdlib>
 #include <fstream>
+#include <cstring>
+#include <algorithm>
 #include "Map.hpp"
-#include "speed.hpp"
-#include "FileReader.hpp"
 
-Map::Map(SDL_Renderer *renderer)
+Map::Map(Scenario const& scenario, Random const& random, SDL_Renderer *renderer): m_scenario(scenario), m_random(random)
 {
     m_mapsize = {0, 0};
-    m_last_update = SDL_GetTicks();
+    m_last_update = 0;
+    m_logging = false;
+    m_fields_needed = true;
 
     std::string name;
-    FileReader fr;
-    fr.read("settings//map.txt");
-    m_biomes.resize(fr.getCount() - 2, NULL);
+    m_biomes.resize(m_scenario.get_biomes_number(), NULL);
+    m_resources.resize(m_scenario.get_resources_number(), NULL);
+    m_number.assign(m_resources.size(), 0);
+    m_fields.assign(m_resources.size(), NULL);
+    m_textured = (renderer != NULL);
+    if(!m_textured)
+        return;
+
     for(int i = 0; i < m_biomes.size(); i++)
     {
         name = "map//biome_" + std::to_string(i + 1) + ".png";
         m_biomes[i] = IMG_LoadTexture(renderer, name.c_str());
     }
 
-    fr.read("settings//resources_init.txt");
-    m_resources.resize(fr.getCount(), NULL);
     for(int i = 0; i < m_resources.size(); i++)
     {
         name = "map//resource_" + std::to_string(i + 1) + ".png";
         m_resources[i] = IMG_LoadTexture(renderer, name.c_str());
     }
-
-    for(int i = 0; i < m_resources.size(); i++)
-    {
-        fr.read("settings//resource_" + std::to_string(i + 1) + ".txt");
-        m_location.push_back(fr.getVectorInt("location"));
-        m_adaptive.push_back(fr.getInt("adaptive"));
-        m_target.push_back(fr.getInt("target"));
-        m_add.push_back(fr.getInt("add"));
-    }
 }
 
 Map::~Map()
@@ -45,14 +41,20 @@ Map::~Map()
         SDL_DestroyTexture(m_biomes[i]);
     for(int i = 0; i < m_resources.size(); i++)
         SDL_DestroyTexture(m_resources[i]);
-
+    for(int i = 0; i < m_fields.size(); i++)
+        delete m_fields[i];
 }
 
 bool Map::get_error() const
 {
+    if(m_scenario.get_biomes_number() < 1)
+    {
+        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Erreur de parametre", "settings//map.txt ne contient aucun biome", NULL);
+        return true;
+    }
     for(int i = 0; i < m_biomes.size(); i++)
     {
-        if(!m_biomes[i])
+        if(!m_biomes[i] && m_textured)
         {
             std::string error = "map//biome_" + std::to_string(i + 1) + ".png n'a pas pu etre ouvert";
             SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Erreur de texture", error.c_str(), NULL);
@@ -61,7 +63,7 @@ bool Map::get_error() const
     }
     for(int i = 0; i < m_resources.size(); i++)
     {
-        if(!m_resources[i])
+        if(!m_resources[i] && m_textured)
         {
             std::string error = "map//resource_" + std::to_string(i + 1) + ".png n'a pas pu etre ouvert";
             SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Erreur de texture", error.c_str(), NULL);
@@ -73,22 +75,16 @@ bool Map::get_error() const
 
 void Map::generate()
 {
-    FileReader fr;
-    fr.read("settings//map.txt");
-
-    m_mapsize.x = fr.getInt("width");
-    m_mapsize.y = fr.getInt("height");
-    m_map.resize(m_mapsize.x, std::vector <int>(m_mapsize.y, 100)); //de base, le biome de la map est le biome_1 (au cas ou il n'y en a qu'un)
-
-    std::vector <int> biome_percent;
-    std::vector <int> resource_number;
-
-    for(int i = 0; i < m_biomes.size(); i++)
-        biome_percent.push_back(fr.getInt("biome_" + std::to_string(i + 1)));
+    m_mapsize.x = m_scenario.width;
+    m_mapsize.y = m_scenario.height;
+    m_biome_columns.assign(m_mapsize.x, 1); //de base, le biome de la map est le biome_1 (au cas ou il n'y en a qu'un)
+    m_resource_grid.reset(m_mapsize.x, m_mapsize.y, 0);
+    m_number.assign(m_resources.size(), 0);
+    clear_fields(); //built once the resources are placed
+    m_last_update = 0;
 
-    fr.read("settings//resources_init.txt");
-    for(int i = 0; i < m_resources.size(); i++)
-        resource_number.push_back(fr.getInt("resource_" + std::to_string(i + 1)));
+    std::vector <int> const& biome_percent = m_scenario.biome_percent;
+    std::vector <int> const& resource_number = m_scenario.resources_init;
 
     if(m_biomes.size() >= 2) //g�n�ration des biomes (s'il n'y en a qu'un, le travail est d�j� fait)
     {
@@ -99,22 +95,22 @@ void Map::generate()
                 previous_percents += biome_percent[i];
 
             for(int x = m_mapsize.x * previous_percents / 100; x < m_mapsize.x * (previous_percents + biome_percent[biome]) / 100; x++)
-                for(int y = 0; y < m_mapsize.y; y++)
-                    set_biome(x, y, biome + 1);
+                set_biome(x, biome + 1);
         }
     }
 
     int x = 0, y = 0;
     for(int resource = 0; resource < m_resources.size(); resource++) //g�n�ration des ressources positionn�es correctement sur les biomes compatibles
     {
+        int draws = 0; //index of the draw for this resource
         for(int added = 0; added < resource_number[resource]; added++)
         {
             int attempts = 0;
             do
             {
                 attempts += 1;
-                x = rand() % m_mapsize.x;
-                y = rand() % m_mapsize.y;
+                x = random_int(m_random, m_mapsize.x, RANDOM_RESOURCE, resource, 0, draws++);
+                y = random_int(m_random, m_mapsize.y, RANDOM_RESOURCE, resource, 0, draws++);
             }
             while((!is_free(x, y) || !resource_compatible_with_biome(resource + 1, get_biome(x, y))) && attempts < 100);
 
@@ -123,39 +119,59 @@ void Map::generate()
             set_resource(x, y, resource + 1);
         }
     }
+    build_fields();
 }
 
-void Map::render(SDL_Renderer *renderer, SDL_Point const& winsize, Camera const& camera)
+void Map::render(SDL_Renderer *renderer, SDL_Point const& winsize, Camera const& camera, Snapshot const& snapshot) const
 {
     int camera_zoom = camera.get_zoom();
     SDL_Point camera_pos = camera.get_position();
+    SDL_Rect const& area = snapshot.area; //the camera can have moved since the snapshot: the blocks outside of it stay empty
 
     SDL_Rect position = {0, 0, camera_zoom, camera_zoom};
-    for(int x = std::max(0, camera_pos.x/camera_zoom); x < std::min(m_mapsize.x, (camera_pos.x + winsize.x)/camera_zoom + 1); x++)
+    for(int x = std::max(area.x, camera_pos.x/camera_zoom); x < std::min(area.x + area.w, (camera_pos.x + winsize.x)/camera_zoom + 1); x++)
     {
         position.x = x * camera_zoom - camera_pos.x;
-        for(int y = std::max(0, camera_pos.y/camera_zoom); y < std::min(m_mapsize.y, (camera_pos.y + winsize.y)/camera_zoom + 1); y++)
+        for(int y = std::max(area.y, camera_pos.y/camera_zoom); y < std::min(area.y + area.h, (camera_pos.y + winsize.y)/camera_zoom + 1); y++)
         {
             position.y = y * camera_zoom - camera_pos.y;
-            SDL_RenderCopy(renderer, m_biomes[get_biome(x, y) - 1], NULL, &position);
-            if(get_resource(x, y)) //there is a ressource on this block
-                SDL_RenderCopy(renderer, m_resources[get_resource(x, y) - 1], NULL, &position);
+            int resource = snapshot.resources[size_t(y - area.y) * area.w + x - area.x];
+            SDL_RenderCopy(renderer, m_biomes[snapshot.biomes[x - area.x] - 1], NULL, &position);
+            if(resource) //there is a ressource on this block
+                SDL_RenderCopy(renderer, m_resources[resource - 1], NULL, &position);
         }
     }
 }
 
-void Map::update()
+void Map::snapshot(SDL_Rect const& area, Snapshot &snapshot) const
+{
+    SDL_Rect &copied = snapshot.area;
+    copied.x = std::max(0, std::min(m_mapsize.x, area.x));
+    copied.y = std::max(0, std::min(m_mapsize.y, area.y));
+    copied.w = std::max(0, std::min(m_mapsize.x, area.x + area.w) - copied.x);
+    copied.h = std::max(0, std::min(m_mapsize.y, area.y + area.h) - copied.y);
+
+    snapshot.biomes.assign(m_biome_columns.begin() + copied.x, m_biome_columns.begin() + copied.x + copied.w);
+    snapshot.resources.resize(size_t(copied.w) * copied.h);
+    for(int y = 0; y < copied.h; y++)
+        for(int x = 0; x < copied.w; x++)
+            snapshot.resources[size_t(y) * copied.w + x] = m_resource_grid.get(copied.x + x, copied.y + y);
+}
+
+void Map::update(int now)
 {
-    if(SDL_GetTicks() - m_last_update >= 1000 / simulation_speed())
+    if(now - m_last_update >= 1000)
     {
         int x = 0, y = 0;
         for(int resource = 0; resource < m_resources.size(); resource++) //augmentation des ressources positionn�es correctement sur les biomes compatibles
         {
+            int draws = 0; //index of the draw for this resource at this time
             int to_add = 0;
-            if(m_adaptive[resource])
-                to_add = m_target[resource] - get_number(resource + 1);
+            ResourceSettings const& settings = m_scenario.resources[resource];
+            if(settings.adaptive)
+                to_add = settings.target - get_number(resource + 1);
             else
-                to_add = m_add[resource];
+                to_add = settings.add;
 
             for(int added = 0; added < to_add; added++)
             {
@@ -163,8 +179,8 @@ void Map::update()
                 do
                 {
                     attempts += 1;
-                    x = rand() % m_mapsize.x;
-                    y = rand() % m_mapsize.y;
+                    x = random_int(m_random, m_mapsize.x, RANDOM_RESOURCE, resource, now, draws++);
+                    y = random_int(m_random, m_mapsize.y, RANDOM_RESOURCE, resource, now, draws++);
                 }
                 while((!is_free(x, y) || !resource_compatible_with_biome(resource + 1, get_biome(x, y))) && attempts < 100);
 
@@ -173,7 +189,7 @@ void Map::update()
                 set_resource(x, y, resource + 1);
             }
         }
-        m_last_update = SDL_GetTicks();
+        m_last_update = now;
     }
 }
 
@@ -184,47 +200,234 @@ SDL_Point Map::get_size() const
 
 int Map::get_number(int resource) const
 {
-    int number = 0;
-    for(int i = 0; i < m_mapsize.x; i++)
-        for(int j = 0; j < m_mapsize.y; j++)
-            if(get_resource(i, j) == resource)
-                number += 1;
-    return number;
+    return m_number[resource - 1];
 }
 
-int Map::get_biome(int x, int y) const
+int Map::get_biome(int x, int) const //the biomes are columns
 {
-    return m_map[x][y] / 100;
+    return m_biome_columns[x];
 }
 
 int Map::get_resource(int x, int y) const
 {
-    return m_map[x][y] % 100;
+    return m_resource_grid.get(x, y);
 }
 
 void Map::remove_resource(int x, int y)
 {
-    m_map[x][y] = (m_map[x][y] / 100) * 100;
+    set_resource(x, y, 0);
 }
 
 void Map::set_resource(int x, int y, int resource)
 {
-    m_map[x][y] = (m_map[x][y] / 100) * 100 + resource;
+    int previous = m_resource_grid.get(x, y);
+    if(previous == resource)
+        return;
+    if(previous)
+    {
+        m_number[previous - 1] -= 1;
+        if(m_fields[previous - 1])
+            m_fields[previous - 1]->remove_source(x, y);
+    }
+    if(resource)
+    {
+        m_number[resource - 1] += 1;
+        if(m_fields[resource - 1])
+            m_fields[resource - 1]->add_source(x, y);
+    }
+    m_resource_grid.set(x, y, resource); //the chunk is freed when its last resource is eaten
+    if(m_logging)
+        m_changes.push_back({x, y});
+}
+
+void Map::set_biome(int x, int biome)
+{
+    m_biome_columns[x] = biome;
+}
+
+void Map::clear_fields()
+{
+    for(int i = 0; i < m_fields.size(); i++)
+    {
+        delete m_fields[i];
+        m_fields[i] = NULL;
+    }
+}
+
+void Map::create_fields() //a field for each resource eaten by a specie, as far as the farthest of them looks (plus the block they stand on)
+{
+    for(int resource = 0; resource < m_fields.size(); resource++)
+    {
+        int range = 0;
+        for(int i = 0; i < m_scenario.species.size(); i++)
+        {
+            std::vector <int> const& plants = m_scenario.species[i].plants;
+            if(std::find(plants.begin(), plants.end(), resource + 1) != plants.end())
+                range = std::max(range, m_scenario.species[i].plant_range_detection + 1);
+        }
+
+        delete m_fields[resource];
+        m_fields[resource] = NULL;
+        if(range > 0)
+        {
+            m_fields[resource] = new DistanceField();
+            m_fields[resource]->reset(m_mapsize.x, m_mapsize.y, range); //at most 127, the species looking further search the map
+        }
+    }
+}
+
+void Map::build_fields()
+{
+    if(!m_fields_needed)
+        return;
+    create_fields();
+
+    //all the resources of the map spread together
+    int const size = ChunkGrid<unsigned char>::CHUNK_SIZE;
+    for(size_t i = 0; i < m_resource_grid.get_directory_size(); i++)
+    {
+        unsigned char const* blocks = m_resource_grid.get_chunk(i);
+        if(!blocks)
+            continue;
+        int origin_x = 0, origin_y = 0;
+        m_resource_grid.get_chunk_origin(i, origin_x, origin_y);
+        for(int b = 0; b < size * size; b++)
+            if(blocks[b] && m_fields[blocks[b] - 1])
+                m_fields[blocks[b] - 1]->add_source_later(origin_x + b % size, origin_y + b / size);
+    }
+    for(int resource = 0; resource < m_fields.size(); resource++)
+        if(m_fields[resource])
+            m_fields[resource]->spread();
+}
+
+int Map::get_field_range(int resource) const
+{
+    return m_fields[resource - 1] ? m_fields[resource - 1]->get_range() : 0;
 }
 
-void Map::set_biome(int x, int y, int biome)
+bool Map::get_nearest_resource(int resource, int x, int y, SDL_Point &found) const
 {
-    m_map[x][y] = m_map[x][y] % 100 + 100 * biome;
+    return m_fields[resource - 1] && m_fields[resource - 1]->get_nearest(x, y, found);
 }
 
 bool Map::resource_compatible_with_biome(int resource, int biome) const
 {
-    for(int i = 0; i < m_location[resource-1].size(); i++)
-        if(m_location[resource-1][i] == biome)
+    std::vector <int> const& location = m_scenario.resources[resource-1].location;
+    for(int i = 0; i < location.size(); i++)
+        if(location[i] == biome)
             return true;
     return false;
 }
 
+void Map::save_state(CheckpointWriter &cp, int now, bool fields) const
+{
+    cp.add_value(int32_t(m_mapsize.x));
+    cp.add_value(int32_t(m_mapsize.y));
+    cp.add_value(int32_t(now - m_last_update));
+    cp.add(m_biome_columns.data(), m_biome_columns.size());
+
+    //only the allocated chunks of resources, straight from the grid
+    cp.add_value(int32_t(m_resource_grid.get_chunks_number()));
+    for(size_t i = 0; i < m_resource_grid.get_directory_size(); i++)
+    {
+        if(m_resource_grid.get_chunk(i))
+        {
+            cp.add_value(int64_t(i));
+            cp.add(m_resource_grid.get_chunk(i), ChunkGrid<unsigned char>::CHUNK_SIZE * ChunkGrid<unsigned char>::CHUNK_SIZE);
+        }
+    }
+
+    cp.add_value(int32_t(fields ? m_fields.size() : 0));
+    for(int i = 0; fields && i < m_fields.size(); i++)
+    {
+        cp.add_value(int32_t(m_fields[i] != NULL));
+        if(m_fields[i])
+            m_fields[i]->save_state(cp);
+    }
+}
+
+bool Map::load_state(CheckpointReader &cp, int now)
+{
+    int32_t width = 0, height = 0, since_last_update = 0;
+    if(!cp.read_value(width) || !cp.read_value(height) || !cp.read_value(since_last_update) || width <= 0 || height <= 0)
+        return false;
+
+    unsigned char const* biomes = static_cast<unsigned char const*>(cp.view(width));
+    if(!biomes)
+        return false;
+
+    m_mapsize = {width, height};
+    m_biome_columns.assign(biomes, biomes + width);
+    for(int x = 0; x < width; x++) //the textures are indexed by those values
+        if(m_biome_columns[x] < 1 || m_biome_columns[x] > m_biomes.size())
+            return false;
+
+    int const size = ChunkGrid<unsigned char>::CHUNK_SIZE;
+    int32_t chunks = 0;
+    if(!cp.read_value(chunks) || chunks < 0)
+        return false;
+    m_resource_grid.reset(width, height, 0);
+    m_number.assign(m_resources.size(), 0);
+    clear_fields();
+    for(int c = 0; c < chunks; c++)
+    {
+        int64_t index = 0;
+        unsigned char const* blocks = NULL;
+        if(!cp.read_value(index) || index < 0 || index >= m_resource_grid.get_directory_size() || !(blocks = static_cast<unsigned char const*>(cp.view(size * size))))
+            return false;
+
+        int origin_x = 0, origin_y = 0;
+        m_resource_grid.get_chunk_origin(index, origin_x, origin_y);
+        for(int i = 0; i < size * size; i++)
+        {
+            int x = origin_x + i % size, y = origin_y + i / size;
+            if(blocks[i] > m_resources.size() || (blocks[i] && (x >= width || y >= height)))
+                return false;
+            if(blocks[i])
+                set_resource(x, y, blocks[i]);
+        }
+    }
+    m_last_update = now - since_last_update;
+
+    //the saved fields when they match the current settings (same ranges), otherwise they are rebuilt
+    int32_t fields = 0;
+    if(!cp.read_value(fields) || fields < 0)
+        return false;
+    bool matching = m_fields_needed && fields == m_fields.size();
+    if(matching)
+        create_fields();
+    for(int i = 0; i < fields; i++)
+    {
+        int32_t present = 0;
+        if(!cp.read_value(present))
+            return false;
+        if(!present)
+        {
+            matching = matching && !m_fields[i];
+            continue;
+        }
+        DistanceField *field = new DistanceField();
+        if(!field->load_state(cp, width, height))
+        {
+            delete field;
+            return false;
+        }
+        if(matching && m_fields[i] && m_fields[i]->get_range() == field->get_range())
+        {
+            delete m_fields[i];
+            m_fields[i] = field;
+        }
+        else
+        {
+            delete field;
+            matching = false;
+        }
+    }
+    if(!matching)
+        build_fields();
+    return true;
+}
+
 bool Map::is_free(int x, int y) const
 {
     if(get_resource(x, y) != 0)
@@ -4,11 +4,17 @@
 #include <SDL2/SDL.h>
 #include <vector>
 #include "Camera.hpp"
+#include "Checkpoint.hpp"
+#include "Scenario.hpp"
+#include "Random.hpp"
+#include "ChunkGrid.hpp"
+#include "DistanceField.hpp"
+#include "Snapshot.hpp"
 
 class Map
 {
 public:
-    Map(SDL_Renderer *renderer);
+    Map(Scenario const& scenario, Random const& random, SDL_Renderer *renderer = NULL); //without renderer (simulation without window), no texture is loaded
     ~Map();
 
     bool get_error() const;
@@ -17,32 +23,51 @@ public:
 
     void generate();
 
-    void render(SDL_Renderer *renderer, SDL_Point const& winsize, class Camera const& camera);
-    void update();
+    void render(SDL_Renderer *renderer, SDL_Point const& winsize, class Camera const& camera, Snapshot const& snapshot) const; //only reads the textures and the snapshot
+    void update(int now);
+    void snapshot(SDL_Rect const& area, Snapshot &snapshot) const; //copies the biomes and the resources of the area (cut by the borders of the map)
 
     int get_resource(int x, int y) const;
     int get_biome(int x, int y) const;
     void set_resource(int x, int y, int resource);
-    void set_biome(int x, int y, int biome);
+    void set_biome(int x, int biome); //the biomes are vertical strips: the whole column
     void remove_resource(int x, int y);
 
+    int get_field_range(int resource) const; //0 if no specie eats it
+    bool get_nearest_resource(int resource, int x, int y, SDL_Point &found) const; //false if there is none within the range of the field
+
     bool is_free(int x, int y) const;
 
+    void save_state(CheckpointWriter &cp, int now, bool fields = true) const; //without the fields, they are rebuilt from the resources at the load
+    bool load_state(CheckpointReader &cp, int now);
+
 private:
+    friend class EventRecorder; //logs the blocks changed during each step
+    friend class Replay; //does without the fields
+
     bool resource_compatible_with_biome(int resource, int biome) const;
+    void clear_fields();
+    void create_fields(); //empty, with the range of the species eating each resource
+    void build_fields();
+
+    Scenario const& m_scenario;
+    Random const& m_random;
 
     std::vector <SDL_Texture*> m_resources;
     std::vector <SDL_Texture*> m_biomes;
+    bool m_textured;
 
-    std::vector < std::vector <int> > m_map;
+    std::vector <unsigned char> m_biome_columns; //biome of each column
+    ChunkGrid <unsigned char> m_resource_grid; //resource of each block, only the chunks containing resources are allocated
     SDL_Point m_mapsize;
+    std::vector <int> m_number; //number of blocks of each resource, kept up to date instead of counting the whole map
+    std::vector <DistanceField*> m_fields; //nearest block of each resource eaten by a specie (NULL for the others), updated with the resources
+    bool m_fields_needed; //false in a replay, where no animal looks for plants
 
     int m_last_update;
 
-    std::vector <bool> m_adaptive;
-    std::vector <int> m_target;
-    std::vector <int> m_add;
-    std::vector < std::vector <int> > m_location;
+    bool m_logging; //the changed blocks are kept for the event log
+    std::vector <SDL_Point> m_changes;
 };
 
 #endif
@@ -3,42 +3,44 @@
 #include <string>
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <functional>
 #include "Population.hpp"
-#include "speed.hpp"
-#include "FileReader.hpp"
+#include "Profiler.hpp"
 
-Population::Population(SDL_Renderer *renderer)
+//animals a tile may have beyond 25% more than the average before the tiles are recut: with a small population
+//a few births or deaths are enough to pass the 25%, and a recut costs more than the imbalance
+static const int RECUT_SLACK = 64;
+
+Population::Population(Scenario const& scenario, Random const& random, SDL_Renderer *renderer): m_scenario(scenario), m_random(random), m_view(false)
 {
-    FileReader fr;
-    fr.read("settings//species_init.txt");
-    int species_number = fr.getCount();
-    m_texture.resize(species_number, NULL);
+    m_textured = (renderer != NULL);
+    m_texture.resize(m_scenario.get_species_number(), NULL);
+    m_mapsize = {0, 0};
 
     std::string name;
-    for(int i = 0; i < species_number; i++)
+    for(int i = 0; i < m_texture.size() && m_textured; i++)
     {
         name = "animals//specie_" + std::to_string(i + 1) + ".png";
         m_texture[i] = IMG_LoadTexture(renderer, name.c_str());
     }
 
-    fr.read("settings//nutritional_value.txt");
-    int all_number = fr.getCount();
-    m_nutritional_value.resize(all_number);
-
-    for(int i = 0; i < all_number; i++)
-    {
-        if(i < species_number)
-            name = "specie_" + std::to_string(i + 1);
-        else
-            name = "resource_" + std::to_string(i + 1 - species_number);
-        m_nutritional_value[i] = fr.getInt(name);
-    }
-
-    m_bubble = new Bubble();
+    m_bubble = m_textured ? new Bubble() : NULL;
     m_show_bubble = true;
 
-    m_blood = new Blood(renderer);
+    m_blood = new Blood(renderer, m_scenario.blood_disappearance_time);
     m_show_blood = true;
+
+    m_scent = new Scent(m_scenario);
+    m_logging = false;
+
+    m_next_id = 1;
+    m_time = 0;
+
+    m_tiles.push_back(new Tile(false));
+    m_pool = NULL;
+    m_recut = true;
+    m_view_outdated = true;
 }
 
 Population::~Population()
@@ -49,12 +51,23 @@ Population::~Population()
     for(int i = 0; i < m_animals.size(); i++)
         delete m_animals[i];
 
+    for(int i = 0; i < m_tiles.size(); i++)
+        delete m_tiles[i];
+    delete m_pool;
+
     delete m_blood;
+    delete m_scent;
+    delete m_bubble;
 }
 
 bool Population::get_error() const
 {
-    for(int i = 0; i < m_texture.size(); i++)
+    if(m_scenario.nutritional_value.size() < m_scenario.get_species_number() + m_scenario.get_resources_number())
+    {
+        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Erreur de parametre", "settings//nutritional_value.txt est incomplet", NULL);
+        return true;
+    }
+    for(int i = 0; i < m_texture.size() && m_textured; i++)
     {
         if(!m_texture[i])
         {
@@ -77,197 +90,671 @@ void Population::generate()
     m_animals.clear();
 
 
-    FileReader fr;
-    fr.read("settings//map.txt");
-
-    m_mapsize.x = fr.getInt("width");
-    m_mapsize.y = fr.getInt("height");
-    m_animal_map.resize(m_mapsize.x, std::vector < std::vector <Animal*> >(m_mapsize.y));
-
-    fr.read("settings//species_init.txt");
-    std::vector <int> to_add;
-    for(int i = 0; i < m_texture.size(); i++)
-        to_add.push_back(fr.getInt("specie_" + std::to_string(i + 1)));
+    m_mapsize.x = m_scenario.width;
+    m_mapsize.y = m_scenario.height;
+    m_time = 0;
+    m_timers.reset(0);
+    m_scent->reset(m_mapsize.x, m_mapsize.y, 0);
 
+    std::vector <int> const& to_add = m_scenario.species_init;
     for(int specie = 0; specie < to_add.size(); specie++)
     {
         for(int added = 0; added < to_add[specie]; added++)
         {
-            Vector2d pos = {(rand() % m_mapsize.x) + 0.5, (rand() % m_mapsize.y) + 0.5};
-            m_animals.push_back(new Animal(pos, specie + 1));
+            Vector2d pos;
+            pos.x = random_int(m_random, m_mapsize.x, RANDOM_POSITION, m_next_id, 0, 0) + 0.5;
+            pos.y = random_int(m_random, m_mapsize.y, RANDOM_POSITION, m_next_id, 0, 1) + 0.5;
+            m_animals.push_back(new Animal(m_next_id++, pos, specie + 1, m_scenario.species[specie], m_random, 0));
+            schedule(m_animals.back());
         }
     }
+    distribute();
+}
+
+void Population::set_threads(int threads)
+{
+    threads = std::max(1, std::min(threads, m_scenario.width)); //at least a column per tile
+
+    for(int i = 0; i < m_tiles.size(); i++)
+        delete m_tiles[i];
+    m_tiles.clear();
+    for(int i = 0; i < threads; i++)
+        m_tiles.push_back(new Tile(threads > 1));
+
+    delete m_pool;
+    m_pool = threads > 1 ? new WorkerPool(threads) : NULL;
+    distribute();
 }
 
-void Population::render(SDL_Renderer *renderer, SDL_Point const& winsize, Camera const& camera)
+void Population::distribute() //gives all the animals to the first tile, the next update recuts the map
+{
+    for(int i = 0; i < m_tiles.size(); i++)
+    {
+        Tile &tile = *m_tiles[i];
+        tile.begin = 0;
+        tile.end = (i == 0) ? m_mapsize.x : 0;
+        tile.animals.clear();
+        tile.halo.clear();
+        tile.halo_sources.clear();
+        tile.grid.reset(m_mapsize.x, m_mapsize.y, std::vector <Animal*>());
+        tile.occupied.clear();
+    }
+    m_tiles[0]->animals = m_animals;
+    m_recut = true;
+
+    m_view.grid.reset(m_mapsize.x, m_mapsize.y, std::vector <Animal*>());
+    m_view.occupied.clear();
+    m_view_outdated = true;
+}
+
+void Population::render(SDL_Renderer *renderer, SDL_Point const& winsize, Camera const& camera, Snapshot const& snapshot, Snapshot const& previous, double progress)
 {
     int camera_zoom = camera.get_zoom();
     SDL_Point camera_pos = camera.get_position();
 
     if(m_show_blood)
-        m_blood->render(renderer, winsize, camera);
+        m_blood->render(renderer, winsize, camera, snapshot.stains);
+
+    //the animals of the snapshot, moved back toward where they were in the previous one so that their moves look smooth between two steps
+    std::vector <AnimalSnapshot> const& animals = snapshot.animals;
+    std::vector <SDL_Point> positions(animals.size());
+    for(int i = 0; i < animals.size(); i++)
+    {
+        Vector2d pos = snapshot.get_position(animals[i], previous, progress);
+        positions[i].x = pos.x * camera_zoom - camera_pos.x - camera_zoom/2;
+        positions[i].y = pos.y * camera_zoom - camera_pos.y - camera_zoom/2;
+    }
 
     SDL_Rect position = {0, 0, camera_zoom, camera_zoom};
     SDL_Rect portion = {0, 0, 48, 48};
-    for(int i = 0; i < m_animals.size(); i++)
+    for(int i = 0; i < animals.size(); i++)
     {
-        position.x = m_animals[i]->get_position().x * camera_zoom - camera_pos.x - camera_zoom/2;
-        position.y = m_animals[i]->get_position().y * camera_zoom - camera_pos.y - camera_zoom/2;
+        position.x = positions[i].x;
+        position.y = positions[i].y;
         if(position.x + camera_zoom > 0 && position.x < winsize.x && position.y + camera_zoom > 0 && position.y < winsize.y)
         {
-            portion.x = (m_animals[i]->get_color() % 4) * 144 + m_animals[i]->get_animation() * 48;
-            portion.y = m_animals[i]->get_direction() * 48 + (m_animals[i]->get_color() / 4) * 192;
-            SDL_RenderCopy(renderer, m_texture[m_animals[i]->get_specie() - 1], &portion, &position);
+            portion.x = (animals[i].color % 4) * 144 + animals[i].animation * 48;
+            portion.y = animals[i].direction * 48 + (animals[i].color / 4) * 192;
+            SDL_RenderCopy(renderer, m_texture[animals[i].specie - 1], &portion, &position);
         }
     }
 
     if(m_show_bubble)
     {
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_Point pos;
-        for(int n = 0; n < m_animals.size(); n++)
+        for(int n = 0; n < animals.size(); n++)
+            if(positions[n].x + camera_zoom > 0 && positions[n].x < winsize.x && positions[n].y + camera_zoom > 0 && positions[n].y < winsize.y)
+                m_bubble->render(renderer, positions[n], animals[n], camera_zoom);
+    }
+}
+
+void Population::snapshot(SDL_Rect const& area, Snapshot &snapshot) const
+{
+    //the blocks of the area, and those next to it whose animals overlap its borders
+    update_view();
+    std::vector <AnimalSnapshot> &animals = snapshot.animals;
+    animals.clear();
+    for(int x = std::max(0, area.x - 1); x < std::min(m_mapsize.x, area.x + area.w + 1); x++)
+    {
+        for(int y = std::max(0, area.y - 1); y < std::min(m_mapsize.y, area.y + area.h + 1); y++)
         {
-            pos.x = m_animals[n]->get_position().x * camera_zoom - camera_pos.x - camera_zoom/2;
-            pos.y = m_animals[n]->get_position().y * camera_zoom - camera_pos.y - camera_zoom/2;
-            if(pos.x + camera_zoom > 0 && pos.x < winsize.x && pos.y + camera_zoom > 0 && pos.y < winsize.y)
-                m_bubble->render(renderer, pos, m_animals[n], camera_zoom);
+            std::vector <Animal*> const& block = m_view.grid.get(x, y);
+            for(int i = 0; i < block.size(); i++)
+            {
+                Animal const& animal = *block[i];
+                animals.push_back({animal.get_id(), animal.get_position(), animal.get_specie(), animal.get_color(), animal.get_animation(), animal.get_direction(), animal.get_health(m_time), animal.is_male()});
+            }
         }
     }
+    std::sort(animals.begin(), animals.end(), [](AnimalSnapshot const& a, AnimalSnapshot const& b)
+    {
+        return a.id < b.id;
+    });
+
+    m_blood->snapshot(area, snapshot.stains);
+    snapshot.animals_number = m_animals.size();
 }
 
-void Population::update(Map &map)
+void Population::update_view() const //the grid of the tiles is built before the animals move, the view is built after
 {
-    //update the map contening all animals according to their current position (to optimize the search and interactions between animals)
-    for(int i = 0; i < m_mapsize.x; i++)
-        for(int j = 0; j < m_mapsize.y; j++)
-            m_animal_map[i][j].clear();
+    if(!m_view_outdated)
+        return;
+    m_view.animals = m_animals;
+    update_grid(m_view);
+    m_view_outdated = false;
+}
 
+void Population::update(Map &map, int now)
+{
+    {
+        PROFILE_ZONE("update_timers");
+        update_timers(now);
+    }
+    {
+        PROFILE_ZONE("update_scent");
+        update_scent(now);
+    }
 
-    for(int i = 0; i < m_animals.size(); i++)
-        m_animal_map[m_animals[i]->get_position().x][m_animals[i]->get_position().y].push_back(m_animals[i]);
+    if(m_tiles.size() == 1)
+    {
+        Tile &tile = *m_tiles[0];
+        {
+            PROFILE_ZONE("update_grid");
+            update_grid(tile);
+        }
+
+        //AI of the animals
+        {
+            PROFILE_ZONE("AI_main");
+            AI_main(tile, map, now);
+        }
+        m_animals = tile.animals;
+        m_logged.insert(m_logged.end(), tile.events.begin(), tile.events.end());
+        tile.events.clear();
+    }
+    else //each tile in a thread: the halos are copied by all the tiles before any of them changes its animals
+    {
+        {
+            PROFILE_ZONE("split");
+            split();
+        }
+
+        int width = get_halo_width(m_scenario, now - m_time);
+        m_pool->run(m_tiles.size(), [this, width](int t)
+        {
+            PROFILE_ZONE("update_grid");
+            exchange_halo(*m_tiles[t], width);
+            update_grid(*m_tiles[t]);
+        });
+
+        m_pool->run(m_tiles.size(), [this, &map, now](int t)
+        {
+            PROFILE_ZONE("AI_main");
+            AI_main(*m_tiles[t], map, now);
+        });
 
-    //AI of the animals
-    AI_main(map);
+        PROFILE_ZONE("merge");
+        merge(map, now);
+    }
+    m_time = now;
+    m_view_outdated = true;
 
     //the blood disappeares after some time
-    m_blood->update();
+    PROFILE_ZONE("Blood::update");
+    m_blood->update(now);
+}
+
+void Population::update_grid(Tile &tile) //update the map contening all animals according to their current position (to optimize the search and interactions between animals)
+{
+    tile.emptied.swap(tile.occupied); //the blocks occupied at the previous update
+    for(int i = 0; i < tile.emptied.size(); i++)
+    {
+        tile.grid.at(tile.emptied[i].x, tile.emptied[i].y).clear();
+        tile.grid.add_used(tile.emptied[i].x, tile.emptied[i].y, -1);
+    }
+    tile.occupied.clear();
+
+    int owned = tile.animals.size();
+    for(int i = 0; i < owned + tile.halo.size(); i++)
+    {
+        Animal *animal = (i < owned) ? tile.animals[i] : &tile.halo[i - owned];
+        int x = animal->get_position().x, y = animal->get_position().y;
+        std::vector <Animal*> &block = tile.grid.at(x, y);
+        if(block.empty())
+        {
+            tile.occupied.push_back({x, y});
+            tile.grid.add_used(x, y, 1);
+        }
+        block.push_back(animal);
+    }
+
+    //the chunks left without any animal are freed
+    for(int i = 0; i < tile.emptied.size(); i++)
+        tile.grid.release_if_unused(tile.emptied[i].x, tile.emptied[i].y);
+}
+
+void Population::schedule(Animal *animal) //at its decomposition, predicted from its current state
+{
+    if(animal->get_timer() >= 0)
+        m_timers.remove(animal->get_timer());
+    animal->set_timer(m_timers.add(animal->get_decomposition_time(), animal));
+}
+
+void Population::unschedule(Animal *animal) //the animal leaves the population
+{
+    if(animal->get_timer() >= 0)
+        m_timers.remove(animal->get_timer());
+    animal->set_timer(-1);
+}
+
+void Population::update_timers(int now) //removes the animals which have decomposed, the others have eaten since the prediction and live longer
+{
+    m_decomposed.clear();
+    m_timers.advance(now, [this, now](Animal *animal)
+    {
+        animal->set_timer(-1);
+        if(animal->is_decomposed(now))
+            m_decomposed.push_back(animal);
+        else
+            schedule(animal);
+    });
+    remove_animals(m_decomposed);
+}
+
+void Population::update_scent(int now) //the scent spreads, then every animal of the hunted species (the corpses too) leaves its own where it stands
+{
+    if(!m_scent->is_enabled())
+        return;
+    m_scent->update(now, m_pool);
+    for(int t = 0; t < m_tiles.size(); t++)
+        for(int i = 0; i < m_tiles[t]->animals.size(); i++)
+            m_scent->deposit(m_tiles[t]->animals[i]->get_specie(), m_tiles[t]->animals[i]->get_position().x, m_tiles[t]->animals[i]->get_position().y, now - m_time);
+}
+
+void Population::split() //recuts the tiles if needed and gives the animals which have crossed a border to their new tile
+{
+    int total = 0, largest = 0;
+    for(int t = 0; t < m_tiles.size(); t++)
+    {
+        total += m_tiles[t]->animals.size();
+        largest = std::max<int>(largest, m_tiles[t]->animals.size());
+    }
+    if(m_recut || largest > total * 5 / (4 * m_tiles.size()) + RECUT_SLACK) //a tile has 25% more animals than the average
+        recut();
+
+    for(int t = 0; t < m_tiles.size(); t++)
+    {
+        Tile &tile = *m_tiles[t];
+        int kept = 0;
+        for(int i = 0; i < tile.animals.size(); i++)
+        {
+            double x = tile.animals[i]->get_position().x;
+            if(x >= tile.begin && x < tile.end)
+                tile.animals[kept++] = tile.animals[i];
+            else
+                m_migrants.push_back(tile.animals[i]);
+        }
+        tile.animals.resize(kept);
+    }
+    for(int i = 0; i < m_migrants.size(); i++)
+        m_tiles[get_tile(m_migrants[i]->get_position().x)]->animals.push_back(m_migrants[i]);
+    m_migrants.clear();
+}
+
+void Population::recut() //cuts the map in strips holding the same number of animals
+{
+    m_columns.assign(m_mapsize.x, 0);
+    for(int t = 0; t < m_tiles.size(); t++)
+        for(int i = 0; i < m_tiles[t]->animals.size(); i++)
+            m_columns[std::min(m_mapsize.x - 1, int(m_tiles[t]->animals[i]->get_position().x))] += 1;
+
+    cut(m_columns, m_tiles.size(), m_ends);
+    for(int t = 0; t < m_tiles.size(); t++)
+    {
+        m_tiles[t]->begin = t ? m_ends[t - 1] : 0;
+        m_tiles[t]->end = m_ends[t];
+    }
+    m_recut = false;
+}
+
+void Population::cut(std::vector <int> const& columns, int parts, std::vector <int> &ends)
+{
+    int total = 0;
+    for(int i = 0; i < columns.size(); i++)
+        total += columns[i];
+
+    ends.resize(parts);
+    int column = 0, count = 0;
+    for(int t = 0; t < parts; t++)
+    {
+        int target = (long long)total * (t + 1) / parts;
+        int following = parts - t - 1; //each following part keeps at least a column
+        int begin = column;
+        while(column < int(columns.size()) - following && (count < target || column == begin))
+            count += columns[column++];
+        ends[t] = (following == 0) ? columns.size() : column;
+    }
+}
+
+int Population::get_tile(double x) const
+{
+    for(int t = 0; t < m_tiles.size() - 1; t++)
+        if(x < m_tiles[t]->end)
+            return t;
+    return m_tiles.size() - 1;
+}
+
+int Population::get_halo_width(Scenario const& scenario, int dt) //farthest a tile can look beyond its borders during a step: the ranges, after the animals have moved
+{
+    int range = 1; //at least the blocks around the animal
+    double speed = 0;
+    for(int i = 0; i < scenario.species.size(); i++)
+    {
+        SpecieSettings const& settings = scenario.species[i];
+        range = std::max(range, std::max(settings.prey_range_detection, std::max(settings.partner_range_detection, settings.agressivity_range)));
+        speed = std::max(speed, settings.speed);
+    }
+    return range + int(speed * std::max(dt, 0) / 1000) + 2;
+}
+
+void Population::exchange_halo(Tile &tile, int width) //copies the animals of the other tiles which are less than width columns away from the borders
+{
+    tile.halo.clear();
+    tile.halo_sources.clear();
+    for(int t = 0; t < m_tiles.size(); t++)
+    {
+        Tile const& other = *m_tiles[t];
+        if(&other == &tile || other.end <= tile.begin - width || other.begin >= tile.end + width)
+            continue;
+        for(int i = 0; i < other.animals.size(); i++)
+        {
+            double x = other.animals[i]->get_position().x;
+            if(x >= tile.begin - width && x < tile.end + width)
+            {
+                tile.halo.push_back(*other.animals[i]);
+                tile.halo_sources.push_back(other.animals[i]);
+            }
+        }
+    }
+}
+
+int Population::get_halo_index(Tile const& tile, Animal const* animal) const //-1 if the animal is not a copy of the halo
+{
+    std::less <Animal const*> before;
+    if(tile.halo.empty() || before(animal, tile.halo.data()) || !before(animal, tile.halo.data() + tile.halo.size()))
+        return -1;
+    return animal - tile.halo.data();
 }
 
-void Population::AI_main(Map &map) //main function of the AI
+void Population::merge(Map &map, int now) //applies what the tiles have done to each other, in the order of the tiles so that the result does not depend on the threads
 {
-    for(int index = 0; index < m_animals.size(); index++)
+    m_eaten.clear();
+    for(int t = 0; t < m_tiles.size(); t++)
+    {
+        Tile &tile = *m_tiles[t];
+        for(int i = 0; i < tile.effects.size(); i++)
+        {
+            Animal *target = tile.halo_sources[tile.effects[i].halo];
+            switch(tile.effects[i].type)
+            {
+            case EFFECT_DAMAGE:
+                target->take_damage(tile.effects[i].value, now);
+                if(!target->is_alive(now)) //decomposes sooner than predicted
+                    schedule(target);
+                break;
+            case EFFECT_REPRODUCE:
+                target->reproduce(now);
+                break;
+            case EFFECT_EATEN:
+                m_eaten.push_back(target);
+                break;
+            }
+        }
+        tile.effects.clear();
+
+        for(int i = 0; i < tile.stains.size(); i++)
+            m_blood->add_stain(tile.stains[i]);
+        tile.stains.clear();
+
+        for(int i = 0; i < tile.plants.size(); i++)
+            map.remove_resource(tile.plants[i].x, tile.plants[i].y);
+        tile.plants.clear();
+
+        m_logged.insert(m_logged.end(), tile.events.begin(), tile.events.end());
+        tile.events.clear();
+    }
+
+    for(int t = 0; t < m_tiles.size(); t++)
     {
-        m_animals[index]->update_stats(); //update every sec the stats of the animal
+        for(int i = 0; i < m_tiles[t]->killed.size(); i++)
+            schedule(m_tiles[t]->killed[i]);
+        m_tiles[t]->killed.clear();
+        for(int i = 0; i < m_tiles[t]->eaten.size(); i++)
+            unschedule(m_tiles[t]->eaten[i]);
+        m_tiles[t]->eaten.clear();
+    }
+    for(int i = 0; i < m_eaten.size(); i++)
+        unschedule(m_eaten[i]);
+
+    //the animals eaten by another tile leave their own
+    remove_animals(m_eaten);
+
+    //the newborns join the tile of their parent, their ids are given in the order of the tiles
+    for(int t = 0; t < m_tiles.size(); t++)
+    {
+        Tile &tile = *m_tiles[t];
+        for(int i = 0; i < tile.births.size(); i++)
+        {
+            TileBirth const& birth = tile.births[i];
+            tile.animals.push_back(new Animal(m_next_id++, birth.pos, birth.specie, m_scenario.species[birth.specie - 1], m_random, now, birth.color, birth.father, birth.mother));
+            schedule(tile.animals.back());
+        }
+        tile.births.clear();
+    }
+
+    m_animals.clear();
+    for(int t = 0; t < m_tiles.size(); t++)
+        m_animals.insert(m_animals.end(), m_tiles[t]->animals.begin(), m_tiles[t]->animals.end());
+}
+
+void Population::remove_animals(std::vector <Animal*> &removed) //from the tiles, whichever they are in
+{
+    if(removed.empty())
+        return;
+    std::less <Animal*> before;
+    std::sort(removed.begin(), removed.end(), before);
+    for(int t = 0; t < m_tiles.size(); t++)
+    {
+        std::vector <Animal*> &animals = m_tiles[t]->animals;
+        animals.erase(std::remove_if(animals.begin(), animals.end(), [&removed, &before](Animal *animal)
+        {
+            return std::binary_search(removed.begin(), removed.end(), animal, before);
+        }), animals.end());
+    }
+}
 
-        if(m_animals[index]->is_alive())
+void Population::AI_main(Tile &tile, Map &map, int now) //main function of the AI
+{
+    PROFILE_SAMPLER(move_sampler, "Animal::move", 16);
+    for(int index = 0; index < tile.animals.size(); index++) //the dead animals wait for their decomposition, removed by update_timers
+    {
+        if(tile.animals[index]->is_alive(now))
         {
-            if(m_animals[index]->move()) //moves the animal, if arrived, find a new one
+            bool arrived;
+            {
+                PROFILE_SAMPLE(move_sampler, index);
+                arrived = tile.animals[index]->move(now); //moves the animal
+            }
+            if(arrived) //if arrived, find a new destination
             {
-                if(m_animals[index]->is_hungry()) //in priority, if hungry, find food according to its diet
+                if(tile.animals[index]->is_hungry(now)) //in priority, if hungry, find food according to its diet
                 {
-                    switch(m_animals[index]->get_diet())
+                    switch(tile.animals[index]->get_diet())
                     {
                     case HERBIVORE:
-                        if(!AI_find_plant(index, map))
-                            AI_simulate_search(index);
+                        if(!AI_find_plant(tile, index, map))
+                            AI_simulate_search(tile, index, now);
                         break;
                     case CARNIVORE:
-                        if(!AI_find_prey(index))
-                            AI_simulate_search(index);
+                        if(!AI_find_prey(tile, index))
+                            AI_simulate_search(tile, index, now);
                         break;
                     case OMNIVORE:
-                        if(!AI_find_plant(index, map) && !AI_find_prey(index))
-                            AI_simulate_search(index);
+                        if(!AI_find_plant(tile, index, map) && !AI_find_prey(tile, index))
+                            AI_simulate_search(tile, index, now);
                         break;
                     }
                 }
-                else if(m_animals[index]->is_ready_to_reproduce()) //if not hungry and able to reproduce, find a partner
-                     if(!AI_find_partner(index))
-                        AI_simulate_search(index);
+                else if(tile.animals[index]->is_ready_to_reproduce(now)) //if not hungry and able to reproduce, find a partner
+                     if(!AI_find_partner(tile, index, now))
+                        AI_simulate_search(tile, index, now);
 
             }
 
-            AI_check_current_location(index, map); //deals with all the interactions of the animals once it has moved
-            AI_check_territory(index); //deals with the agressivty of the animal
-        }
-        else if(m_animals[index]->is_decomposed()) //if the animal is dead for a certain period of time, it disappears of the map
-        {
-            m_animals.erase(m_animals.begin() + index);
-            index -= 1; //necessary not to skip an animal
+            AI_check_current_location(tile, index, map, now); //deals with all the interactions of the animals once it has moved
+            AI_check_territory(tile, index, now); //deals with the agressivty of the animal
         }
     }
 }
 
-void Population::AI_check_current_location(int index, Map &map) //deals with all the interactions of the animals
+static bool contains_block(std::vector <SDL_Point> const& blocks, int x, int y)
+{
+    for(int i = 0; i < blocks.size(); i++)
+        if(blocks[i].x == x && blocks[i].y == y)
+            return true;
+    return false;
+}
+
+void Population::AI_check_current_location(Tile &tile, int index, Map &map, int now) //deals with all the interactions of the animals
 {
-    Vector2d pos = m_animals[index]->get_position();
-    if(m_animals[index]->is_my_plant(map.get_resource(pos.x, pos.y)) && m_animals[index]->is_hungry()) //check if the nearest resource is comestible
+    Vector2d pos = tile.animals[index]->get_position();
+    if(tile.animals[index]->is_my_plant(map.get_resource(pos.x, pos.y)) && tile.animals[index]->is_hungry(now) && !contains_block(tile.plants, pos.x, pos.y)) //check if the nearest resource is comestible
     {
-        m_animals[index]->regenerate(get_nutritional_value(map.get_resource(pos.x, pos.y)));
-        map.remove_resource(pos.x, pos.y);
+        int health = tile.animals[index]->get_health(now);
+        tile.animals[index]->regenerate(get_nutritional_value(map.get_resource(pos.x, pos.y)), now);
+        if(m_logging)
+            tile.events.push_back({EVENT_MEAL, now, tile.animals[index]->get_id(), 0, map.get_resource(pos.x, pos.y), tile.animals[index]->get_health(now) - health, pos, pos, 0});
+        if(tile.deferred) //the map is read by the other tiles until the end of the step
+            tile.plants.push_back({int(pos.x), int(pos.y)});
+        else
+            map.remove_resource(pos.x, pos.y);
     }
     Vector2d other_pos;
 
     std::vector <Animal*> m_neighbors; //list of all neighboors
     for(int i = std::max(0, int(pos.x) - 1); i < std::min(m_mapsize.x, int(pos.x) + 2); i++)
         for(int j = std::max(0, int(pos.y) - 1); j < std::min(m_mapsize.y, int(pos.y) + 2); j++)
-            m_neighbors.insert(m_neighbors.end(), m_animal_map[i][j].begin(), m_animal_map[i][j].end());
+            m_neighbors.insert(m_neighbors.end(), tile.grid.get(i, j).begin(), tile.grid.get(i, j).end());
 
     for(int n = 0; n < m_neighbors.size(); n++) //go through this list
     {
-        if(m_animals[index] != m_neighbors[n]) //not myself 
+        if(tile.animals[index] != m_neighbors[n]) //not myself 
         {
             other_pos = m_neighbors[n]->get_position();
             if(sqrt(pow(pos.x - other_pos.x, 2) + pow(pos.y - other_pos.y, 2)) <= 0.5) //max distance of interaction
             {
-                if(m_animals[index]->is_my_prey(*m_neighbors[n])) //I found a prey
+                int halo = get_halo_index(tile, m_neighbors[n]);
+                if(tile.animals[index]->is_my_prey(*m_neighbors[n])) //I found a prey
                 {
-                    if(m_neighbors[n]->is_alive()) //let's attack it
-                    {
-                        if(m_animals[index]->attack(*m_neighbors[n]))
-                            m_blood->add_stain(other_pos);
-                    }
-                    else if(m_animals[index]->is_hungry()) //let's eat it
+                    if(m_neighbors[n]->is_alive(now)) //let's attack it
+                        AI_attack(tile, *tile.animals[index], *m_neighbors[n], now);
+                    else if(tile.animals[index]->is_hungry(now)) //let's eat it
                     {
-                        m_animals[index]->regenerate(get_nutritional_value(*m_neighbors[n]));
-                        m_animals.erase(std::remove(m_animals.begin(), m_animals.end(), m_neighbors[n]), m_animals.end());
+                        int health = tile.animals[index]->get_health(now);
+                        tile.animals[index]->regenerate(get_nutritional_value(*m_neighbors[n]), now);
+                        if(m_logging)
+                            tile.events.push_back({EVENT_MEAL, now, tile.animals[index]->get_id(), m_neighbors[n]->get_id(), 0, tile.animals[index]->get_health(now) - health, pos, pos, 0});
+                        if(halo >= 0)
+                            tile.effects.push_back({EFFECT_EATEN, halo, 0});
+                        else
+                        {
+                            tile.animals.erase(std::remove(tile.animals.begin(), tile.animals.end(), m_neighbors[n]), tile.animals.end());
+                            if(tile.deferred) //the timers are shared by the tiles
+                                tile.eaten.push_back(m_neighbors[n]);
+                            else
+                                unschedule(m_neighbors[n]);
+                        }
                     }
                 }
-                else if(m_neighbors[n]->is_my_prey(*m_animals[index])) //I'm the prey
+                else if(m_neighbors[n]->is_my_prey(*tile.animals[index])) //I'm the prey
+                    AI_attack(tile, *tile.animals[index], *m_neighbors[n], now); //let's defend myself
+                else if(tile.animals[index]->is_my_type(*m_neighbors[n], now)) //I found a compatible partner
                 {
-                    if(m_animals[index]->attack(*m_neighbors[n])) //let's defend myself
-                        m_blood->add_stain(other_pos);
-                }
-                else if(m_animals[index]->is_my_type(*m_neighbors[n])) //I found a compatible partner
-                {
-                    m_animals[index]->reproduce(); //let's reproduce
-                    m_neighbors[n]->reproduce();
-                    m_animals.push_back(new Animal(m_animals[index]->get_position(), m_animals[index]->get_specie(), m_animals[index]->get_color(), m_animals[index], m_neighbors[n]));
-                }
-                else if(m_animals[index]->is_agressive_with(m_neighbors[n])) //I am agressive with it
-                {
-                    if(m_animals[index]->attack(*m_neighbors[n])) //let's attack it
-                        m_blood->add_stain(other_pos);
+                    tile.animals[index]->reproduce(now); //let's reproduce
+                    m_neighbors[n]->reproduce(now);
+                    if(halo >= 0)
+                        tile.effects.push_back({EFFECT_REPRODUCE, halo, 0});
+
+                    int specie = tile.animals[index]->get_specie();
+                    if(tile.deferred) //the ids are given at the end of the step
+                        tile.births.push_back({tile.animals[index]->get_position(), specie, tile.animals[index]->get_color(), tile.animals[index], m_neighbors[n]});
+                    else
+                    {
+                        tile.animals.push_back(new Animal(m_next_id++, tile.animals[index]->get_position(), specie, m_scenario.species[specie - 1], m_random, now, tile.animals[index]->get_color(), tile.animals[index], m_neighbors[n]));
+                        schedule(tile.animals.back());
+                    }
                 }
+                else if(tile.animals[index]->is_agressive_with(m_neighbors[n], now)) //I am agressive with it
+                    AI_attack(tile, *tile.animals[index], *m_neighbors[n], now); //let's attack it
             }
         }
     }
 }
 
-bool Population::AI_find_plant(int index, Map &map) //set as destination the nearest plant, otherwise, returns false
+void Population::AI_attack(Tile &tile, Animal &attacker, Animal &target, int now) //the target can be a copy of the halo: the damage is also done to the real animal at the end of the step
 {
-    Vector2d pos = m_animals[index]->get_position();
-    Vector2d food_pos;
+    if(!attacker.attack(target, now))
+        return;
+    if(m_logging)
+        tile.events.push_back({EVENT_ATTACK, now, attacker.get_id(), target.get_id(), attacker.get_damage(), 0, target.get_position(), target.get_position(), 0});
+    AI_add_stain(tile, target.get_position());
+
+    int halo = get_halo_index(tile, &target);
+    if(halo >= 0)
+        tile.effects.push_back({EFFECT_DAMAGE, halo, attacker.get_damage()});
+    else if(!target.is_alive(now)) //decomposes sooner than predicted
+    {
+        if(tile.deferred)
+            tile.killed.push_back(&target);
+        else
+            schedule(&target);
+    }
+}
+
+void Population::AI_add_stain(Tile &tile, Vector2d const& pos)
+{
+    if(tile.deferred)
+        tile.stains.push_back(pos);
+    else
+        m_blood->add_stain(pos);
+}
+
+bool Population::AI_find_plant(Tile &tile, int index, Map &map) //set as destination the nearest plant, otherwise, returns false
+{
+    Vector2d pos = tile.animals[index]->get_position();
+    Vector2d food_pos = {0, 0};
     bool found = false;
-    int range = m_animals[index]->get_plant_range_detection();
+    int range = tile.animals[index]->get_plant_range_detection();
 
     double current_distance = 0, shortest_distance = range;
 
+    //the map knows the nearest block of each resource from the center of every block: the nearest from the animal is one of those of the blocks around it
+    std::vector <int> const& plants = m_scenario.species[tile.animals[index]->get_specie() - 1].plants;
+    bool fields = true;
+    for(int i = 0; i < plants.size(); i++)
+        fields = fields && map.get_field_range(plants[i]) > range;
+    if(fields)
+    {
+        SDL_Point nearest;
+        for(int i = 0; i < plants.size(); i++)
+        {
+            for(int x = int(pos.x) - 1; x <= int(pos.x) + 1; x++)
+            {
+                for(int y = int(pos.y) - 1; y <= int(pos.y) + 1; y++)
+                {
+                    if(!map.get_nearest_resource(plants[i], x, y, nearest))
+                        continue;
+                    current_distance = sqrt(pow(nearest.x + 0.5 - pos.x, 2) + pow(nearest.y + 0.5 - pos.y, 2));
+                    bool last = !found || nearest.x + 0.5 > food_pos.x || (nearest.x + 0.5 == food_pos.x && nearest.y + 0.5 > food_pos.y); //the one the scan below would keep
+                    if(current_distance < shortest_distance || (current_distance == shortest_distance && last))
+                    {
+                        shortest_distance = current_distance;
+                        food_pos = {nearest.x + 0.5, nearest.y + 0.5};
+                        found = true;
+                    }
+                }
+            }
+        }
+        if(found)
+            tile.animals[index]->set_destination(AI_midway(pos, food_pos));
+        return found;
+    }
+
     for(int x = std::max(0, int(pos.x - range)); x < std::min(m_mapsize.x, int(pos.x + range) + 1); x++)
     {
         for(int y = std::max(0, int(pos.y - range)); y < std::min(m_mapsize.y, int(pos.y + range) + 1); y++)
         {
-            if(m_animals[index]->is_my_plant(map.get_resource(x, y)))
+            if(tile.animals[index]->is_my_plant(map.get_resource(x, y)))
             {
                 current_distance = sqrt(pow(x + 0.5 - pos.x, 2) + pow(y + 0.5 - pos.y, 2));
                 if(current_distance <= shortest_distance)
@@ -282,32 +769,35 @@ bool Population::AI_find_plant(int index, Map &map) //set as destination the nea
 
     if(found)
     {
-        m_animals[index]->set_destination(AI_midway(pos, food_pos));
+        tile.animals[index]->set_destination(AI_midway(pos, food_pos));
         return true;
     }
     return false;
 }
 
-bool Population::AI_find_prey(int index) //set as destination the nearest prey, otherwise, returns false
+bool Population::AI_find_prey(Tile &tile, int index) //set as destination the nearest prey, otherwise, returns false
 {
-    Vector2d pos = m_animals[index]->get_position();
-    Vector2d prey_pos;
+    Vector2d pos = tile.animals[index]->get_position();
+    Vector2d prey_pos = {0, 0};
     bool found = false;
-    double range = m_animals[index]->get_prey_range_detection();
+    double range = tile.animals[index]->get_prey_range_detection();
+    bool scent = m_scent->is_enabled() && range > m_scenario.scent.contact_range;
+    if(scent) //beyond the contact range, the preys are found by their scent
+        range = m_scenario.scent.contact_range;
 
     double current_distance = 0, shortest_distance = range; //makes sure he stays in his range
 
     std::vector <Animal*> m_neighbors;
         for(int i = std::max(0, int(pos.x - range)); i < std::min(m_mapsize.x, int(pos.x + range) + 1); i++)
             for(int j = std::max(0, int(pos.y - range)); j < std::min(m_mapsize.y, int(pos.y + range) + 1); j++)
-                m_neighbors.insert(m_neighbors.end(), m_animal_map[i][j].begin(), m_animal_map[i][j].end());
+                m_neighbors.insert(m_neighbors.end(), tile.grid.get(i, j).begin(), tile.grid.get(i, j).end());
 
     Vector2d other_pos;
     for(int n = 0; n < m_neighbors.size(); n++)
     {
-        if(m_animals[index] != m_neighbors[n])
+        if(tile.animals[index] != m_neighbors[n])
         {
-            if(m_animals[index]->is_my_prey(*m_neighbors[n]))
+            if(tile.animals[index]->is_my_prey(*m_neighbors[n]))
             {
                 other_pos = m_neighbors[n]->get_position();
                 current_distance = sqrt(pow(pos.x - other_pos.x, 2) + pow(pos.y - other_pos.y, 2));
@@ -323,32 +813,66 @@ bool Population::AI_find_prey(int index) //set as destination the nearest prey,
 
     if(found)
     {
-        m_animals[index]->set_destination(AI_midway(pos, prey_pos));
+        tile.animals[index]->set_destination(AI_midway(pos, prey_pos));
         return true;
     }
-    return false;
+    return scent && AI_follow_scent(tile, index);
 }
 
-bool Population::AI_find_partner(int index) //set as destination the nearest partner, otherwise, returns false
+bool Population::AI_follow_scent(Tile &tile, int index) //set as destination the center of the cell around where the preys smell the most, returns false if it is its own cell or there is no scent
 {
-    Vector2d pos = m_animals[index]->get_position();
-    Vector2d partner_pos;
+    Vector2d pos = tile.animals[index]->get_position();
+    std::vector <int> const& preys = m_scenario.species[tile.animals[index]->get_specie() - 1].preys;
+    int cell = m_scent->get_cell();
+    int column = int(pos.x) / cell, row = int(pos.y) / cell;
+
+    int best_column = column, best_row = row;
+    double strongest = 0;
+    for(int i = column - 1; i <= column + 1; i++)
+    {
+        for(int j = row - 1; j <= row + 1; j++)
+        {
+            double scent = 0;
+            for(int n = 0; n < preys.size(); n++)
+                scent += m_scent->get(preys[n], i, j);
+            if(scent > strongest)
+            {
+                strongest = scent;
+                best_column = i;
+                best_row = j;
+            }
+        }
+    }
+    if(strongest == 0 || (best_column == column && best_row == row))
+        return false;
+
+    Vector2d dest = {(best_column + 0.5) * cell, (best_row + 0.5) * cell};
+    dest.x = std::max(0.5, std::min(m_mapsize.x - 0.5, dest.x)); //the last cells can be cut by the borders of the map
+    dest.y = std::max(0.5, std::min(m_mapsize.y - 0.5, dest.y));
+    tile.animals[index]->set_destination(dest);
+    return true;
+}
+
+bool Population::AI_find_partner(Tile &tile, int index, int now) //set as destination the nearest partner, otherwise, returns false
+{
+    Vector2d pos = tile.animals[index]->get_position();
+    Vector2d partner_pos = {0, 0};
     bool found = false;
-    int range = m_animals[index]->get_partner_range_dection();
+    int range = tile.animals[index]->get_partner_range_dection();
 
     double current_distance = 0, shortest_distance = range; //makes sure he stays in his range
 
     std::vector <Animal*> m_neighbors;
         for(int i = std::max(0, int(pos.x - range)); i < std::min(m_mapsize.x, int(pos.x + range) + 1); i++)
             for(int j = std::max(0, int(pos.y - range)); j < std::min(m_mapsize.y, int(pos.y + range) + 1); j++)
-                m_neighbors.insert(m_neighbors.end(), m_animal_map[i][j].begin(), m_animal_map[i][j].end());
+                m_neighbors.insert(m_neighbors.end(), tile.grid.get(i, j).begin(), tile.grid.get(i, j).end());
 
     Vector2d other_pos;
     for(int n = 0; n < m_neighbors.size(); n++)
     {
-        if(m_animals[index] != m_neighbors[n])
+        if(tile.animals[index] != m_neighbors[n])
         {
-            if(m_animals[index]->is_my_type(*m_neighbors[n]))
+            if(tile.animals[index]->is_my_type(*m_neighbors[n], now))
             {
                 other_pos = m_neighbors[n]->get_position();
                 current_distance = sqrt(pow(pos.x - other_pos.x, 2) + pow(pos.y - other_pos.y, 2));
@@ -364,19 +888,19 @@ bool Population::AI_find_partner(int index) //set as destination the nearest par
 
     if(found)
     {
-        m_animals[index]->set_destination(AI_midway(pos, partner_pos));
+        tile.animals[index]->set_destination(AI_midway(pos, partner_pos));
         return true;
     }
     return false;
 }
 
-void Population::AI_simulate_search(int index) //set a random location at the borders of its range to simulate the search
+void Population::AI_simulate_search(Tile &tile, int index, int now) //set a random location at the borders of its range to simulate the search
 {
-    Vector2d pos = m_animals[index]->get_position();
+    Vector2d pos = tile.animals[index]->get_position();
     Vector2d dest;
-    int range = m_animals[index]->get_search_distance();
+    int range = tile.animals[index]->get_search_distance();
 
-    double angle = (rand() % 628)/100.0;
+    double angle = random_int(m_random, 628, RANDOM_SEARCH, tile.animals[index]->get_id(), now)/100.0;
 
     dest.x = pos.x + range * cos(angle);
     if(dest.x < 0.5)
@@ -390,7 +914,7 @@ void Population::AI_simulate_search(int index) //set a random location at the bo
     else if(dest.y >= m_mapsize.y - 0.5)
         dest.y = m_mapsize.y - 0.5;
 
-    m_animals[index]->set_destination(dest);
+    tile.animals[index]->set_destination(dest);
 }
 
 Vector2d Population::AI_midway(Vector2d const& pos, Vector2d const& dest) //returns the position between those two
@@ -401,28 +925,28 @@ Vector2d Population::AI_midway(Vector2d const& pos, Vector2d const& dest) //retu
     return midway;
 }
 
-void Population::AI_check_territory(int index) //looks if there is an ennemy on his territory (and set him as a destination if there is one)
+void Population::AI_check_territory(Tile &tile, int index, int now) //looks if there is an ennemy on his territory (and set him as a destination if there is one)
 {
-    if(m_animals[index]->is_agressive())
+    if(tile.animals[index]->is_agressive(now))
     {
-        Vector2d pos = m_animals[index]->get_position();
-        Vector2d ennemy_pos;
+        Vector2d pos = tile.animals[index]->get_position();
+        Vector2d ennemy_pos = {0, 0};
         bool found = false;
-        int range = m_animals[index]->get_agressivity_range();
+        int range = tile.animals[index]->get_agressivity_range();
 
         double current_distance = 0, shortest_distance = range;
 
         std::vector <Animal*> m_neighbors;
             for(int i = std::max(0, int(pos.x - range)); i < std::min(m_mapsize.x, int(pos.x + range) + 1); i++)
                 for(int j = std::max(0, int(pos.y - range)); j < std::min(m_mapsize.y, int(pos.y + range) + 1); j++)
-                    m_neighbors.insert(m_neighbors.end(), m_animal_map[i][j].begin(), m_animal_map[i][j].end());
+                    m_neighbors.insert(m_neighbors.end(), tile.grid.get(i, j).begin(), tile.grid.get(i, j).end());
 
         Vector2d other_pos;
         for(int n = 0; n < m_neighbors.size(); n++)
         {
-            if(m_animals[index] != m_neighbors[n])
+            if(tile.animals[index] != m_neighbors[n])
             {
-                if(m_animals[index]->is_agressive_with(m_neighbors[n]))
+                if(tile.animals[index]->is_agressive_with(m_neighbors[n], now))
                 {
                     other_pos = m_neighbors[n]->get_position();
                     current_distance = sqrt(pow(pos.x - other_pos.x, 2) + pow(pos.y - other_pos.y, 2));
@@ -437,7 +961,7 @@ void Population::AI_check_territory(int index) //looks if there is an ennemy on
         }
 
         if(found)
-            m_animals[index]->set_destination(AI_midway(pos, ennemy_pos));
+            tile.animals[index]->set_destination(AI_midway(pos, ennemy_pos));
     }
 }
 
@@ -445,11 +969,48 @@ int Population::get_number(int specie) const
 {
     int number = 0;
     for(int i = 0; i < m_animals.size(); i++)
-        if(m_animals[i]->is_alive() && m_animals[i]->get_specie() == specie)
+        if(m_animals[i]->is_alive(m_time) && m_animals[i]->get_specie() == specie)
             number += 1;
     return number;
 }
 
+int Population::get_number() const
+{
+    return m_animals.size();
+}
+
+std::vector <Animal*> const& Population::get_animals() const
+{
+    return m_animals;
+}
+
+void Population::get_distributions(int now, std::vector <SpecieDistribution> &distributions) const //each thread sums a part of the animals, the parts are merged at the end
+{
+    PROFILE_ZONE("Population::get_distributions");
+    int parts = m_pool ? m_pool->get_threads_number() : 1;
+    std::vector < std::vector <SpecieDistribution> > partials(parts, std::vector <SpecieDistribution>(m_scenario.species.size()));
+    std::function<void(int)> sum = [this, now, parts, &partials](int part)
+    {
+        std::vector <SpecieDistribution> &partial = partials[part];
+        size_t end = m_animals.size() * (part + 1) / parts;
+        for(size_t i = m_animals.size() * part / parts; i < end; i++)
+        {
+            Animal const& animal = *m_animals[i];
+            if(animal.is_alive(now))
+                partial[animal.get_specie() - 1].add(animal.get_state(now), m_scenario.species[animal.get_specie() - 1]);
+        }
+    };
+    if(m_pool)
+        m_pool->run(parts, sum);
+    else
+        sum(0);
+
+    distributions.swap(partials[0]);
+    for(int part = 1; part < parts; part++)
+        for(int specie = 0; specie < distributions.size(); specie++)
+            distributions[specie].merge(partials[part][specie]);
+}
+
 void Population::show_hide_bubble()
 {
     m_show_bubble = !m_show_bubble;
@@ -466,30 +1027,79 @@ bool Population::is_inside(Animal *target) const //make sure if the animal targe
 Animal* Population::get_animal(int specie) const //returnes a pointer to the latest animal of the specified specie found or NULL
 {
     for(int i = m_animals.size() - 1; i >= 0; i--)
-        if(m_animals[i]->get_specie() == specie && m_animals[i]->is_alive())
-            return m_animals[i];
-    return NULL;
-}
-
-Animal* Population::get_animal(Vector2d const& pos) const //returnes a pointer to the first animal located at this position or NULL
-{
-    for(int i = 0; i < m_animals.size(); i++)
-        if(sqrt(pow(m_animals[i]->get_position().x - pos.x, 2) + pow(m_animals[i]->get_position().y - pos.y, 2)) <= 0.5)
+        if(m_animals[i]->get_specie() == specie && m_animals[i]->is_alive(m_time))
             return m_animals[i];
     return NULL;
 }
 
 int Population::get_nutritional_value(Animal const& target) const
 {
-    return m_nutritional_value[target.get_specie() - 1];
+    return m_scenario.nutritional_value[target.get_specie() - 1];
 }
 
 int Population::get_nutritional_value(int plant) const
 {
-    return m_nutritional_value[m_texture.size() + plant - 1];
+    return m_scenario.nutritional_value[m_scenario.get_species_number() + plant - 1];
 }
 
 void Population::show_hide_blood()
 {
     m_show_blood = !m_show_blood;
 }
+
+void Population::save_state(CheckpointWriter &cp, int now) const
+{
+    std::vector <AnimalState> states(m_animals.size());
+    for(int i = 0; i < m_animals.size(); i++)
+        states[i] = m_animals[i]->get_state(now);
+
+    cp.add_value(int32_t(m_mapsize.x));
+    cp.add_value(int32_t(m_mapsize.y));
+    cp.add_value(int32_t(m_next_id));
+    cp.add_value(int32_t(states.size()));
+    cp.add_value(int32_t(sizeof(AnimalState)));
+    cp.add_copy(states.data(), states.size() * sizeof(AnimalState));
+
+    m_blood->save_state(cp);
+    m_scent->save_state(cp);
+}
+
+bool Population::load_state(CheckpointReader &cp, int now)
+{
+    int32_t width = 0, height = 0, next_id = 0, number = 0, record_size = 0;
+    if(!cp.read_value(width) || !cp.read_value(height) || !cp.read_value(next_id) || !cp.read_value(number) || !cp.read_value(record_size))
+        return false;
+    if(width <= 0 || height <= 0 || number < 0 || record_size != sizeof(AnimalState))
+        return false;
+
+    unsigned char const* records = static_cast<unsigned char const*>(cp.view(size_t(number) * record_size));
+    if(!records)
+        return false;
+
+    for(int i = 0; i < m_animals.size(); i++)
+        delete m_animals[i];
+    m_animals.clear();
+
+    m_mapsize = {width, height};
+    m_time = now;
+    m_timers.reset(now);
+    m_scent->reset(width, height, now);
+
+    AnimalState state;
+    for(int i = 0; i < number; i++)
+    {
+        memcpy(&state, records + size_t(i) * record_size, sizeof(AnimalState)); //the mapping gives no alignment guarantee
+        if(state.specie < 1 || state.specie > m_scenario.get_species_number())
+        {
+            distribute(); //the tiles must not keep the deleted animals
+            return false;
+        }
+        m_animals.push_back(new Animal(state.id, state.pos, state.specie, m_scenario.species[state.specie - 1], m_random, now, state.color));
+        m_animals.back()->set_state(state, now);
+        schedule(m_animals.back());
+    }
+    m_next_id = next_id;
+    distribute();
+
+    return m_blood->load_state(cp, now) && m_scent->load_state(cp, now);
+}
@@ -7,58 +7,171 @@
 #include "Map.hpp"
 #include "Bubble.hpp"
 #include "Blood.hpp"
+#include "Scent.hpp"
+#include "Snapshot.hpp"
+#include "Checkpoint.hpp"
+#include "Scenario.hpp"
+#include "Random.hpp"
+#include "ChunkGrid.hpp"
+#include "WorkerPool.hpp"
+#include "TimerWheel.hpp"
+#include "EventLog.hpp"
+#include "Distribution.hpp"
+
+enum TileEffectType
+{
+    EFFECT_DAMAGE, EFFECT_REPRODUCE, EFFECT_EATEN
+};
+
+struct TileEffect //done by an animal of the tile to an animal of another tile
+{
+    int type;
+    int halo; //index of the copy of the target in the halo
+    int value;
+};
+
+struct TileBirth
+{
+    Vector2d pos;
+    int specie, color;
+    Animal *father, *mother;
+};
+
+//vertical strip of the map whose animals are simulated by one thread
+//the animals of the other tiles near its borders (the halo) are copied at the start of the step: the tile only reads those copies,
+//and what it does to them (attacks, reproduction, eating) is applied to the real animals once all the tiles have finished the step
+struct Tile
+{
+    explicit Tile(bool deferred): begin(0), end(0), deferred(deferred)
+    {}
+
+    int begin, end; //columns of the tile
+    std::vector <Animal*> animals; //animals owned by the tile
+    std::vector <Animal> halo;
+    std::vector <Animal*> halo_sources; //real animal of each copy
+
+    ChunkGrid < std::vector <Animal*> > grid; //own animals and copies of the halo of each block, only the chunks containing animals are allocated
+    std::vector <SDL_Point> occupied; //blocks of the grid containing animals (the only ones to clear)
+    std::vector <SDL_Point> emptied;
+
+    bool deferred; //false for a single tile covering the whole map: everything is done immediately
+    std::vector <TileEffect> effects;
+    std::vector <TileBirth> births;
+    std::vector <Vector2d> stains;
+    std::vector <SDL_Point> plants; //blocks whose plant has been eaten
+    std::vector <Animal*> killed; //own animals killed during the step, their decomposition is rescheduled at the end of it
+    std::vector <Animal*> eaten; //own animals eaten during the step, their timers are removed at the end of it
+    std::vector <LogEvent> events; //attacks and meals of the step, only for the event log
+};
 
 class Population
 {
 public:
-    Population(SDL_Renderer *renderer);
+    Population(Scenario const& scenario, Random const& random, SDL_Renderer *renderer = NULL); //without renderer (simulation without window), no texture is loaded
     ~Population();
 
     void generate();
+    void set_threads(int threads); //the map is cut in as many tiles, 1 keeps the whole simulation in the calling thread
 
     bool get_error() const;
     int get_number(int specie) const;
+    int get_number() const; //all the animals, alive or dead
+    std::vector <Animal*> const& get_animals() const; //alive or dead, in no particular order
+    void get_distributions(int now, std::vector <SpecieDistribution> &distributions) const; //of the animals alive of each specie, in a single pass shared by the threads
     Animal* get_animal(int specie) const;
-    Animal* get_animal(Vector2d const& pos) const;
 
     bool is_inside(Animal *target) const;
 
     void show_hide_bubble();
     void show_hide_blood();
 
-    void render(SDL_Renderer *renderer, SDL_Point const& winsize, class Camera const& camera);
-    void update(class Map &map);
+    void render(SDL_Renderer *renderer, SDL_Point const& winsize, class Camera const& camera, Snapshot const& snapshot, Snapshot const& previous, double progress); //positions between the previous snapshot (0) and this one (1)
+    void update(class Map &map, int now);
+    void snapshot(SDL_Rect const& area, Snapshot &snapshot) const; //the animals and stains of the area, and the number of animals
 
-private:
-    void AI_main(class Map &map);
-    void AI_check_current_location(int index, class Map &map);
-    void AI_check_territory(int index);
+    void save_state(CheckpointWriter &cp, int now) const;
+    bool load_state(CheckpointReader &cp, int now);
 
-    bool AI_find_plant(int index, class Map &map);
-    bool AI_find_prey(int index);
-    bool AI_find_partner(int index);
+    static void cut(std::vector <int> const& columns, int parts, std::vector <int> &ends); //ends of parts holding the same number of animals
+    static int get_halo_width(Scenario const& scenario, int dt);
+
+private:
+    friend class Benchmark; //times the stages of the update separately
+    friend class ClusterWorker; //simulates one strip of the map in a process of a cluster
+    friend class EventRecorder; //reads the animals after each step
+    friend class TrajectoryWriter; //reads the positions of the animals of the recorded species after each step
+    friend class DensityMap; //counts the animals on the threads of the population
+    friend class PlantSearchCheck; //compares the search of the plants with a scan of the blocks, in simuworld_tests
+
+    void distribute();
+    void split();
+    void recut();
+    void exchange_halo(Tile &tile, int width);
+    void merge(class Map &map, int now);
+    int get_tile(double x) const;
+    int get_halo_index(Tile const& tile, Animal const* animal) const;
+    void remove_animals(std::vector <Animal*> &removed);
+
+    static void update_grid(Tile &tile);
+    void update_view() const;
+
+    void schedule(Animal *animal);
+    void unschedule(Animal *animal);
+    void update_timers(int now);
+    void update_scent(int now);
+
+    void AI_main(Tile &tile, class Map &map, int now);
+    void AI_check_current_location(Tile &tile, int index, class Map &map, int now);
+    void AI_check_territory(Tile &tile, int index, int now);
+
+    bool AI_find_plant(Tile &tile, int index, class Map &map);
+    bool AI_find_prey(Tile &tile, int index);
+    bool AI_follow_scent(Tile &tile, int index);
+    bool AI_find_partner(Tile &tile, int index, int now);
 
     Vector2d AI_midway(Vector2d const& pos, Vector2d const& dest);
-    void AI_simulate_search(int index);
+    void AI_simulate_search(Tile &tile, int index, int now);
+    void AI_attack(Tile &tile, Animal &attacker, Animal &target, int now);
+    void AI_add_stain(Tile &tile, Vector2d const& pos);
 
     int get_nutritional_value(Animal const& target) const;
     int get_nutritional_value(int plant) const;
 
 
-    std::vector <Animal*> m_animals;
+    Scenario const& m_scenario;
+    Random const& m_random;
 
-    std::vector < std::vector <std::vector <Animal*> > > m_animal_map;
+    std::vector <Animal*> m_animals; //all the animals, in the order of the tiles
+    int m_next_id;
     SDL_Point m_mapsize;
+    int m_time; //time of the last update
+    TimerWheel <Animal*> m_timers; //predicted decomposition of each animal, the vital stats are computed when needed
+    std::vector <Animal*> m_decomposed;
 
-    std::vector <SDL_Texture*> m_texture;
+    std::vector <Tile*> m_tiles;
+    WorkerPool *m_pool; //NULL with a single tile
+    bool m_recut; //the tiles have to be recut before the next step
+    std::vector <int> m_columns; //animals of each column, to recut the tiles
+    std::vector <int> m_ends;
+    std::vector <Animal*> m_migrants;
+    std::vector <Animal*> m_eaten; //by another tile
 
-    std::vector <int> m_nutritional_value;
+    mutable Tile m_view; //all the animals by block for the snapshots of the display, rebuilt when they are needed after an update
+    mutable bool m_view_outdated;
+
+    std::vector <SDL_Texture*> m_texture;
+    bool m_textured;
 
     class Bubble *m_bubble;
     bool m_show_bubble;
 
     class Blood *m_blood;
     bool m_show_blood;
+
+    class Scent *m_scent; //always there, empty without settings/scent.txt
+
+    bool m_logging; //the tiles keep their attacks and meals for the event log
+    std::vector <LogEvent> m_logged; //in the order of the tiles
 };
 
 #endif
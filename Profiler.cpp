@@ -0,0 +1,210 @@
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include "Profiler.hpp"
+
+//event of the ring: its thread writes it while the others can read it, the sequence tells whether a read was complete
+//(odd while the event is written, 2*index+2 once the event of this index is written)
+struct ProfileSlot
+{
+    std::atomic <uint64_t> sequence;
+    std::atomic <char const*> name;
+    std::atomic <int64_t> start;
+    std::atomic <int64_t> duration;
+};
+
+//zones of one thread: a ring of the last events, written only by its thread
+struct ProfileBuffer
+{
+    static const uint64_t CAPACITY = 1 << 17;
+
+    ProfileSlot slots[CAPACITY];
+    std::atomic <uint64_t> count; //number of events ever written (the index of the next one is count % CAPACITY)
+    int thread_id;
+    char thread_name[32]; //under g_buffers_mutex
+};
+
+//a buffer lives as long as its thread: the trace only has the threads alive when it is written
+static std::mutex g_buffers_mutex; //taken when a thread records its first zone or ends, and by the readers of the buffers
+static std::vector <ProfileBuffer*> g_buffers;
+static int g_last_thread_id = 0; //under g_buffers_mutex, the ids are never reused
+static std::chrono::steady_clock::time_point const g_start = std::chrono::steady_clock::now();
+
+struct ProfileBufferOwner //frees the buffer of its thread when the thread ends
+{
+    ProfileBuffer *buffer;
+
+    ~ProfileBufferOwner()
+    {
+        if(!buffer)
+            return;
+        std::lock_guard <std::mutex> lock(g_buffers_mutex);
+        g_buffers.erase(std::find(g_buffers.begin(), g_buffers.end(), buffer));
+        delete buffer;
+    }
+};
+
+static ProfileBuffer* get_buffer() //the buffer of the current thread
+{
+    static thread_local ProfileBufferOwner owner = {NULL};
+    if(!owner.buffer)
+    {
+        ProfileBuffer *buffer = new ProfileBuffer(); //zeroed: no slot is written yet
+
+        std::lock_guard <std::mutex> lock(g_buffers_mutex);
+        g_last_thread_id += 1;
+        buffer->thread_id = g_last_thread_id;
+        g_buffers.push_back(buffer);
+        owner.buffer = buffer;
+    }
+    return owner.buffer;
+}
+
+static ProfileBuffer const* find_buffer(int thread_id) //under g_buffers_mutex
+{
+    for(int b = 0; b < g_buffers.size(); b++)
+        if(g_buffers[b]->thread_id == thread_id)
+            return g_buffers[b];
+    return NULL;
+}
+
+static bool read_event(ProfileBuffer const& buffer, uint64_t index, ProfileEvent &event) //false if the event has been overwritten
+{
+    ProfileSlot const& slot = buffer.slots[index % ProfileBuffer::CAPACITY];
+    uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if(sequence != 2 * index + 2)
+        return false;
+    event.name = slot.name.load(std::memory_order_relaxed);
+    event.start = slot.start.load(std::memory_order_relaxed);
+    event.duration = slot.duration.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+static void copy_events(ProfileBuffer const& buffer, uint64_t &cursor, std::vector <ProfileEvent> &events) //appends the events since the cursor
+{
+    uint64_t end = buffer.count.load(std::memory_order_acquire);
+    if(end - cursor > ProfileBuffer::CAPACITY)
+        cursor = end - ProfileBuffer::CAPACITY;
+
+    ProfileEvent event;
+    for(; cursor < end; cursor++)
+        if(read_event(buffer, cursor, event))
+            events.push_back(event);
+}
+
+int64_t Profiler::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_start).count();
+}
+
+void Profiler::record(char const* name, int64_t start, int64_t duration)
+{
+    ProfileBuffer *buffer = get_buffer();
+    uint64_t count = buffer->count.load(std::memory_order_relaxed);
+    ProfileSlot &slot = buffer->slots[count % ProfileBuffer::CAPACITY];
+    slot.sequence.store(2 * count + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release); //a reader which sees the new fields sees the odd sequence too
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(duration, std::memory_order_relaxed);
+    slot.sequence.store(2 * count + 2, std::memory_order_release);
+    buffer->count.store(count + 1, std::memory_order_release);
+}
+
+void Profiler::set_thread_name(std::string const& name)
+{
+    ProfileBuffer *buffer = get_buffer();
+    std::lock_guard <std::mutex> lock(g_buffers_mutex);
+    strncpy(buffer->thread_name, name.c_str(), sizeof(buffer->thread_name) - 1);
+    buffer->thread_name[sizeof(buffer->thread_name) - 1] = 0;
+}
+
+void Profiler::get_threads(std::vector <int> &thread_ids)
+{
+    std::lock_guard <std::mutex> lock(g_buffers_mutex);
+    thread_ids.clear();
+    for(int b = 0; b < g_buffers.size(); b++)
+        thread_ids.push_back(g_buffers[b]->thread_id);
+}
+
+void Profiler::get_events(int thread_id, uint64_t &cursor, std::vector <ProfileEvent> &events)
+{
+    events.clear();
+    std::lock_guard <std::mutex> lock(g_buffers_mutex);
+    ProfileBuffer const* buffer = find_buffer(thread_id);
+    if(buffer)
+        copy_events(*buffer, cursor, events);
+}
+
+struct ProfileThreadTrace //copy of a buffer for the trace
+{
+    int id;
+    std::string name;
+    std::vector <ProfileEvent> events;
+};
+
+static void write_string(std::ofstream &file, char const* text) //JSON string
+{
+    file << '"';
+    for(; *text; text++)
+    {
+        if(*text == '"' || *text == '\\')
+            file << '\\';
+        file << *text;
+    }
+    file << '"';
+}
+
+bool Profiler::write_trace(std::string const& file_name)
+{
+    std::ofstream file(file_name);
+    if(!file)
+        return false;
+    file << std::fixed;
+    file.precision(3); //the times are written in us
+
+    //copy of the rings under the lock, their threads may still write: the events overwritten during the copy are dropped
+    //(the buffers cannot be freed meanwhile), the file is written once the threads can end again
+    std::vector <ProfileThreadTrace> threads;
+    {
+        std::lock_guard <std::mutex> lock(g_buffers_mutex);
+        threads.resize(g_buffers.size());
+        for(int b = 0; b < g_buffers.size(); b++)
+        {
+            threads[b].id = g_buffers[b]->thread_id;
+            threads[b].name = g_buffers[b]->thread_name;
+            uint64_t cursor = 0;
+            copy_events(*g_buffers[b], cursor, threads[b].events);
+        }
+    }
+
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    bool first = true;
+    for(int t = 0; t < threads.size(); t++)
+    {
+        ProfileThreadTrace const& thread = threads[t];
+        std::vector <ProfileEvent> const& events = thread.events;
+        if(!thread.name.empty())
+        {
+            file << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread.id << ", \"args\": {\"name\": ";
+            write_string(file, thread.name.c_str());
+            file << "}}";
+            first = false;
+        }
+        for(int i = 0; i < events.size(); i++)
+        {
+            file << (first ? "" : ",\n") << "{\"name\": ";
+            write_string(file, events[i].name);
+            file << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << thread.id
+                 << ", \"ts\": " << events[i].start / 1000.0 << ", \"dur\": " << events[i].duration / 1000.0 << "}";
+            first = false;
+        }
+    }
+    file << "\n]}" << std::endl;
+    return bool(file);
+}
@@ -0,0 +1,115 @@
+#ifndef DEF_PROFILER
+#define DEF_PROFILER
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+//instrumentation of the stages of the simulation: PROFILE_ZONE("name") times the rest of the block
+//each thread writes its zones in its own buffer without lock, Profiler::write_trace dumps them in the Chrome trace format
+//(chrome://tracing or ui.perfetto.dev), without SIMUWORLD_PROFILER the zones are removed at compile time
+#ifdef SIMUWORLD_PROFILER
+    #define PROFILE_CONCAT_(a, b) a##b
+    #define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+    #define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+    #define PROFILE_SAMPLER(sampler, name, stride) ProfileSampler sampler(name, stride)
+    #define PROFILE_SAMPLE(sampler, index) ProfileSample PROFILE_CONCAT(profile_sample_, __LINE__)(sampler, index)
+#else
+    #define PROFILE_ZONE(name)
+    #define PROFILE_SAMPLER(sampler, name, stride)
+    #define PROFILE_SAMPLE(sampler, index)
+#endif
+
+struct ProfileEvent
+{
+    char const* name; //string literal, never copied
+    int64_t start; //ns since the start of the program
+    int64_t duration; //ns
+};
+
+class Profiler
+{
+public:
+    static int64_t now(); //ns
+    static void record(char const* name, int64_t start, int64_t duration);
+    static void set_thread_name(std::string const& name); //name of the current thread in the trace
+
+    static bool write_trace(std::string const& file_name); //the last events of every thread
+    static void get_threads(std::vector <int> &thread_ids); //threads which have recorded zones
+    static void get_events(int thread_id, uint64_t &cursor, std::vector <ProfileEvent> &events); //events of a thread since the cursor, which is moved after them (without those overwritten meanwhile)
+};
+
+class ProfileZone
+{
+public:
+    explicit ProfileZone(char const* name): m_name(name), m_start(Profiler::now())
+    {}
+
+    ~ProfileZone()
+    {
+        Profiler::record(m_name, m_start, Profiler::now() - m_start);
+    }
+
+private:
+    ProfileZone(ProfileZone const&);
+    ProfileZone& operator=(ProfileZone const&);
+
+    char const* m_name;
+    int64_t m_start;
+};
+
+//zone for an operation repeated many times in a loop (for example the move of every animal): timing every call would cost
+//more than the call itself, so only one call out of "stride" is timed, the zone recorded at the end is the estimated total
+class ProfileSampler
+{
+public:
+    ProfileSampler(char const* name, int stride): m_name(name), m_stride(stride), m_start(Profiler::now()), m_sampled(0)
+    {}
+
+    ~ProfileSampler()
+    {
+        Profiler::record(m_name, m_start, m_sampled * m_stride);
+    }
+
+    bool is_sampled(int index) const
+    {
+        return index % m_stride == 0;
+    }
+
+    void add(int64_t duration)
+    {
+        m_sampled += duration;
+    }
+
+private:
+    ProfileSampler(ProfileSampler const&);
+    ProfileSampler& operator=(ProfileSampler const&);
+
+    char const* m_name;
+    int m_stride;
+    int64_t m_start;
+    int64_t m_sampled; //total time of the timed calls
+};
+
+class ProfileSample
+{
+public:
+    ProfileSample(ProfileSampler &sampler, int index): m_sampler(sampler), m_start(sampler.is_sampled(index) ? Profiler::now() : -1)
+    {}
+
+    ~ProfileSample()
+    {
+        if(m_start >= 0)
+            m_sampler.add(Profiler::now() - m_start);
+    }
+
+private:
+    ProfileSample(ProfileSample const&);
+    ProfileSample& operator=(ProfileSample const&);
+
+    ProfileSampler &m_sampler;
+    int64_t m_start;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef DEF_RANDOM
+#define DEF_RANDOM
+
+#include <cstdint>
+
+//what a random number is drawn for, so that two draws of the same entity at the same time never give the same number
+enum RandomPurpose
+{
+    RANDOM_SEX,
+    RANDOM_DIRECTION,
+    RANDOM_COLOR,
+    RANDOM_POSITION,
+    RANDOM_SEARCH,
+    RANDOM_RESOURCE
+};
+
+//counter-based generator: a number is a hash (SplitMix64) of the seed, the purpose, the entity, the tick and the index of the draw
+//there is no state, so any thread draws the same numbers for the same entity and step whatever the order of the updates
+class Random
+{
+public:
+    explicit Random(uint64_t seed = 0): m_seed(seed)
+    {}
+
+    uint64_t get_seed() const
+    {
+        return m_seed;
+    }
+
+    uint64_t draw(int purpose, int64_t entity, int64_t tick, int index = 0) const
+    {
+        uint64_t h = mix(m_seed ^ (uint64_t(purpose) << 32));
+        h = mix(h ^ uint64_t(entity));
+        h = mix(h ^ uint64_t(tick));
+        return mix(h ^ uint64_t(index));
+    }
+
+private:
+    static uint64_t mix(uint64_t z) //one step of SplitMix64
+    {
+        z += 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t m_seed;
+};
+
+inline int random_int(Random const& random, int maximum, int purpose, int64_t entity, int64_t tick, int index = 0) //between 0 and maximum - 1, replaces rand() % maximum
+{
+    return int(((random.draw(purpose, entity, tick, index) >> 32) * uint64_t(maximum)) >> 32);
+}
+
+#endif
@@ -0,0 +1,336 @@
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "Replay.hpp"
+#include "Checkpoint.hpp"
+#include "Stats.hpp"
+#include "Profiler.hpp"
+
+static const int REPLAY_JUMP = 10000; //simulated ms beyond which advance() starts again from a keyframe when there is one
+
+Replay::Replay(Scenario const& scenario): m_scenario(scenario), m_random(0)
+{
+    m_map = new Map(m_scenario, m_random);
+    m_map->m_fields_needed = false;
+    m_blood = new Blood(NULL, m_scenario.blood_disappearance_time);
+    m_error = false;
+    m_time = 0;
+    m_next = 0;
+    m_event = 0;
+}
+
+Replay::~Replay()
+{
+    delete m_map;
+    delete m_blood;
+}
+
+bool Replay::open(std::string const& file_name)
+{
+    m_file.open(file_name.c_str(), std::ios::binary);
+    if(!m_file)
+        return false;
+
+    char magic[8];
+    int32_t version = 0, width = 0, height = 0, species = 0;
+    m_file.read(magic, sizeof(magic));
+    m_file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    m_file.read(reinterpret_cast<char*>(&width), sizeof(width));
+    m_file.read(reinterpret_cast<char*>(&height), sizeof(height));
+    m_file.read(reinterpret_cast<char*>(&species), sizeof(species));
+    if(!m_file || memcmp(magic, "SWEVLOG", 8) || version != EVENT_LOG_VERSION || species != m_scenario.species.size()) //the textures are those of the species of the settings
+        return false;
+    m_speeds.resize(species);
+    m_file.read(reinterpret_cast<char*>(m_speeds.data()), species * sizeof(double));
+
+    //only the headers are read, except the stats which are small: a block cut by the end of a simulation is ignored
+    int columns = Stats::get_columns_number(m_scenario);
+    BlockIndex block;
+    while(m_file.read(reinterpret_cast<char*>(&block.header), sizeof(LogBlockHeader)))
+    {
+        block.offset = m_file.tellg();
+        m_file.seekg(block.header.stored_size, std::ios::cur);
+        if(!m_file || m_file.tellg() - block.offset != std::streamoff(block.header.stored_size))
+            break;
+        m_blocks.push_back(block);
+        if(block.header.kind == LOG_KEYFRAME)
+            m_keyframes.push_back(m_blocks.size() - 1);
+        else if(block.header.kind == LOG_STATS && (!read_block(m_blocks.size() - 1, m_raw) || !decode_rows(m_raw, block.header.count, columns, m_rows)))
+            return false;
+    }
+    m_file.clear();
+
+    if(m_keyframes.empty())
+        return false;
+    seek(get_start());
+    return !m_error;
+}
+
+int Replay::get_start() const
+{
+    return m_keyframes.empty() ? 0 : m_blocks[m_keyframes[0]].header.start;
+}
+
+int Replay::get_end() const
+{
+    return m_blocks.empty() ? 0 : m_blocks.back().header.end;
+}
+
+int Replay::get_time() const
+{
+    return m_time;
+}
+
+int Replay::get_keyframes_number() const
+{
+    return m_keyframes.size();
+}
+
+bool Replay::read_block(int index, std::vector <unsigned char> &raw)
+{
+    LogBlockHeader const& header = m_blocks[index].header;
+    m_stored.resize(header.stored_size);
+    m_file.seekg(m_blocks[index].offset);
+    if(!m_file.read(reinterpret_cast<char*>(m_stored.data()), m_stored.size()) || !uncompress_block(m_stored, header.raw_size, raw))
+    {
+        m_file.clear();
+        m_error = true;
+        return false;
+    }
+    return true;
+}
+
+bool Replay::load_keyframe(int index)
+{
+    PROFILE_ZONE("Replay::load_keyframe");
+    int time = m_blocks[index].header.start;
+    if(!read_block(index, m_raw))
+        return false;
+
+    CheckpointReader cp;
+    cp.open(m_raw);
+    int32_t number = 0;
+    if(!m_map->load_state(cp, time) || !m_blood->load_state(cp, time) || !cp.read_value(number))
+    {
+        m_error = true;
+        return false;
+    }
+
+    m_animals.clear();
+    for(int i = 0; i < number; i++)
+    {
+        int32_t id = 0, specie = 0, color = 0, male = 0, alive = 0, health = 0, origin = 0;
+        Vector2d pos, dest;
+        if(!cp.read_value(id) || !cp.read_value(specie) || !cp.read_value(color) || !cp.read_value(male) || !cp.read_value(alive) || !cp.read_value(health)
+           || !cp.read_value(origin) || !cp.read_value(pos) || !cp.read_value(dest) || specie < 1 || specie > m_speeds.size())
+        {
+            m_error = true;
+            return false;
+        }
+        m_animals[id] = {specie, color, health, male != 0, alive != 0, pos, dest, time, origin, time};
+    }
+
+    m_time = time;
+    m_next = index + 1;
+    m_events.clear();
+    m_event = 0;
+    return true;
+}
+
+bool Replay::read_events()
+{
+    for(; m_next < m_blocks.size(); m_next++)
+    {
+        if(m_blocks[m_next].header.kind != LOG_EVENTS)
+            continue;
+        if(!read_block(m_next, m_raw) || !decode_events(m_raw, m_blocks[m_next].header.count, m_events))
+        {
+            m_error = true;
+            m_events.clear();
+            m_next = m_blocks.size();
+            return false;
+        }
+        m_event = 0;
+        m_next += 1;
+        return true;
+    }
+    return false;
+}
+
+void Replay::seek(int time)
+{
+    time = std::max(get_start(), std::min(time, get_end()));
+    int keyframe = 0;
+    while(keyframe + 1 < m_keyframes.size() && m_blocks[m_keyframes[keyframe + 1]].header.start <= time)
+        keyframe += 1;
+    if(load_keyframe(m_keyframes[keyframe]))
+        advance(time);
+}
+
+void Replay::advance(int time)
+{
+    PROFILE_ZONE("Replay::advance");
+    time = std::min(time, get_end());
+    if(time < m_time)
+    {
+        seek(time);
+        return;
+    }
+
+    //far ahead, a keyframe on the way is closer than the events (a playback only goes through them)
+    for(int k = m_keyframes.size() - 1; k >= 0 && m_keyframes[k] >= m_next && time - m_time > REPLAY_JUMP; k--)
+    {
+        if(m_blocks[m_keyframes[k]].header.start <= time)
+        {
+            seek(time);
+            return;
+        }
+    }
+
+    while(true)
+    {
+        while(m_event < m_events.size() && m_events[m_event].time <= time)
+            apply(m_events[m_event++]);
+        if(m_event < m_events.size() || !read_events())
+            break;
+    }
+    m_time = time;
+    m_blood->update(time);
+}
+
+void Replay::apply(LogEvent const& event)
+{
+    std::map <int, ReplayAnimal>::iterator found = m_animals.find(event.id);
+    switch(event.type)
+    {
+    case EVENT_SPAWN:
+        m_animals[event.id] = {event.value, event.other, event.extra >> 1, (event.extra & 1) != 0, true, event.pos, event.dest, event.time, event.origin, event.time};
+        break;
+    case EVENT_DEATH:
+        if(found != m_animals.end())
+        {
+            found->second.alive = false;
+            found->second.pos = event.pos;
+            found->second.time = event.time;
+        }
+        break;
+    case EVENT_REMOVE:
+        if(found != m_animals.end())
+            m_animals.erase(found);
+        break;
+    case EVENT_DESTINATION:
+        if(found != m_animals.end())
+        {
+            found->second.pos = event.pos;
+            found->second.dest = event.dest;
+            found->second.time = event.time;
+        }
+        break;
+    case EVENT_ATTACK:
+        found = m_animals.find(event.other);
+        if(found != m_animals.end())
+        {
+            settle(found->second, event.time);
+            found->second.health -= event.value;
+        }
+        m_blood->update(event.time); //the stain is dated by the blood
+        m_blood->add_stain(event.pos);
+        break;
+    case EVENT_MEAL:
+        if(found != m_animals.end())
+        {
+            settle(found->second, event.time);
+            found->second.health += event.extra;
+        }
+        break;
+    case EVENT_RESOURCE:
+        m_map->set_resource(event.id, event.other, event.value);
+        break;
+    }
+}
+
+Vector2d Replay::get_position(ReplayAnimal const& animal, int time) const //the same walk as Animal::move
+{
+    double dx = animal.dest.x - animal.pos.x, dy = animal.dest.y - animal.pos.y;
+    double distance = sqrt(dx * dx + dy * dy);
+    if(!animal.alive || distance <= 0.25)
+        return animal.pos;
+    double walked = std::min(distance, m_speeds[animal.specie - 1] * (time - animal.time) / 1000.0);
+    Vector2d pos = {animal.pos.x + dx / distance * walked, animal.pos.y + dy / distance * walked};
+    return pos;
+}
+
+int Replay::get_health(ReplayAnimal const& animal, int time) const //the decrease of Animal::get_vitals: one at each update since the health was known
+{
+    if(!animal.alive)
+        return 0;
+    int updates = (time - animal.origin) / 1000 - (animal.health_time - animal.origin) / 1000;
+    return std::max(0, animal.health - std::max(0, updates));
+}
+
+void Replay::settle(ReplayAnimal &animal, int time) const
+{
+    animal.health = get_health(animal, time);
+    animal.health_time = time;
+}
+
+void Replay::snapshot(SDL_Rect const& area, Snapshot &snapshot) const
+{
+    m_map->snapshot(area, snapshot);
+    m_blood->snapshot(area, snapshot.stains);
+
+    std::vector <AnimalSnapshot> &animals = snapshot.animals;
+    animals.clear();
+    for(std::map <int, ReplayAnimal>::const_iterator it = m_animals.begin(); it != m_animals.end(); ++it)
+    {
+        ReplayAnimal const& animal = it->second;
+        Vector2d pos = get_position(animal, m_time);
+        if(pos.x + 1 < area.x || pos.x - 1 >= area.x + area.w || pos.y + 1 < area.y || pos.y - 1 >= area.y + area.h)
+            continue;
+
+        //the direction and the animation of Animal::move, which are not recorded
+        double dx = animal.dest.x - pos.x, dy = animal.dest.y - pos.y;
+        bool walking = animal.alive && dx * dx + dy * dy > 0.0625;
+        int direction = 2 * std::abs(dx) > std::abs(dy) ? (dx > 0 ? RIGHT : LEFT) : (dy > 0 ? BOT : TOP);
+        animals.push_back({it->first, pos, animal.specie, animal.color, walking ? m_time / 100 % 3 : 0, direction, get_health(animal, m_time), animal.male});
+    }
+    snapshot.animals_number = m_animals.size();
+}
+
+int Replay::get_number(int specie) const
+{
+    int number = 0;
+    for(std::map <int, ReplayAnimal>::const_iterator it = m_animals.begin(); it != m_animals.end(); ++it)
+        if(it->second.alive && it->second.specie == specie)
+            number += 1;
+    return number;
+}
+
+int Replay::get_number() const
+{
+    return m_animals.size();
+}
+
+bool Replay::find_animal(int specie, int &id, Vector2d &pos) const
+{
+    for(std::map <int, ReplayAnimal>::const_iterator it = m_animals.begin(); it != m_animals.end(); ++it)
+    {
+        if(it->second.alive && it->second.specie == specie)
+        {
+            id = it->first;
+            pos = get_position(it->second, m_time);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector < std::vector <int> > const& Replay::get_rows() const
+{
+    return m_rows;
+}
+
+bool Replay::get_error() const
+{
+    return m_error;
+}
@@ -0,0 +1,84 @@
+#ifndef DEF_REPLAY
+#define DEF_REPLAY
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include "EventLog.hpp"
+#include "Map.hpp"
+#include "Blood.hpp"
+#include "Snapshot.hpp"
+#include "Scenario.hpp"
+#include "Random.hpp"
+
+//replay of an event log without running the AI: the state is loaded from the last keyframe before the wanted time,
+//then the events are applied in order; between two destinations an animal walks straight at the speed of its specie
+class Replay
+{
+public:
+    explicit Replay(Scenario const& scenario);
+    ~Replay();
+
+    bool open(std::string const& file_name); //reads the header, the index of the blocks and the stats, then the first keyframe
+    int get_start() const; //simulated ms covered by the log
+    int get_end() const;
+    int get_time() const;
+    int get_keyframes_number() const;
+
+    void seek(int time); //from the last keyframe before the time, backwards as well as forwards
+    void advance(int time); //applies the events up to the time (only a seek when it is earlier or a keyframe is closer)
+
+    void snapshot(SDL_Rect const& area, Snapshot &snapshot) const; //the map, the stains and the animals of the area at the current time
+    int get_number(int specie) const; //animals alive
+    int get_number() const; //all the animals, alive or dead
+    bool find_animal(int specie, int &id, Vector2d &pos) const; //the first animal of the specie, false if there is none
+    std::vector < std::vector <int> > const& get_rows() const; //the stats of the recording, one row per simulated second
+    bool get_error() const; //a block could not be read
+
+private:
+    struct ReplayAnimal
+    {
+        int specie, color, health;
+        bool male, alive;
+        Vector2d pos, dest;
+        int time; //when it was at pos
+        int origin; //the health decreases by one every second after it
+        int health_time; //when it had this health
+    };
+
+    struct BlockIndex
+    {
+        LogBlockHeader header;
+        std::streamoff offset;
+    };
+
+    bool read_block(int index, std::vector <unsigned char> &raw);
+    bool load_keyframe(int index);
+    bool read_events(); //the next events block, false at the end of the log
+    void apply(LogEvent const& event);
+    Vector2d get_position(ReplayAnimal const& animal, int time) const;
+    int get_health(ReplayAnimal const& animal, int time) const;
+    void settle(ReplayAnimal &animal, int time) const; //stores the health at the time, before changing it
+
+    Scenario const& m_scenario;
+    Random m_random; //the map needs one, nothing is drawn
+    Map *m_map;
+    Blood *m_blood;
+
+    std::ifstream m_file;
+    std::vector <double> m_speeds; //of each specie during the recording
+    std::vector <BlockIndex> m_blocks;
+    std::vector <int> m_keyframes; //index of each keyframe block
+    std::vector < std::vector <int> > m_rows;
+    bool m_error;
+
+    std::map <int, ReplayAnimal> m_animals; //by id, in the order of the snapshots
+    int m_time;
+    int m_next; //next block to read
+    std::vector <LogEvent> m_events; //of the last events block read
+    size_t m_event; //next event to apply
+    std::vector <unsigned char> m_raw, m_stored;
+};
+
+#endif
@@ -0,0 +1,497 @@
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "Scenario.hpp"
+#include "FileReader.hpp"
+#include "Checkpoint.hpp"
+
+Scenario::Scenario()
+{
+    directory = "settings";
+    width = 0;
+    height = 0;
+    blood_disappearance_time = 0;
+    scent = {0, 0, 0, 0};
+}
+
+bool Scenario::load(std::string const& path)
+{
+    m_errors.clear();
+    m_warnings.clear();
+    directory = path;
+
+    struct stat info;
+    if(stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode))
+    {
+        if(!load_compiled(path))
+            m_errors.push_back(path + " : scenario compile invalide ou d'une autre version");
+    }
+    else
+        load_directory(path);
+
+    validate();
+    return m_errors.empty();
+}
+
+void Scenario::load_directory(std::string const& directory)
+{
+    std::string root = directory + "//";
+    FileReader fr(&m_errors); //every error is reported, not only the first one
+
+    fr.read(root + "map.txt");
+    width = fr.getInt("width");
+    height = fr.getInt("height");
+    biome_percent.clear();
+    for(int i = 0; i < fr.getCount() - 2; i++)
+        biome_percent.push_back(fr.getInt("biome_" + std::to_string(i + 1)));
+
+    fr.read(root + "species_init.txt");
+    int species_number = fr.getCount();
+    species_init.clear();
+    for(int i = 0; i < species_number; i++)
+        species_init.push_back(fr.getInt("specie_" + std::to_string(i + 1)));
+
+    fr.read(root + "species_name.txt");
+    species_name.clear();
+    for(int i = 0; i < fr.getCount(); i++)
+        species_name.push_back(fr.getString("specie_" + std::to_string(i + 1)));
+
+    species.resize(species_number);
+    for(int i = 0; i < species_number; i++)
+    {
+        fr.read(root + "specie_" + std::to_string(i + 1) + ".txt");
+        SpecieSettings &specie = species[i];
+        specie.damage = fr.getInt("damage");
+        specie.speed = fr.getDouble("speed");
+        specie.life_expectancy = fr.getInt("life_expectancy");
+        specie.maximum_health = fr.getInt("maximum_health");
+        specie.hunger_threshold = fr.getInt("hunger_threshold");
+        specie.satiated_threshold = fr.getInt("satiated_threshold");
+        specie.agressive = fr.getInt("agressive");
+        specie.plant_range_detection = fr.getInt("plant_range_detection");
+        specie.prey_range_detection = fr.getInt("prey_range_detection");
+        specie.partner_range_detection = fr.getInt("partner_range_detection");
+        specie.agressivity_range = fr.getInt("agressivity_range");
+        specie.search_distance = fr.getInt("search_distance");
+        specie.reproduction_time = fr.getInt("reproduction_time");
+        specie.decomposition_time = fr.getInt("decomposition_time");
+        specie.plants = fr.getVectorInt("plants");
+        specie.preys = fr.getVectorInt("preys");
+        specie.colors = fr.getVectorInt("colors");
+    }
+
+    fr.read(root + "resources_init.txt");
+    int resources_number = fr.getCount();
+    resources_init.clear();
+    for(int i = 0; i < resources_number; i++)
+        resources_init.push_back(fr.getInt("resource_" + std::to_string(i + 1)));
+
+    fr.read(root + "resources_name.txt");
+    resources_name.clear();
+    for(int i = 0; i < fr.getCount(); i++)
+        resources_name.push_back(fr.getString("resource_" + std::to_string(i + 1)));
+
+    resources.resize(resources_number);
+    for(int i = 0; i < resources_number; i++)
+    {
+        fr.read(root + "resource_" + std::to_string(i + 1) + ".txt");
+        resources[i].location = fr.getVectorInt("location");
+        resources[i].adaptive = fr.getInt("adaptive");
+        resources[i].target = fr.getInt("target");
+        resources[i].add = fr.getInt("add");
+    }
+
+    fr.read(root + "nutritional_value.txt");
+    nutritional_value.resize(fr.getCount());
+    for(int i = 0; i < nutritional_value.size(); i++)
+    {
+        if(i < species_number)
+            nutritional_value[i] = fr.getInt("specie_" + std::to_string(i + 1));
+        else
+            nutritional_value[i] = fr.getInt("resource_" + std::to_string(i + 1 - species_number));
+    }
+
+    fr.read(root + "blood.txt");
+    blood_disappearance_time = fr.getInt("disappearance_time");
+
+    scent = {0, 0, 0, 0}; //optional: without the file, the predators look at every animal within their range
+    struct stat info;
+    if(stat((root + "scent.txt").c_str(), &info) == 0)
+    {
+        fr.read(root + "scent.txt");
+        scent.cell = fr.getInt("cell");
+        scent.diffusion = fr.getDouble("diffusion");
+        scent.decay = fr.getDouble("decay");
+        scent.contact_range = fr.getInt("contact_range");
+    }
+}
+
+static bool parse_index(std::string const& name, std::string const& prefix, int number, int &index) //"specie_3" -> 2
+{
+    if(name.compare(0, prefix.size(), prefix) != 0)
+        return false;
+    try
+    {
+        index = std::stoi(name.substr(prefix.size())) - 1;
+    }
+    catch(std::exception const& e)
+    {
+        return false;
+    }
+    return index >= 0 && index < number;
+}
+
+bool Scenario::set(std::string const& parameter, double value)
+{
+    std::string file = parameter.substr(0, parameter.find('.'));
+    std::string key = parameter.substr(parameter.find('.') + 1);
+    int whole = std::lround(value);
+    int index = 0;
+
+    if(file == "map")
+    {
+        if(key == "width")
+            width = whole;
+        else if(key == "height")
+            height = whole;
+        else if(parse_index(key, "biome_", biome_percent.size(), index))
+            biome_percent[index] = whole;
+        else
+            return false;
+    }
+    else if(file == "species_init" && parse_index(key, "specie_", species_init.size(), index))
+        species_init[index] = whole;
+    else if(file == "resources_init" && parse_index(key, "resource_", resources_init.size(), index))
+        resources_init[index] = whole;
+    else if(file == "nutritional_value" && parse_index(key, "specie_", species.size(), index))
+        nutritional_value[index] = whole;
+    else if(file == "nutritional_value" && parse_index(key, "resource_", resources.size(), index))
+        nutritional_value[species.size() + index] = whole;
+    else if(file == "blood" && key == "disappearance_time")
+        blood_disappearance_time = whole;
+    else if(file == "scent")
+    {
+        if(key == "cell")
+            scent.cell = whole;
+        else if(key == "diffusion")
+            scent.diffusion = value;
+        else if(key == "decay")
+            scent.decay = value;
+        else if(key == "contact_range")
+            scent.contact_range = whole;
+        else
+            return false;
+    }
+    else if(parse_index(file, "specie_", species.size(), index))
+    {
+        SpecieSettings &specie = species[index];
+        if(key == "damage")
+            specie.damage = whole;
+        else if(key == "speed")
+            specie.speed = value;
+        else if(key == "life_expectancy")
+            specie.life_expectancy = whole;
+        else if(key == "maximum_health")
+            specie.maximum_health = whole;
+        else if(key == "hunger_threshold")
+            specie.hunger_threshold = whole;
+        else if(key == "satiated_threshold")
+            specie.satiated_threshold = whole;
+        else if(key == "agressive")
+            specie.agressive = whole;
+        else if(key == "plant_range_detection")
+            specie.plant_range_detection = whole;
+        else if(key == "prey_range_detection")
+            specie.prey_range_detection = whole;
+        else if(key == "partner_range_detection")
+            specie.partner_range_detection = whole;
+        else if(key == "agressivity_range")
+            specie.agressivity_range = whole;
+        else if(key == "search_distance")
+            specie.search_distance = whole;
+        else if(key == "reproduction_time")
+            specie.reproduction_time = whole;
+        else if(key == "decomposition_time")
+            specie.decomposition_time = whole;
+        else
+            return false;
+    }
+    else if(parse_index(file, "resource_", resources.size(), index))
+    {
+        if(key == "adaptive")
+            resources[index].adaptive = whole;
+        else if(key == "target")
+            resources[index].target = whole;
+        else if(key == "add")
+            resources[index].add = whole;
+        else
+            return false;
+    }
+    else
+        return false;
+    return true;
+}
+
+int Scenario::get_species_number() const
+{
+    return species.size();
+}
+
+int Scenario::get_resources_number() const
+{
+    return resources.size();
+}
+
+int Scenario::get_biomes_number() const
+{
+    return biome_percent.size();
+}
+
+std::vector <std::string> const& Scenario::get_errors() const
+{
+    return m_errors;
+}
+
+std::vector <std::string> const& Scenario::get_warnings() const
+{
+    return m_warnings;
+}
+
+void Scenario::validate() //the consistency between the files, which FileReader cannot check
+{
+    std::vector <std::string> &errors = m_errors;
+    if(width <= 0 || height <= 0)
+        errors.push_back("map.txt : la largeur et la hauteur doivent etre positives");
+
+    int total = 0;
+    for(int i = 0; i < biome_percent.size(); i++)
+    {
+        if(biome_percent[i] < 0)
+            errors.push_back("map.txt : biome_" + std::to_string(i + 1) + " est negatif");
+        total += biome_percent[i];
+    }
+    if(total != 100)
+        errors.push_back("map.txt : la somme des pourcentages des biomes vaut " + std::to_string(total) + " au lieu de 100");
+
+    if(species_name.size() != species.size())
+        errors.push_back("species_name.txt : " + std::to_string(species_name.size()) + " noms pour " + std::to_string(species.size()) + " especes");
+    if(resources_name.size() != resources.size())
+        errors.push_back("resources_name.txt : " + std::to_string(resources_name.size()) + " noms pour " + std::to_string(resources.size()) + " ressources");
+    if(nutritional_value.size() != species.size() + resources.size())
+        errors.push_back("nutritional_value.txt : " + std::to_string(nutritional_value.size()) + " valeurs pour " + std::to_string(species.size() + resources.size()) + " especes et ressources");
+    if(blood_disappearance_time < 0)
+        errors.push_back("blood.txt : disappearance_time est negatif");
+    if(scent.cell < 0 || scent.diffusion < 0 || scent.contact_range < 0)
+        errors.push_back("scent.txt : cell, diffusion et contact_range ne peuvent pas etre negatifs");
+    if(scent.decay < 0 || scent.decay > 1)
+        errors.push_back("scent.txt : decay doit etre entre 0 et 1");
+
+    for(int i = 0; i < species.size(); i++)
+    {
+        SpecieSettings const& specie = species[i];
+        std::string file = "specie_" + std::to_string(i + 1) + ".txt : ";
+        if(species_init[i] < 0)
+            errors.push_back("species_init.txt : specie_" + std::to_string(i + 1) + " est negatif");
+        if(specie.speed <= 0)
+            errors.push_back(file + "speed doit etre positive");
+        if(specie.life_expectancy <= 0 || specie.maximum_health <= 0)
+            errors.push_back(file + "life_expectancy et maximum_health doivent etre positifs");
+        if(specie.hunger_threshold < 0 || specie.hunger_threshold > specie.satiated_threshold || specie.satiated_threshold > specie.maximum_health)
+            errors.push_back(file + "il faut 0 <= hunger_threshold <= satiated_threshold <= maximum_health");
+        if(specie.damage < 0 || specie.plant_range_detection < 0 || specie.prey_range_detection < 0 || specie.partner_range_detection < 0
+           || specie.agressivity_range < 0 || specie.search_distance < 0 || specie.reproduction_time < 0 || specie.decomposition_time < 0)
+            errors.push_back(file + "les degats, portees, distances et durees ne peuvent pas etre negatifs");
+        //a plant which is not a resource has never been eaten: it is only reported, and removed so that it is not used as an index
+        std::vector <int> plants;
+        for(int n = 0; n < specie.plants.size(); n++)
+        {
+            if(specie.plants[n] < 1 || specie.plants[n] > resources.size())
+                m_warnings.push_back(file + "plants contient " + std::to_string(specie.plants[n]) + ", il y a " + std::to_string(resources.size()) + " ressources, cette plante est ignoree");
+            else
+                plants.push_back(specie.plants[n]);
+        }
+        species[i].plants = plants;
+        for(int n = 0; n < specie.preys.size(); n++)
+            if(specie.preys[n] < 1 || specie.preys[n] > species.size())
+                errors.push_back(file + "preys contient " + std::to_string(specie.preys[n]) + ", il y a " + std::to_string(species.size()) + " especes");
+        for(int n = 0; n < specie.colors.size(); n++)
+            if(specie.colors[n] < 1 || specie.colors[n] > 8)
+                errors.push_back(file + "colors contient " + std::to_string(specie.colors[n]) + ", les couleurs vont de 1 a 8");
+    }
+
+    for(int i = 0; i < resources.size(); i++)
+    {
+        ResourceSettings const& resource = resources[i];
+        std::string file = "resource_" + std::to_string(i + 1) + ".txt : ";
+        if(resources_init[i] < 0 || resource.target < 0 || resource.add < 0)
+            errors.push_back(file + "resources_init, target et add ne peuvent pas etre negatifs");
+        for(int n = 0; n < resource.location.size(); n++)
+            if(resource.location[n] < 1 || resource.location[n] > biome_percent.size())
+                errors.push_back(file + "location contient " + std::to_string(resource.location[n]) + ", il y a " + std::to_string(biome_percent.size()) + " biomes");
+    }
+}
+
+static void write_vector(CheckpointWriter &cp, std::vector <int> const& values)
+{
+    cp.add_value(int32_t(values.size()));
+    for(int i = 0; i < values.size(); i++)
+        cp.add_value(int32_t(values[i]));
+}
+
+static void write_strings(CheckpointWriter &cp, std::vector <std::string> const& strings)
+{
+    cp.add_value(int32_t(strings.size()));
+    for(int i = 0; i < strings.size(); i++)
+    {
+        cp.add_value(int32_t(strings[i].size()));
+        cp.add_copy(strings[i].data(), strings[i].size());
+    }
+}
+
+static bool read_vector(CheckpointReader &cp, std::vector <int> &values)
+{
+    int32_t size = 0;
+    if(!cp.read_value(size) || size < 0)
+        return false;
+    int32_t const* data = static_cast<int32_t const*>(cp.view(size_t(size) * sizeof(int32_t)));
+    if(!data)
+        return false;
+    values.resize(size);
+    for(int i = 0; i < size; i++)
+    {
+        int32_t value;
+        memcpy(&value, data + i, sizeof(int32_t)); //the mapping gives no alignment guarantee
+        values[i] = value;
+    }
+    return true;
+}
+
+static bool read_strings(CheckpointReader &cp, std::vector <std::string> &strings)
+{
+    int32_t number = 0;
+    if(!cp.read_value(number) || number < 0)
+        return false;
+    strings.resize(number);
+    for(int i = 0; i < number; i++)
+    {
+        int32_t size = 0;
+        if(!cp.read_value(size) || size < 0)
+            return false;
+        char const* data = static_cast<char const*>(cp.view(size));
+        if(!data)
+            return false;
+        strings[i].assign(data, size);
+    }
+    return true;
+}
+
+bool Scenario::save_compiled(std::string const& file_name) const
+{
+    static const char magic[8] = {'S', 'W', 'S', 'C', 'E', 'N', 'E', 0};
+
+    CheckpointWriter cp;
+    cp.add(magic, sizeof(magic));
+    cp.add_value(SCENARIO_VERSION);
+    cp.add_value(int32_t(width));
+    cp.add_value(int32_t(height));
+    cp.add_value(int32_t(blood_disappearance_time));
+    cp.add_value(int32_t(scent.cell));
+    cp.add_value(int32_t(scent.contact_range));
+    cp.add_value(scent.diffusion);
+    cp.add_value(scent.decay);
+    write_vector(cp, biome_percent);
+    write_vector(cp, species_init);
+    write_strings(cp, species_name);
+    write_vector(cp, resources_init);
+    write_strings(cp, resources_name);
+    write_vector(cp, nutritional_value);
+
+    cp.add_value(int32_t(species.size()));
+    for(int i = 0; i < species.size(); i++)
+    {
+        SpecieSettings const& specie = species[i];
+        int32_t const values[] = {specie.damage, specie.life_expectancy, specie.maximum_health, specie.hunger_threshold, specie.satiated_threshold,
+                                  specie.agressive, specie.plant_range_detection, specie.prey_range_detection, specie.partner_range_detection,
+                                  specie.agressivity_range, specie.search_distance, specie.reproduction_time, specie.decomposition_time};
+        cp.add_copy(values, sizeof(values));
+        cp.add_value(specie.speed);
+        write_vector(cp, specie.plants);
+        write_vector(cp, specie.preys);
+        write_vector(cp, specie.colors);
+    }
+
+    cp.add_value(int32_t(resources.size()));
+    for(int i = 0; i < resources.size(); i++)
+    {
+        int32_t const values[] = {resources[i].adaptive, resources[i].target, resources[i].add};
+        cp.add_copy(values, sizeof(values));
+        write_vector(cp, resources[i].location);
+    }
+    return cp.write(file_name);
+}
+
+bool Scenario::load_compiled(std::string const& file_name)
+{
+    CheckpointReader cp;
+    if(!cp.open(file_name))
+        return false;
+
+    char magic[8];
+    int32_t version = 0, values[13];
+    if(!cp.read(magic, sizeof(magic)) || memcmp(magic, "SWSCENE", 8) || !cp.read_value(version) || version != SCENARIO_VERSION)
+        return false;
+    if(!cp.read(values, 3 * sizeof(int32_t)))
+        return false;
+    width = values[0];
+    height = values[1];
+    blood_disappearance_time = values[2];
+    if(!cp.read(values, 2 * sizeof(int32_t)) || !cp.read_value(scent.diffusion) || !cp.read_value(scent.decay))
+        return false;
+    scent.cell = values[0];
+    scent.contact_range = values[1];
+    if(!read_vector(cp, biome_percent) || !read_vector(cp, species_init) || !read_strings(cp, species_name)
+       || !read_vector(cp, resources_init) || !read_strings(cp, resources_name) || !read_vector(cp, nutritional_value))
+        return false;
+
+    int32_t number = 0;
+    if(!cp.read_value(number) || number != species_init.size())
+        return false;
+    species.resize(number);
+    for(int i = 0; i < number; i++)
+    {
+        SpecieSettings &specie = species[i];
+        if(!cp.read(values, 13 * sizeof(int32_t)) || !cp.read_value(specie.speed))
+            return false;
+        specie.damage = values[0];
+        specie.life_expectancy = values[1];
+        specie.maximum_health = values[2];
+        specie.hunger_threshold = values[3];
+        specie.satiated_threshold = values[4];
+        specie.agressive = values[5];
+        specie.plant_range_detection = values[6];
+        specie.prey_range_detection = values[7];
+        specie.partner_range_detection = values[8];
+        specie.agressivity_range = values[9];
+        specie.search_distance = values[10];
+        specie.reproduction_time = values[11];
+        specie.decomposition_time = values[12];
+        if(!read_vector(cp, specie.plants) || !read_vector(cp, specie.preys) || !read_vector(cp, specie.colors))
+            return false;
+    }
+
+    if(!cp.read_value(number) || number != resources_init.size())
+        return false;
+    resources.resize(number);
+    for(int i = 0; i < number; i++)
+    {
+        if(!cp.read(values, 3 * sizeof(int32_t)) || !read_vector(cp, resources[i].location))
+            return false;
+        resources[i].adaptive = values[0];
+        resources[i].target = values[1];
+        resources[i].add = values[2];
+    }
+    return true;
+}
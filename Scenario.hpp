@@ -0,0 +1,91 @@
+#ifndef DEF_SCENARIO
+#define DEF_SCENARIO
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+//compiled scenario: "SWSCENE" magic, version, then every setting (the values with the memory layout of the machine)
+static const int32_t SCENARIO_VERSION = 2;
+
+struct SpecieSettings //content of settings/specie_X.txt
+{
+    int damage;
+    double speed;
+    int life_expectancy;
+    int maximum_health;
+    int hunger_threshold;
+    int satiated_threshold;
+    bool agressive;
+    int plant_range_detection;
+    int prey_range_detection;
+    int partner_range_detection;
+    int agressivity_range;
+    int search_distance;
+    int reproduction_time;
+    int decomposition_time;
+    std::vector <int> plants;
+    std::vector <int> preys;
+    std::vector <int> colors;
+};
+
+struct ResourceSettings //content of settings/resource_X.txt
+{
+    std::vector <int> location;
+    bool adaptive;
+    int target;
+    int add;
+};
+
+struct ScentSettings //content of settings/scent.txt, optional
+{
+    int cell; //side of the cells of the scent grids in blocks, 0 without scent
+    double diffusion; //part of the scent of a cell given to each neighbor on an axis each second
+    double decay; //part of the scent disappearing each second
+    int contact_range; //the predators look at the animals one by one only within this range, and follow the scent of their preys beyond it
+};
+
+//all the settings of a simulation, read once and then shared (read only) by every world using them
+class Scenario
+{
+public:
+    Scenario();
+
+    bool load(std::string const& path); //settings directory or scenario compiled by scenario_compile, false if the settings are not valid
+    bool save_compiled(std::string const& file_name) const; //the whole scenario in one binary file, loaded with a single mapping
+    bool set(std::string const& parameter, double value); //changes one setting, for example "specie_3.speed" or "species_init.specie_3"
+
+    int get_species_number() const;
+    int get_resources_number() const;
+    int get_biomes_number() const;
+    std::vector <std::string> const& get_errors() const; //every error found by the last load
+    std::vector <std::string> const& get_warnings() const; //settings ignored by the last load, which do not prevent the simulation
+
+    std::string directory;
+
+    int width, height;
+    std::vector <int> biome_percent;
+
+    std::vector <SpecieSettings> species;
+    std::vector <int> species_init;
+    std::vector <std::string> species_name;
+
+    std::vector <ResourceSettings> resources;
+    std::vector <int> resources_init;
+    std::vector <std::string> resources_name;
+
+    std::vector <int> nutritional_value; //the species first, then the resources
+
+    int blood_disappearance_time;
+    ScentSettings scent;
+
+private:
+    void load_directory(std::string const& directory);
+    bool load_compiled(std::string const& file_name);
+    void validate();
+
+    std::vector <std::string> m_errors;
+    std::vector <std::string> m_warnings;
+};
+
+#endif
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <cmath>
+#include "Scent.hpp"
+
+Scent::Scent(Scenario const& scenario): m_scenario(scenario)
+{
+    m_cell = scenario.scent.cell;
+    m_columns = 0;
+    m_rows = 0;
+    m_time = 0;
+
+    //only the species hunted by another one leave a scent
+    m_index.assign(scenario.get_species_number(), -1);
+    int tracked = 0;
+    for(int i = 0; i < scenario.species.size() && m_cell > 0; i++)
+        for(int n = 0; n < scenario.species[i].preys.size(); n++)
+            if(m_index[scenario.species[i].preys[n] - 1] < 0)
+                m_index[scenario.species[i].preys[n] - 1] = tracked++;
+    m_grids.resize(tracked);
+    m_buffers.resize(tracked);
+    m_smelling.assign(tracked, 0);
+}
+
+void Scent::reset(int width, int height, int now)
+{
+    m_columns = m_cell > 0 ? (width + m_cell - 1) / m_cell : 0;
+    m_rows = m_cell > 0 ? (height + m_cell - 1) / m_cell : 0;
+    for(int i = 0; i < m_grids.size(); i++)
+    {
+        m_grids[i].assign(size_t(m_columns) * m_rows, 0.0f);
+        m_buffers[i].assign(size_t(m_columns) * m_rows, 0.0f);
+        m_smelling[i] = 0;
+    }
+    m_time = now;
+}
+
+bool Scent::is_enabled() const
+{
+    return m_cell > 0;
+}
+
+int Scent::get_cell() const
+{
+    return m_cell;
+}
+
+int Scent::get_columns() const
+{
+    return m_columns;
+}
+
+int Scent::get_rows() const
+{
+    return m_rows;
+}
+
+double Scent::get(int specie, int column, int row) const
+{
+    if(column < 0 || row < 0 || column >= m_columns || row >= m_rows || m_index[specie - 1] < 0)
+        return 0;
+    return m_grids[m_index[specie - 1]][size_t(row) * m_columns + column];
+}
+
+void Scent::deposit(int specie, double x, double y, int dt)
+{
+    if(m_index[specie - 1] < 0)
+        return;
+    int column = std::max(0, std::min(m_columns - 1, int(x) / m_cell));
+    int row = std::max(0, std::min(m_rows - 1, int(y) / m_cell));
+    m_grids[m_index[specie - 1]][size_t(row) * m_columns + column] += dt / 1000.0f; //the same amount for every animal: the sum does not depend on their order
+    m_smelling[m_index[specie - 1]] += 1; //counted again at the next update
+}
+
+void Scent::update(int now, WorkerPool *pool)
+{
+    double seconds = std::max(0, now - m_time) / 1000.0;
+    m_time = now;
+    if(m_grids.empty() || m_columns == 0 || m_rows == 0 || seconds == 0)
+        return;
+
+    float spread = std::min(0.25, m_scenario.scent.diffusion * seconds); //part given to each neighbor on an axis, at most 1/4 so that every weight stays positive
+    float kept = std::pow(1.0 - m_scenario.scent.decay, seconds);
+    if(pool)
+        pool->run(m_grids.size(), [this, spread, kept](int i)
+        {
+            if(m_smelling[i] > 0)
+                m_smelling[i] = update_grid(m_grids[i], m_buffers[i], spread, kept);
+        });
+    else
+        for(int i = 0; i < m_grids.size(); i++)
+            if(m_smelling[i] > 0)
+                m_smelling[i] = update_grid(m_grids[i], m_buffers[i], spread, kept);
+}
+
+int Scent::update_grid(std::vector <float> &grid, std::vector <float> &buffer, float spread, float kept) const
+{
+    //horizontal pass, with the decay: the borders keep the scent which would leave the map
+    float side = kept * spread, center = kept * (1 - 2 * spread), border = kept * (1 - spread);
+    for(int y = 0; y < m_rows; y++)
+    {
+        float const* in = grid.data() + size_t(y) * m_columns;
+        float *out = buffer.data() + size_t(y) * m_columns;
+        if(m_columns == 1)
+        {
+            out[0] = kept * in[0];
+            continue;
+        }
+        out[0] = border * in[0] + side * in[1];
+        for(int x = 1; x < m_columns - 1; x++)
+            out[x] = side * (in[x - 1] + in[x + 1]) + center * in[x];
+        out[m_columns - 1] = border * in[m_columns - 1] + side * in[m_columns - 2];
+    }
+
+    //vertical pass, whole rows at once; the faint scent is dropped before it reaches the slow denormal floats
+    center = 1 - 2 * spread;
+    int smelling = 0;
+    for(int y = 0; y < m_rows; y++)
+    {
+        float const* up = buffer.data() + size_t(std::max(0, y - 1)) * m_columns;
+        float const* in = buffer.data() + size_t(y) * m_columns;
+        float const* down = buffer.data() + size_t(std::min(m_rows - 1, y + 1)) * m_columns;
+        float *out = grid.data() + size_t(y) * m_columns;
+        for(int x = 0; x < m_columns; x++)
+        {
+            float value = spread * (up[x] + down[x]) + center * in[x];
+            out[x] = value >= 1e-6f ? value : 0.0f;
+            smelling += value >= 1e-6f;
+        }
+    }
+    return smelling;
+}
+
+void Scent::save_state(CheckpointWriter &cp) const
+{
+    cp.add_value(int32_t(m_columns));
+    cp.add_value(int32_t(m_rows));
+    cp.add_value(int32_t(m_grids.size()));
+    for(int i = 0; i < m_grids.size(); i++)
+        cp.add_copy(m_grids[i].data(), m_grids[i].size() * sizeof(float));
+}
+
+bool Scent::load_state(CheckpointReader &cp, int now)
+{
+    int32_t columns = 0, rows = 0, number = 0;
+    if(!cp.read_value(columns) || !cp.read_value(rows) || !cp.read_value(number))
+        return false;
+    if(columns < 0 || rows < 0 || number < 0)
+        return false;
+    m_time = now;
+    if(columns != m_columns || rows != m_rows || number != m_grids.size()) //saved with other scent settings: the scent starts again from nothing
+        return cp.view(size_t(number) * columns * rows * sizeof(float)) != NULL;
+
+    for(int i = 0; i < m_grids.size(); i++)
+    {
+        if(!cp.read(m_grids[i].data(), m_grids[i].size() * sizeof(float)))
+            return false;
+        m_smelling[i] = m_grids[i].size() - std::count(m_grids[i].begin(), m_grids[i].end(), 0.0f);
+    }
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef DEF_SCENT
+#define DEF_SCENT
+
+#include <vector>
+#include "Checkpoint.hpp"
+#include "Scenario.hpp"
+#include "WorkerPool.hpp"
+
+//scent left by the species hunted by another one, on a coarse grid of cells of several blocks (one grid per hunted specie)
+//each step the scent decays and spreads to the neighbor cells, horizontally then vertically: two passes over whole rows which the compiler vectorizes
+//a predator follows the cell around it where its preys smell the most instead of looking at every animal within its range
+class Scent
+{
+public:
+    explicit Scent(Scenario const& scenario);
+
+    void reset(int width, int height, int now); //no scent left on a map of this size
+
+    bool is_enabled() const; //false without settings/scent.txt or with cell=0
+    int get_cell() const; //side of a cell in blocks
+    int get_columns() const;
+    int get_rows() const;
+    double get(int specie, int column, int row) const; //scent of a specie in a cell, 0 outside the map or for a specie nobody hunts
+
+    void deposit(int specie, double x, double y, int dt); //an animal at this position during dt ms
+    void update(int now, WorkerPool *pool); //decay and spreading since the last update, each grid in a task of the pool if there is one
+
+    void save_state(CheckpointWriter &cp) const;
+    bool load_state(CheckpointReader &cp, int now);
+
+private:
+    int update_grid(std::vector <float> &grid, std::vector <float> &buffer, float spread, float kept) const; //returns the number of cells still smelling
+
+    Scenario const& m_scenario;
+    int m_cell;
+    int m_columns, m_rows; //number of cells
+    std::vector <int> m_index; //grid of each specie, -1 for the species nobody hunts
+    std::vector < std::vector <float> > m_grids; //row after row
+    std::vector < std::vector <float> > m_buffers; //result of the horizontal pass
+    std::vector <int> m_smelling; //cells of each grid with some scent, the empty grids are not updated
+    int m_time; //time of the last update
+};
+
+#endif
@@ -6,49 +6,116 @@
 #include <map>
 #include <fstream>
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
 #include "Simulation.hpp"
-#include "speed.hpp"
+#include "Profiler.hpp"
+
+static const int SIMULATION_FRAME = 16; //ms of real time of a frame of the simulation, a snapshot is published after each one
+static const int SIMULATION_BUDGET = 12; //part of a frame for the steps, the rest for the snapshot and the display waiting for the world
+static const int REPLAY_SEEK = 60000; //simulated ms skipped by the arrows in a replay
 
 Simulation::Simulation(Settings const& settings): m_settings(settings)
 {
-    srand(time(0));
     SDL_Init(SDL_INIT_VIDEO|SDL_INIT_TIMER);
     if(m_settings.hide)
         m_window = SDL_CreateWindow("SimuWorld", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 800, 600, SDL_WINDOW_HIDDEN);
     else
         m_window = SDL_CreateWindow("SimuWorld", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 800, 600, SDL_WINDOW_RESIZABLE);
     SDL_GetWindowSize(m_window, &m_winsize.x, &m_winsize.y);
-    m_renderer = SDL_CreateRenderer(m_window, -1, SDL_RENDERER_ACCELERATED);
+    m_renderer = SDL_CreateRenderer(m_window, -1, SDL_RENDERER_ACCELERATED|SDL_RENDERER_PRESENTVSYNC); //the display does not need more frames than the screen shows
     SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "1");
     IMG_Init(IMG_INIT_JPG|IMG_INIT_PNG);
     SDL_SetWindowIcon(m_window, IMG_Load("icone.png"));
     TTF_Init();
 
-    m_map = new Map(m_renderer);
-    m_population = new Population(m_renderer);
+    if(!m_scenario.load(m_settings.scenario)) //every error at once, the simulation cannot start
+    {
+        std::vector <std::string> const& errors = m_scenario.get_errors();
+        std::string body;
+        for(int i = 0; i < errors.size() && i < 20; i++)
+            body += errors[i] + "\n";
+        if(errors.size() > 20)
+            body += "... (" + std::to_string(errors.size()) + " erreurs)";
+        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Parametres invalides", body.c_str(), NULL);
+        exit(0);
+    }
+    m_world = new World(m_scenario, m_settings.seed, m_renderer);
+    m_map = &m_world->get_map();
+    m_population = &m_world->get_population();
+    m_stats = &m_world->get_stats();
     m_camera = new Camera();
-    m_stats = new Stats();
+    m_hud = new Hud();
+    m_display_stats = new Stats(m_scenario);
 
     m_leftclick = false;
     m_render = true;
     m_paused = false;
+    m_error = false;
 
-    m_map->generate();
-    m_population->generate();
+    m_world->set_threads(m_settings.threads);
+    m_replay = NULL;
+    if(!m_settings.replay.empty()) //the world is not generated, only its textures are used
+    {
+        m_replay = new Replay(m_scenario);
+        if(!m_replay->open(m_settings.replay))
+        {
+            std::string error = m_settings.replay + " n'a pas pu etre lu";
+            SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Erreur de lecture", error.c_str(), NULL);
+            m_error = true;
+        }
+    }
+    else
+    {
+        m_world->generate();
+        if(!m_settings.checkpoint.empty() && !load_checkpoint(m_settings.checkpoint))
+        {
+            std::string error = m_settings.checkpoint + " n'a pas pu etre restaure";
+            SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Erreur de sauvegarde", error.c_str(), NULL);
+            m_error = true;
+        }
+        if(!m_settings.record.empty() && !m_world->record(m_settings.record, m_settings.keyframes))
+        {
+            std::string error = m_settings.record + " n'a pas pu etre cree";
+            SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Erreur d'enregistrement", error.c_str(), NULL);
+            m_error = true;
+        }
+        if(m_settings.id) //launched without the launcher, nothing reads the stream
+            m_stats->stream(m_settings.directory, m_settings.id);
+    }
+    m_last_checkpoint = m_stats->get_elapsed_time();
+
+    m_speed = new SpeedController(m_settings.step, SIMULATION_BUDGET);
+    m_speed->set_target(m_settings.speed);
+
+    m_steps = 0;
+    m_status_steps = 0;
+    m_status_time = SDL_GetTicks();
 
-    set_simulation_speed(m_settings.speed);
+    m_stop = false;
+    m_finished = false;
+    m_save_failed = false;
+    m_world_wanted = false;
+    m_area = {0, 0, 0, 0};
+    m_received_rows = 0;
+    m_seek = 0;
+    if(m_settings.id) //launched from the launcher
+        m_status.open("status_" + std::to_string(m_settings.id) + ".bin", m_settings.statusRate);
 }
 
 Simulation::~Simulation()
 {
+    delete m_world; //the textures before their renderer
+    delete m_camera;
+    delete m_hud;
+    delete m_display_stats;
+    delete m_speed;
+    delete m_replay;
+
     SDL_DestroyRenderer(m_renderer);
     SDL_DestroyWindow(m_window);
 
-    delete m_map;
-    delete m_camera;
-    delete m_population;
-    delete m_stats;
-
     TTF_Quit();
     IMG_Quit();
     SDL_Quit();
@@ -56,47 +123,195 @@ Simulation::~Simulation()
 
 bool Simulation::get_error() const
 {
-    if(m_map->get_error() || m_population->get_error() || m_stats->get_error())
+    if(m_error || m_world->get_error() || m_hud->get_error() || m_display_stats->get_error())
         return true;
     return false;
 }
 
 void Simulation::execute()
 {
-    while(process_events() && check_status())
+    Profiler::set_thread_name("affichage");
+    m_thread = std::thread(&Simulation::simulate, this);
+    while(!m_finished && process_events())
     {
-        update();
+        fetch_snapshot();
         if(!m_settings.hide)
             render();
+        else
+            SDL_Delay(10); //nothing to display, the events are enough
+        m_hud->update(m_snapshots.get_front().animals_number, m_snapshots.get_front().steps);
+    }
+    m_stop = true;
+    m_thread.join();
+
+    //the simulation thread could not save the stats at its end: the display asks to try again until they are saved
+    while(m_save_failed && !m_stats->save(m_settings.directory, m_settings.id))
+        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Fermeture impossible", "Une erreur est survenue durant la sauvegarde", NULL);
+
+    if(!m_settings.trace.empty())
+        Profiler::write_trace(m_settings.trace);
+}
+
+void Simulation::simulate()
+{
+    Profiler::set_thread_name("simulation");
+    while(!m_stop)
+    {
+        unsigned int start = SDL_GetTicks();
+        {
+            std::lock_guard <std::mutex> lock(m_world_mutex);
+            if(!m_replay && !check_status())
+            {
+                m_finished = true;
+                return;
+            }
+            int steps = m_steps;
+            update();
+            if(m_steps != steps || m_paused || m_replay) //during a pause the camera may still move, and a replay may be moved
+                publish_snapshot();
+        }
+        int rest = SIMULATION_FRAME - int(SDL_GetTicks() - start);
+        if(rest > 0 && m_speed->get_target() != SPEED_MAXIMUM)
+            SDL_Delay(rest);
+        while(m_world_wanted) //at the maximal speed there is no delay, the mutex would be taken again before the display wakes up
+            std::this_thread::yield();
     }
 }
 
-void Simulation::update()
+void Simulation::update() //as many steps as the speed asks and the frame allows
 {
-    if(!m_paused)
+    PROFILE_ZONE("Simulation::update");
+    m_speed->begin_frame();
+    if(m_replay)
     {
-        m_map->update();
-        m_population->update(*m_map);
-        m_stats->update(*m_population, *m_map);
+        int seek = m_seek.exchange(0);
+        if(seek != 0)
+            m_replay->advance(m_replay->get_time() + seek); //backwards, it starts again from a keyframe
+        while(!m_paused && m_speed->is_step_due() && m_replay->get_time() < m_replay->get_end())
+        {
+            m_replay->advance(m_replay->get_time() + m_speed->get_step());
+            m_steps += 1;
+            m_speed->end_step();
+        }
+        m_speed->end_frame();
+        return;
+    }
+    while(!m_paused && m_speed->is_step_due() && !m_stats->has_finished(m_settings.duration))
+    {
+        m_world->update(m_speed->get_step());
+        m_steps += 1;
+        m_speed->end_step();
+
+        if(m_settings.checkpointInterval > 0 && m_stats->get_elapsed_time() - m_last_checkpoint >= m_settings.checkpointInterval)
+        {
+            PROFILE_ZONE("checkpoint");
+            save_checkpoint(get_checkpoint_name());
+            m_last_checkpoint = m_stats->get_elapsed_time();
+        }
     }
+    m_speed->end_frame();
+}
+
+void Simulation::publish_snapshot()
+{
+    PROFILE_ZONE("Simulation::publish_snapshot");
+    SDL_Rect area;
+    {
+        std::lock_guard <std::mutex> lock(m_area_mutex);
+        area = m_area;
+    }
+
+    Snapshot &snapshot = m_snapshots.get_back();
+    snapshot.ticks = SDL_GetTicks();
+    snapshot.steps = m_steps;
+    if(m_replay)
+    {
+        snapshot.time = m_replay->get_time();
+        m_replay->snapshot(area, snapshot);
+    }
+    else
+    {
+        snapshot.time = m_world->get_time();
+        m_map->snapshot(area, snapshot);
+        m_population->snapshot(area, snapshot);
+    }
+
+    //the rows of stats since the last one received, a skipped snapshot loses none of them
+    //a replay only sends the rows up to its time, all of them again when it went back
+    std::vector < std::vector <int> > const& values = m_replay ? m_replay->get_rows() : m_stats->get_values();
+    int end = values.size();
+    if(m_replay)
+        end = std::min(end, (snapshot.time + 999) / 1000);
+    snapshot.first_row = m_received_rows <= end ? int(m_received_rows) : 0;
+    snapshot.rows.assign(values.begin() + snapshot.first_row, values.begin() + end);
+    m_snapshots.publish();
+}
+
+void Simulation::fetch_snapshot()
+{
+    if(!m_snapshots.fetch(&m_previous))
+        return;
+
+    Snapshot const& snapshot = m_snapshots.get_front();
+    if(snapshot.first_row == 0 && m_display_stats->get_elapsed_time() >= 0)
+        m_display_stats->reset();
+    for(int i = 0; i < snapshot.rows.size(); i++)
+        if(snapshot.first_row + i == m_display_stats->get_elapsed_time() + 1)
+            m_display_stats->update(snapshot.rows[i], (snapshot.first_row + i) * 1000);
+    m_received_rows = m_display_stats->get_elapsed_time() + 1;
 }
 
 void Simulation::render()
 {
+    PROFILE_ZONE("Simulation::render");
+    m_display_stats->update_fps();
     SDL_SetRenderDrawColor(m_renderer, 128, 128, 128, 255);
     SDL_RenderClear(m_renderer);
+
+    SDL_Rect area = {0, 0, 0, 0}; //nothing to copy when nothing is displayed
     if(m_render)
     {
-        m_camera->update(*m_population, m_winsize);
-        m_map->render(m_renderer, m_winsize, *m_camera);
-        m_population->render(m_renderer, m_winsize, *m_camera);
+        //the display is one snapshot late, so that the animals move smoothly from the previous one to the last one
+        Snapshot const& snapshot = m_snapshots.get_front();
+        double progress = 1;
+        if(snapshot.ticks > m_previous.ticks)
+            progress = std::max(0.0, std::min(1.0, double(SDL_GetTicks() - snapshot.ticks) / (snapshot.ticks - m_previous.ticks)));
+
+        m_camera->update(snapshot, m_previous, progress, m_winsize);
+        {
+            PROFILE_ZONE("Map::render");
+            m_map->render(m_renderer, m_winsize, *m_camera, snapshot);
+        }
+        {
+            PROFILE_ZONE("Population::render");
+            m_population->render(m_renderer, m_winsize, *m_camera, snapshot, m_previous, progress);
+        }
+
+        //the view of the camera and half of it on each side, for the moves before the next snapshot
+        double zoom = m_camera->get_zoom();
+        int width = m_winsize.x / zoom + 2, height = m_winsize.y / zoom + 2;
+        area.x = int(std::floor(m_camera->get_position().x / zoom)) - width / 2;
+        area.y = int(std::floor(m_camera->get_position().y / zoom)) - height / 2;
+        area.w = width * 2;
+        area.h = height * 2;
+    }
+    {
+        std::lock_guard <std::mutex> lock(m_area_mutex);
+        m_area = area;
     }
-    m_stats->render(m_renderer, m_winsize);
+    {
+        PROFILE_ZONE("Stats::render");
+        m_display_stats->set_speed(m_speed->get_speed(), m_speed->get_target());
+        m_display_stats->render(m_renderer, m_winsize);
+    }
+    m_hud->render(m_renderer, m_winsize);
+    PROFILE_ZONE("SDL_RenderPresent");
     SDL_RenderPresent(m_renderer);
 }
 
 bool Simulation::process_events()
 {
+    PROFILE_ZONE("Simulation::process_events");
     SDL_Event event;
     while(SDL_PollEvent(&event))
     {
@@ -115,14 +330,13 @@ bool Simulation::process_events()
         case SDL_MOUSEBUTTONDOWN:
             if(event.button.button == SDL_BUTTON_LEFT)
             {
-                m_camera->focus_on_animal(*m_population, *m_stats, m_mousepos);
+                int specie = m_camera->focus_on_animal(m_snapshots.get_front(), *m_display_stats, m_mousepos);
+                if(specie > 0)
+                    focus_on_specie(specie);
                 m_leftclick = true;
             }
             else if(event.button.button == SDL_BUTTON_RIGHT)
-            {
-                if(event.button.x < 100)
-                    m_stats->select_graph(m_mousepos);
-            }
+                m_display_stats->select_graph(m_mousepos); //the list of the stats on the left, or the distribution
             break;
 
         case SDL_MOUSEBUTTONUP:
@@ -145,9 +359,11 @@ bool Simulation::process_events()
 
         case SDL_KEYDOWN:
             if(event.key.keysym.sym == SDLK_i)
-                m_stats->show_hide_data();
+                m_display_stats->show_hide_data();
             else if(event.key.keysym.sym == SDLK_g)
-                m_stats->show_hide_graph();
+                m_display_stats->show_hide_graph();
+            else if(event.key.keysym.sym == SDLK_d)
+                m_display_stats->show_hide_distribution();
             else if(event.key.keysym.sym == SDLK_r)
                 m_render = !m_render;
             else if(event.key.keysym.sym == SDLK_p)
@@ -155,21 +371,69 @@ bool Simulation::process_events()
             else if(event.key.keysym.sym == SDLK_b)
                 m_population->show_hide_bubble();
             else if(event.key.keysym.sym == SDLK_KP_PLUS || event.key.keysym.sym == SDLK_UP)
-                change_simulation_speed(true);
+                m_speed->change_target(true);
             else if(event.key.keysym.sym == SDLK_KP_MINUS || event.key.keysym.sym == SDLK_DOWN)
-                change_simulation_speed(false);
+                m_speed->change_target(false);
             else if(event.key.keysym.sym == SDLK_DELETE)
-                m_stats->hide_all_graph();
+                m_display_stats->hide_all_graph();
             else if(event.key.keysym.sym == SDLK_s)
                 m_population->show_hide_blood();
+            else if(event.key.keysym.sym == SDLK_h)
+                m_hud->show_hide();
+            else if(event.key.keysym.sym == SDLK_LEFT && m_replay)
+                m_seek -= REPLAY_SEEK;
+            else if(event.key.keysym.sym == SDLK_RIGHT && m_replay)
+                m_seek += REPLAY_SEEK;
+            else if(event.key.keysym.sym == SDLK_F5 && !m_replay) //a replay has nothing to save
+            {
+                std::unique_lock <std::mutex> lock = lock_world();
+                if(!save_checkpoint(get_checkpoint_name()))
+                    SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Erreur de sauvegarde", "Une erreur est survenue durant la sauvegarde", NULL);
+            }
+            else if(event.key.keysym.sym == SDLK_F6)
+            {
+                std::string name = m_settings.trace.empty() ? m_settings.directory + "//trace_" + std::to_string(m_settings.id) + ".json" : m_settings.trace;
+                if(!Profiler::write_trace(name))
+                    SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Erreur de sauvegarde", "Le profil n'a pas pu etre enregistre", NULL);
+            }
             break;
         }
     }
     return true;
 }
 
+std::unique_lock <std::mutex> Simulation::lock_world()
+{
+    m_world_wanted = true;
+    std::unique_lock <std::mutex> lock(m_world_mutex);
+    m_world_wanted = false;
+    return lock;
+}
+
+void Simulation::focus_on_specie(int specie) //the display only knows the animals of the snapshot, the first one of the specie is searched in the world
+{
+    std::unique_lock <std::mutex> lock = lock_world();
+    if(m_replay)
+    {
+        int id = 0;
+        Vector2d pos;
+        bool found = m_replay->find_animal(specie, id, pos);
+        m_camera->set_focus(id);
+        if(found)
+            m_camera->center_on(pos, m_winsize);
+        return;
+    }
+    Animal *animal = m_population->get_animal(specie);
+    m_camera->set_focus(animal ? animal->get_id() : 0);
+    if(animal)
+        m_camera->center_on(animal->get_position(), m_winsize);
+}
+
 bool Simulation::confirm_exit()
 {
+    if(m_replay) //the results are those of the recording
+        return true;
+
     const SDL_MessageBoxButtonData buttons[] = {
         { SDL_MESSAGEBOX_BUTTON_ESCAPEKEY_DEFAULT, 0, "annuler" },
         {                                       0, 1, "non" },
@@ -194,6 +458,7 @@ bool Simulation::confirm_exit()
     case -1: case 0:
         return false;
     case 2:
+        std::unique_lock <std::mutex> lock = lock_world();
         if(!m_stats->save(m_settings.directory, m_settings.id))
         {
             SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Fermeture impossible", "Une erreur est survenue durant la sauvegarde", NULL);
@@ -211,25 +476,68 @@ bool Simulation::check_status()
     bool has_finished = m_stats->has_finished(m_settings.duration);
     bool has_failed = m_stats->has_failed();
     int percent = m_stats->get_percent(m_settings.duration);
-    save_status(percent, has_failed);
+    publish_status(percent, has_failed, has_finished);
     if((m_settings.stopOnFailure && has_failed) || has_finished) //simulation failure or completed
     {
         if((m_settings.saveOnFailure && has_failed && (percent > m_settings.minFailureSave)) || has_finished) //failure and save still or completed
         {
-            while(!m_stats->save(m_settings.directory, m_settings.id))
-                SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Fermeture impossible", "Une erreur est survenue durant la sauvegarde", NULL);
+            if(!m_stats->save(m_settings.directory, m_settings.id))
+                m_save_failed = true; //the message box is shown by the display once this thread has stopped
         }
         return false;
     }
     return true;
 }
 
-void Simulation::save_status(int percent, bool has_failed)
+std::string Simulation::get_checkpoint_name() const
+{
+    return m_settings.directory + "//checkpoint_" + std::to_string(m_settings.id) + ".bin";
+}
+
+bool Simulation::save_checkpoint(std::string const& file_name) const //saves the whole state of the simulation to continue it later
+{
+    return m_world->save_checkpoint(file_name);
+}
+
+bool Simulation::load_checkpoint(std::string const& file_name)
 {
+    m_camera->set_focus(0);
+    return m_world->load_checkpoint(file_name);
+}
+
+void Simulation::publish_status(int percent, bool has_failed, bool has_finished)
+{
+    unsigned int now = SDL_GetTicks();
+    bool last = has_finished || (m_settings.stopOnFailure && has_failed); //the final status is always published
+    if(!m_status.is_due(now) && !last)
+        return;
+
+    StatusData data;
+    memset(&data, 0, sizeof(StatusData));
+    data.percent = percent;
+    data.failed = has_failed;
+    data.finished = has_finished;
+    data.elapsed_time = std::max(0, m_stats->get_elapsed_time());
+    if(now > m_status_time)
+        data.steps_per_second = 1000.0 * (m_steps - m_status_steps) / (now - m_status_time);
+
+    //the populations of the last sample of the stats (no need to count the animals again)
+    std::vector < std::vector <int> > const& values = m_stats->get_values();
+    data.species_number = m_scenario.get_species_number();
+    for(int i = 0; i < data.species_number && !values.empty(); i++)
+    {
+        data.total += values.back()[i];
+        if(i < STATUS_MAX_SPECIES)
+            data.population[i] = values.back()[i];
+    }
+
+    m_status.publish(data, now);
+    m_status_steps = m_steps;
+
+    //the text status still read by the launcher, at the same limited rate
     std::ofstream file("status_" + std::to_string(m_settings.id) + ".txt");
     if(file)
-    {
         file << percent << ";" << has_failed << std::endl;
-    }
-    file.close();
+
+    m_status_time = now;
 }
\ No newline at end of file
@@ -3,18 +3,43 @@
 
 #include <SDL2/SDL.h>
 #include <map>
+#include <thread>
+#include <mutex>
+#include <atomic>
 #include "Map.hpp"
 #include "Population.hpp"
 #include "Camera.hpp"
 #include "Stats.hpp"
+#include "Scenario.hpp"
+#include "World.hpp"
+#include "Status.hpp"
+#include "Hud.hpp"
+#include "Snapshot.hpp"
+#include "TripleBuffer.hpp"
+#include "SpeedController.hpp"
+#include "Replay.hpp"
 
 struct Settings
 {
     int id, duration, speed, minFailureSave;
     bool stopOnFailure, saveOnFailure, hide;
     std::string directory;
+    std::string scenario; //settings directory or compiled scenario
+    std::string checkpoint; //checkpoint to restore at the start (empty for a new simulation)
+    int checkpointInterval; //simulated seconds between two automatic checkpoints (0 to disable)
+    int statusRate; //maximum number of status updates per second for the launcher
+    uint64_t seed; //the same seed always gives the same simulation
+    std::string trace; //file of the profile written at the end (empty for none)
+    int threads; //threads simulating the animals
+    int step; //simulated ms per step, whatever the speed
+    std::string record; //event log written during the simulation (empty for none)
+    int keyframes; //simulated seconds between two keyframes of the event log
+    std::string replay; //event log played instead of simulating (empty for a simulation)
 };
 
+//the world is simulated by its own thread, which publishes after each step a snapshot of what the camera sees
+//the main thread only displays the last snapshot and handles the events: a slow display never slows the simulation down, and the reverse
+//in a replay the thread plays an event log instead of simulating, the display does not see the difference
 class Simulation
 {
 public:
@@ -23,13 +48,22 @@ public:
 
     void execute();
     bool get_error() const;
+    void simulate(); //loop of the thread of the simulation
     void update();
+    void publish_snapshot();
+    void fetch_snapshot();
     void render();
     bool process_events();
+    void focus_on_specie(int specie);
+    std::unique_lock <std::mutex> lock_world(); //for the display: the simulation hands the world over at the end of its frame
 
     bool confirm_exit();
     bool check_status();
-    void save_status(int percent, bool has_failed);
+    void publish_status(int percent, bool has_failed, bool has_finished);
+
+    bool save_checkpoint(std::string const& file_name) const;
+    bool load_checkpoint(std::string const& file_name);
+    std::string get_checkpoint_name() const;
 
 private:
     SDL_Window *m_window;
@@ -39,12 +73,42 @@ private:
     int m_leftclick;
     SDL_Point m_mousepos;
     bool m_render;
-    bool m_paused;
-    
+    std::atomic <bool> m_paused;
+    bool m_error;
+
+    int m_last_checkpoint;
+
+    StatusPublisher m_status;
+    int m_steps; //number of simulation steps since the start
+    int m_status_steps;
+    unsigned int m_status_time;
+
+    std::thread m_thread;
+    std::mutex m_world_mutex; //held by the simulation during each step, and by the display when it needs the world itself (checkpoint, search of an animal)
+    std::atomic <bool> m_world_wanted; //the display waits for m_world_mutex, the simulation does not take it again before
+    std::atomic <bool> m_stop; //asked by the display
+    std::atomic <bool> m_finished; //the simulation has completed or failed
+    std::atomic <bool> m_save_failed; //the stats could not be saved at the end of the simulation
+
+    TripleBuffer <Snapshot> m_snapshots;
+    Snapshot m_previous; //the snapshot displayed before the front one, to interpolate between them
+    std::mutex m_area_mutex;
+    SDL_Rect m_area; //blocks copied in the snapshots: what the camera sees and a margin around
+    std::atomic <int> m_received_rows; //rows of stats received by the display
+    SpeedController *m_speed;
+    Stats *m_display_stats; //copy of the stats of the world built from the snapshots, with its own choice of graphs
+    Replay *m_replay; //NULL for a simulation
+    std::atomic <int> m_seek; //simulated ms asked by the display to move the replay
+
     const Settings m_settings;
 
+    Scenario m_scenario;
+    World *m_world;
+
+    //parts of the world
     Map *m_map;
     Camera *m_camera;
+    Hud *m_hud;
     Population *m_population;
     Stats *m_stats;
 };
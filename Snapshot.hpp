@@ -0,0 +1,66 @@
+#ifndef DEF_SNAPSHOT
+#define DEF_SNAPSHOT
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include <algorithm>
+#include "Animal.hpp"
+
+struct AnimalSnapshot //what the display needs of an animal
+{
+    int id;
+    Vector2d pos;
+    int specie, color, animation, direction;
+    int health;
+    bool male;
+};
+
+struct StainSnapshot
+{
+    Vector2d pos;
+    int alpha; //fades until the stain disappears
+};
+
+//state of the world published by the simulation thread for the display thread, never changed once published
+//only the area around what the camera sees is copied, so that the cost follows the screen and not the size of the world
+struct Snapshot
+{
+    Snapshot(): time(0), ticks(0), steps(0), animals_number(0), first_row(0)
+    {
+        area = {0, 0, 0, 0};
+    }
+
+    AnimalSnapshot const* get_animal(int id) const //NULL if the animal is not in the area
+    {
+        std::vector <AnimalSnapshot>::const_iterator found = std::lower_bound(animals.begin(), animals.end(), id, [](AnimalSnapshot const& animal, int id)
+        {
+            return animal.id < id;
+        });
+        return (found != animals.end() && found->id == id) ? &*found : NULL;
+    }
+
+    Vector2d get_position(AnimalSnapshot const& animal, Snapshot const& previous, double progress) const //between its position in the previous snapshot (0) and in this one (1)
+    {
+        AnimalSnapshot const* before = previous.get_animal(animal.id);
+        if(!before)
+            return animal.pos;
+        Vector2d pos = {before->pos.x + (animal.pos.x - before->pos.x) * progress, before->pos.y + (animal.pos.y - before->pos.y) * progress};
+        return pos;
+    }
+
+    int time; //simulated time in ms
+    unsigned int ticks; //SDL_GetTicks() at the publication, to interpolate the positions between two snapshots
+    int steps; //simulation steps since the start
+    int animals_number; //all the animals of the world
+
+    SDL_Rect area; //blocks copied from the world
+    std::vector <unsigned char> biomes; //biome of each column of the area
+    std::vector <unsigned char> resources; //resource of each block of the area, row after row
+    std::vector <AnimalSnapshot> animals; //animals of the area, sorted by id
+    std::vector <StainSnapshot> stains; //stains of the area
+
+    int first_row; //time of the first row of stats
+    std::vector < std::vector <int> > rows; //rows of the stats which the display has not received yet (a skipped snapshot must not lose any)
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include "SpeedController.hpp"
+
+SpeedController::SpeedController(int step, int budget): m_step(std::max(1, step)), m_budget(budget), m_target(1), m_speed(0)
+{
+    m_last_frame = Clock::now();
+    m_frame_start = m_last_frame;
+    m_step_start = m_last_frame;
+    m_owed = 0;
+    m_frame_steps = 0;
+    m_step_cost = 0;
+    m_last_measure = m_last_frame;
+    m_simulated = 0;
+}
+
+void SpeedController::set_target(int target)
+{
+    m_target = std::max(0, std::min(target, SPEED_LIMIT));
+}
+
+void SpeedController::change_target(bool increase)
+{
+    int target = m_target;
+    if(increase && target != SPEED_MAXIMUM)
+        m_target = target < SPEED_LIMIT ? target + 1 : SPEED_MAXIMUM;
+    else if(!increase && target == SPEED_MAXIMUM)
+        m_target = SPEED_LIMIT;
+    else if(!increase && target > 1)
+        m_target = target - 1;
+}
+
+int SpeedController::get_target() const
+{
+    return m_target;
+}
+
+double SpeedController::get_speed() const
+{
+    return m_speed;
+}
+
+int SpeedController::get_step() const
+{
+    return m_step;
+}
+
+double SpeedController::get_milliseconds(Clock::time_point since) const
+{
+    return std::chrono::duration <double, std::milli>(Clock::now() - since).count();
+}
+
+void SpeedController::begin_frame()
+{
+    double elapsed = std::min(get_milliseconds(m_last_frame), 500.0); //a frozen window (moved, resized...) is not caught up
+    m_last_frame = Clock::now();
+    m_frame_start = m_last_frame;
+    m_step_start = m_last_frame;
+    m_frame_steps = 0;
+    if(m_target != SPEED_MAXIMUM)
+        m_owed += elapsed * m_target;
+}
+
+bool SpeedController::is_step_due() const
+{
+    if(m_target != SPEED_MAXIMUM && m_owed < m_step)
+        return false;
+    return m_frame_steps == 0 || get_milliseconds(m_frame_start) + m_step_cost <= m_budget;
+}
+
+void SpeedController::end_step()
+{
+    double cost = get_milliseconds(m_step_start);
+    m_step_cost = m_step_cost > 0 ? 0.9 * m_step_cost + 0.1 * cost : cost;
+    m_step_start = Clock::now();
+    m_frame_steps += 1;
+    m_simulated += m_step;
+    if(m_target != SPEED_MAXIMUM)
+        m_owed -= m_step;
+}
+
+void SpeedController::end_frame()
+{
+    m_owed = std::min<double>(m_owed, m_step); //only a part of a step is carried over
+
+    double elapsed = get_milliseconds(m_last_measure);
+    if(elapsed >= 1000)
+    {
+        m_speed = m_simulated / elapsed;
+        m_simulated = 0;
+        m_last_measure = Clock::now();
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef DEF_SPEEDCONTROLLER
+#define DEF_SPEEDCONTROLLER
+
+#include <atomic>
+#include <chrono>
+
+static const int SPEED_MAXIMUM = 0; //target of a simulation as fast as possible
+static const int SPEED_LIMIT = 100; //highest target before the maximum
+
+//speed of a simulation followed in real time: the world always advances by steps of the same simulated time,
+//the speed only changes how many steps are done each frame, so a faster simulation is the same simulation sooner
+//the steps owed are done as long as they fit in the budget of the frame (from the measured cost of a step), the others are dropped
+//the target is changed by the thread of the display, everything else is called by the thread of the simulation
+class SpeedController
+{
+public:
+    SpeedController(int step, int budget); //simulated ms of a step, real ms of a frame which the steps can use
+
+    void set_target(int target); //simulated seconds per second, SPEED_MAXIMUM for as many steps as the budget allows
+    void change_target(bool increase); //one more or one less, the maximum after SPEED_LIMIT
+    int get_target() const;
+    double get_speed() const; //simulated seconds per second reached during the last second
+    int get_step() const;
+
+    void begin_frame(); //the simulated time owed since the last frame
+    bool is_step_due() const; //a step is owed and fits in what is left of the budget (the first step of a frame is always done)
+    void end_step();
+    void end_frame(); //what could not be done in time is dropped, instead of making the next frames later and later
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    double get_milliseconds(Clock::time_point since) const;
+
+    int m_step;
+    int m_budget;
+    std::atomic <int> m_target;
+    std::atomic <double> m_speed;
+
+    Clock::time_point m_last_frame;
+    Clock::time_point m_frame_start;
+    Clock::time_point m_step_start;
+    double m_owed; //simulated ms
+    int m_frame_steps;
+    double m_step_cost; //real ms of a step, averaged over the last ones
+
+    Clock::time_point m_last_measure;
+    long long m_simulated; //simulated ms since the last measure of the speed
+};
+
+#endif
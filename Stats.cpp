@@ -3,6 +3,7 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <cstdio>
 
 #include <dirent.h>
 #ifndef WIN32
@@ -13,35 +14,45 @@
 
 #include "Animal.hpp"
 #include "Stats.hpp"
-#include "speed.hpp"
 #include "FileReader.hpp"
 #include <sstream>
 
-Stats::Stats()
+Stats::Stats(Scenario const& scenario, bool graphics)
 {
+    m_settings_directory = scenario.directory;
+    m_graphics = graphics;
+    m_font = NULL;
+
     m_show_graph = false;
     m_show_data = true;
+    m_show_distribution = false;
+    m_distribution_specie = -1;
+    m_distribution_origin = {0, 0};
 
     m_last_update = -1000; //needs to update the stats immediatly at the beginning
     m_elapsed_time = -1; //important too
     m_FPS = 0;
+    m_speed = 0;
+    m_speed_target = 1;
 
-    FileReader fr;
-    fr.read("settings//font.txt");
-    m_font = TTF_OpenFont("font.ttf", fr.getInt("size"));
-    m_color = {fr.getInt("red"), fr.getInt("green"), fr.getInt("blue")};
-    m_spacing = fr.getInt("spacing");
-
-    fr.read("settings//species_name.txt");
-    m_species_number = fr.getCount();
-    for(int i = 0; i < m_species_number; i++)
-        m_names.push_back(fr.getString("specie_" + std::to_string(i + 1)));
+    m_color = {255, 255, 255};
+    m_spacing = 20;
+    if(m_graphics)
+    {
+        FileReader fr;
+        fr.read("settings//font.txt");
+        m_font = TTF_OpenFont("font.ttf", fr.getInt("size"));
+        m_color = {fr.getInt("red"), fr.getInt("green"), fr.getInt("blue")};
+        m_spacing = fr.getInt("spacing");
+    }
 
-    fr.read("settings//resources_name.txt");
+    m_species_number = scenario.species_name.size();
+    m_names = scenario.species_name;
 
-    m_resources_number = fr.getCount();
-    for(int i = 0; i < m_resources_number; i++)
-        m_names.push_back(fr.getString("resource_" + std::to_string(i + 1)));
+    m_resources_number = scenario.resources_name.size();
+    m_names.insert(m_names.end(), scenario.resources_name.begin(), scenario.resources_name.end());
+    std::vector <std::string> distribution = get_distribution_names(scenario);
+    m_names.insert(m_names.end(), distribution.begin(), distribution.end());
 
     m_selected_graph.resize(m_names.size(), false);
     m_maximum_value.resize(m_names.size(), 0);
@@ -52,12 +63,13 @@ Stats::Stats()
 
 Stats::~Stats()
 {
-    TTF_CloseFont(m_font);
+    if(m_font)
+        TTF_CloseFont(m_font);
 }
 
 bool Stats::get_error() const
 {
-    if(!m_font)
+    if(m_graphics && !m_font)
     {
         SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Erreur de police", "font.ttf n'a pas pu etre ouvert", NULL);
         return true;
@@ -65,9 +77,8 @@ bool Stats::get_error() const
     return false;
 }
 
-void Stats::update(Population const& population, Map const& map)
+void Stats::update_fps() //once per frame
 {
-    
     m_render_time.insert(m_render_time.begin(), SDL_GetTicks() - m_last_frame);
     m_last_frame = SDL_GetTicks();
     if(m_render_time.size() > 10)
@@ -75,27 +86,46 @@ void Stats::update(Population const& population, Map const& map)
     int total_time = 0;
     for(int i = 0; i < m_render_time.size(); i++)
         total_time += m_render_time[i];
-    m_FPS = 1000.0/total_time*m_render_time.size();
-    regulate_simulation_speed(m_FPS);
+    m_FPS = total_time ? 1000.0/total_time*m_render_time.size() : 1000;
+}
 
-    if(SDL_GetTicks() - m_last_update >= 1000 / simulation_speed())
+void Stats::update(Population const& population, Map const& map, int now)
+{
+    if(now - m_last_update >= 1000)
     {
-        m_elapsed_time += 1;
-
-        //update the stats of all the differents species
-        m_values.push_back(std::vector <int>(m_resources_number + m_species_number));
+        //update the stats of all the differents species, the headcounts come with the distributions
+        std::vector <SpecieDistribution> distributions;
+        population.get_distributions(now, distributions);
+        std::vector <int> values(m_names.size());
         for(int specie = 0; specie < m_species_number; specie++)
-            m_values[m_elapsed_time][specie] = population.get_number(specie + 1);
+        {
+            values[specie] = distributions[specie].number;
+            distributions[specie].get_columns(&values[m_species_number + m_resources_number + specie * DISTRIBUTION_COLUMNS]);
+        }
 
         for(int resource = 0; resource < m_resources_number; resource++)
-            m_values[m_elapsed_time][resource + m_species_number] = map.get_number(resource + 1);
+            values[resource + m_species_number] = map.get_number(resource + 1);
+
+        update(values, now);
+    }
+}
+
+void Stats::update(std::vector <int> const& values, int now) //species then resources, counted elsewhere (for example by the processes of a cluster)
+{
+    if(now - m_last_update >= 1000)
+    {
+        m_elapsed_time += 1;
+        m_values.push_back(values);
+        m_values.back().resize(m_names.size()); //the distributions are 0 when they are not known (cluster)
 
         //update the maximum values
-        for(int i = 0; i < m_resources_number + m_species_number; i++)
+        for(int i = 0; i < m_names.size(); i++)
             if(m_values[m_elapsed_time][i] > m_maximum_value[i])
                 m_maximum_value[i] = m_values[m_elapsed_time][i];
 
-        m_last_update = SDL_GetTicks();
+        m_writer.append(m_elapsed_time, m_values[m_elapsed_time]);
+
+        m_last_update = now;
     }
 }
 
@@ -106,11 +136,15 @@ void Stats::render(SDL_Renderer *renderer, SDL_Point const& winsize)
         int line = 0;
         std::string text;
 
-        if(simulation_speed() == simulation_speed_target())
-            text = "vitesse: " + std::to_string(simulation_speed()) + "x";
+        char speed[64];
+        if(m_speed_target == 0)
+            snprintf(speed, sizeof(speed), "vitesse: %.1fx (maximum)", m_speed);
         else
-            text = "vitesse: " + std::to_string(simulation_speed()) + "x (cible: " + std::to_string(simulation_speed_target()) + "x)";
-        render_text(renderer, text, line);
+            snprintf(speed, sizeof(speed), "vitesse: %.1fx (cible: %dx)", m_speed, m_speed_target);
+        if(m_speed_target > 0 && m_speed < 0.9 * m_speed_target) //the steps take too long to reach the target
+            render_text(renderer, speed, line, m_color_warning);
+        else
+            render_text(renderer, speed, line);
 
         line += 1;
         text = std::to_string(m_elapsed_time / 3600) + "h " + std::to_string(m_elapsed_time % 3600 / 60) + "m " + std::to_string(m_elapsed_time % 60) + "s";
@@ -118,10 +152,7 @@ void Stats::render(SDL_Renderer *renderer, SDL_Point const& winsize)
 
         line += 1;
         text = std::to_string(m_FPS) + " FPS";
-        if(m_FPS < 2*simulation_speed()) //the simulation is running to slow
-            render_text(renderer, text, line, m_color_warning);
-        else
-            render_text(renderer, text, line);
+        render_text(renderer, text, line);
 
         line += 1;
         for(int i = 0; i < m_resources_number + m_species_number; i++)
@@ -149,7 +180,7 @@ void Stats::render(SDL_Renderer *renderer, SDL_Point const& winsize)
 
         for(int t = 1; t <= m_elapsed_time; t++)
         {
-            for(int i = 0; i < m_resources_number + m_species_number; i++)
+            for(int i = 0; i < m_names.size(); i++) //the columns of the distributions too
                 if(m_selected_graph[i])
                     SDL_RenderDrawLine(renderer, (1.0*winsize.x/m_elapsed_time)*(t-1), winsize.y - (1.0*winsize.y/maximum) * m_values[t-1][i], (1.0*winsize.x/m_elapsed_time)*t, winsize.y - (1.0*winsize.y/maximum) * m_values[t][i]);
         }
@@ -161,6 +192,55 @@ void Stats::render(SDL_Renderer *renderer, SDL_Point const& winsize)
             render_text(renderer, winsize, maximum, i);
         }
     }
+    m_distribution_specie = -1;
+    if(m_show_distribution && m_elapsed_time >= 0)
+        render_distribution(renderer, winsize);
+}
+
+void Stats::render_distribution(SDL_Renderer *renderer, SDL_Point const& winsize) //of the first specie whose graph is selected, or of the most numerous one
+{
+    std::vector <int> const& values = m_values[m_elapsed_time];
+    int specie = -1;
+    for(int i = 0; i < m_species_number && specie < 0; i++)
+        if(m_selected_graph[i])
+            specie = i;
+    if(specie < 0)
+    {
+        for(int i = 0; i < m_species_number; i++)
+            if(values[i] > 0 && (specie < 0 || values[i] > values[specie]))
+                specie = i;
+    }
+    if(specie < 0)
+        return;
+
+    int const* columns = &values[m_species_number + m_resources_number + specie * DISTRIBUTION_COLUMNS];
+    int number = std::max(1, values[specie]);
+    int width = 2 * DISTRIBUTION_BINS * 14 + 20, height = 80;
+    SDL_Point origin = {winsize.x - width - 10, winsize.y - height - 4 * m_spacing - 10};
+    m_distribution_specie = specie;
+    m_distribution_origin = origin;
+
+    render_text(renderer, m_names[specie] + ": " + std::to_string(values[specie]), origin);
+    render_text(renderer, "males " + std::to_string(100 * columns[DISTRIBUTION_MALES] / number) + "%  affames " + std::to_string(100 * columns[DISTRIBUTION_HUNGRY] / number)
+                + "%  prets " + std::to_string(100 * columns[DISTRIBUTION_READY] / number) + "%", {origin.x, origin.y + m_spacing});
+    render_text(renderer, "sante " + std::to_string(columns[DISTRIBUTION_HEALTH]) + " (+-" + std::to_string(columns[DISTRIBUTION_HEALTH_DEVIATION]) + ")  age "
+                + std::to_string(columns[DISTRIBUTION_AGE]) + "s (+-" + std::to_string(columns[DISTRIBUTION_AGE_DEVIATION]) + "s)", {origin.x, origin.y + 2 * m_spacing});
+
+    //the histograms of the health and of the age, side by side
+    int top = origin.y + 3 * m_spacing, bottom = top + height;
+    SDL_SetRenderDrawColor(renderer, m_color.r, m_color.g, m_color.b, 255);
+    for(int h = 0; h < 2; h++)
+    {
+        int const* bins = columns + (h == 0 ? DISTRIBUTION_HEALTH_BINS : DISTRIBUTION_AGE_BINS);
+        int left = origin.x + h * (DISTRIBUTION_BINS * 14 + 20);
+        for(int i = 0; i < DISTRIBUTION_BINS; i++)
+        {
+            SDL_Rect bar = {left + i * 14, bottom - height * bins[i] / number, 12, height * bins[i] / number};
+            SDL_RenderFillRect(renderer, &bar);
+        }
+        SDL_RenderDrawLine(renderer, left, bottom, left + DISTRIBUTION_BINS * 14, bottom);
+        render_text(renderer, h == 0 ? "sante" : "age", {left, bottom + 2});
+    }
 }
 
 void Stats::show_hide_data()
@@ -173,9 +253,14 @@ void Stats::show_hide_graph()
     m_show_graph = !m_show_graph;
 }
 
+void Stats::show_hide_distribution()
+{
+    m_show_distribution = !m_show_distribution;
+}
+
 void Stats::reset()
 {
-    m_last_update = SDL_GetTicks() - 1000;
+    m_last_update = -1000;
     m_elapsed_time = -1;
     m_maximum_value.assign(m_maximum_value.size(), 0);
     m_values.clear();
@@ -211,6 +296,16 @@ void Stats::render_text(SDL_Renderer *renderer, SDL_Point const& winsize, int ma
     SDL_DestroyTexture(texture);
 }
 
+void Stats::render_text(SDL_Renderer *renderer, std::string text, SDL_Point const& pos)
+{
+    SDL_Surface *surface = TTF_RenderText_Blended(m_font, text.c_str(), m_color);
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_Rect rect = {pos.x, pos.y, surface->w, surface->h};
+    SDL_RenderCopy(renderer, texture, NULL, &rect);
+    SDL_FreeSurface(surface);
+    SDL_DestroyTexture(texture);
+}
+
 bool Stats::save(std::string root, int id) //save the stats of the current simulation in a file
 {
     DIR *directory = 0;
@@ -262,15 +357,24 @@ bool Stats::save(std::string root, int id) //save the stats of the current simul
     std::ofstream file;
 
     struct dirent *content = NULL;
-    directory = opendir("settings");
-    seekdir(directory, 2);
-    while(content = readdir(directory))
+    directory = opendir(m_settings_directory.c_str());
+    if(!directory) //compiled scenario: the file itself is copied
+    {
+        buffer.open(m_settings_directory.c_str(), std::ios::binary);
+        file.open((folder_name + "//settings//scenario.bin").c_str(), std::ios::binary);
+        file << buffer.rdbuf();
+        file.close();
+        buffer.close();
+    }
+    else
+        seekdir(directory, 2);
+    while(directory && (content = readdir(directory)))
     {
         //converts to string
         std::ostringstream cv;
         cv << content->d_name;
 
-        name = "settings//" + cv.str();
+        name = m_settings_directory + "//" + cv.str();
         buffer.open(name.c_str());
         name = folder_name + "//settings//" + cv.str();
         file.open(name.c_str());
@@ -278,6 +382,8 @@ bool Stats::save(std::string root, int id) //save the stats of the current simul
         file.close();
         buffer.close();
     }
+    if(directory)
+        closedir(directory);
 
     //saves the stats of the simulation
     name = folder_name + "//stats.txt";
@@ -286,7 +392,7 @@ bool Stats::save(std::string root, int id) //save the stats of the current simul
     {
         //prints the name of differents values
         file << "TIME ";
-        for(int i = 0; i < m_names.size(); i++)
+        for(int i = 0; i < m_resources_number + m_species_number; i++) //the distributions are only in the stream
         {
             if(m_maximum_value[i])
                 file << m_names[i] << " ";
@@ -307,6 +413,20 @@ bool Stats::save(std::string root, int id) //save the stats of the current simul
     return false;
 }
 
+bool Stats::stream(std::string root, int id) //writes every sample in a binary file while the simulation runs (readable even if it never ends properly)
+{
+    #if defined(_WIN32)
+        mkdir(root.c_str());
+    #else
+        mkdir(root.c_str(), 0777);
+    #endif
+    if(!m_writer.open(root + "//stats_" + std::to_string(id) + ".bin", m_names, m_species_number + m_resources_number))
+        return false;
+    for(int t = 0; t <= m_elapsed_time; t++) //the history of a restored simulation
+        m_writer.append(t, m_values[t]);
+    return true;
+}
+
 int Stats::get_mouse_focus(SDL_Point const& mouse_pos) const //returnes which specie is targeted by the mouse
 {
     if(mouse_pos.x < 100)
@@ -328,7 +448,7 @@ int Stats::get_mouse_focus(SDL_Point const& mouse_pos) const //returnes which sp
 void Stats::select_graph(SDL_Point const& mouse_pos) //select which graph of population should be displayed in real time
 {
     int line = 3;
-    for(int graph = 0; graph < m_resources_number + m_species_number; graph++)
+    for(int graph = 0; graph < m_resources_number + m_species_number && mouse_pos.x < 100; graph++)
     {
         if(m_maximum_value[graph])
         {
@@ -340,6 +460,19 @@ void Stats::select_graph(SDL_Point const& mouse_pos) //select which graph of pop
                 m_selected_graph[graph] = !m_selected_graph[graph];
         }
     }
+
+    //the lines of the distribution shown select the curves of its columns: the males, the hungry and the ready ones, then the mean health and age
+    if(m_distribution_specie < 0 || mouse_pos.x < m_distribution_origin.x || mouse_pos.y < m_distribution_origin.y)
+        return;
+    int first = m_species_number + m_resources_number + m_distribution_specie * DISTRIBUTION_COLUMNS;
+    std::vector <int> columns;
+    if((mouse_pos.y - m_distribution_origin.y) / m_spacing == 1)
+        columns = {DISTRIBUTION_MALES, DISTRIBUTION_HUNGRY, DISTRIBUTION_READY};
+    else if((mouse_pos.y - m_distribution_origin.y) / m_spacing == 2)
+        columns = {DISTRIBUTION_HEALTH, DISTRIBUTION_AGE};
+    bool selected = !columns.empty() && !m_selected_graph[first + columns[0]];
+    for(int i = 0; i < columns.size(); i++)
+        m_selected_graph[first + columns[i]] = selected;
 }
 
 void Stats::hide_all_graph()
@@ -366,6 +499,70 @@ bool Stats::has_finished(int duration)
     return m_elapsed_time >= duration;
 }
 
+int Stats::get_elapsed_time() const
+{
+    return m_elapsed_time;
+}
+
+void Stats::set_speed(double speed, int target)
+{
+    m_speed = speed;
+    m_speed_target = target;
+}
+
+int Stats::get_FPS() const
+{
+    return m_FPS;
+}
+
+std::vector <std::string> const& Stats::get_names() const
+{
+    return m_names;
+}
+
+std::vector < std::vector <int> > const& Stats::get_values() const
+{
+    return m_values;
+}
+
+int Stats::get_columns_number(Scenario const& scenario)
+{
+    return scenario.get_species_number() + scenario.get_resources_number() + scenario.get_species_number() * DISTRIBUTION_COLUMNS;
+}
+
+void Stats::save_state(CheckpointWriter &cp, int now) const
+{
+    cp.add_value(int32_t(m_names.size()));
+    cp.add_value(int32_t(m_elapsed_time));
+    cp.add_value(int32_t(now - m_last_update));
+    cp.add(m_maximum_value.data(), m_maximum_value.size() * sizeof(int));
+    for(int t = 0; t <= m_elapsed_time; t++)
+        cp.add(m_values[t].data(), m_values[t].size() * sizeof(int));
+}
+
+bool Stats::load_state(CheckpointReader &cp, int now)
+{
+    int32_t columns = 0, elapsed_time = 0, since_last_update = 0;
+    if(!cp.read_value(columns) || !cp.read_value(elapsed_time) || !cp.read_value(since_last_update))
+        return false;
+    if(columns != m_names.size() || elapsed_time < -1) //the series must be the same to continue them
+        return false;
+
+    std::vector <int> maximum_value(columns);
+    std::vector < std::vector <int> > values(elapsed_time + 1, std::vector <int>(columns));
+    if(!cp.read(maximum_value.data(), columns * sizeof(int)))
+        return false;
+    for(int t = 0; t <= elapsed_time; t++)
+        if(!cp.read(values[t].data(), columns * sizeof(int)))
+            return false;
+
+    m_elapsed_time = elapsed_time;
+    m_last_update = now - since_last_update;
+    m_maximum_value.swap(maximum_value);
+    m_values.swap(values);
+    return true;
+}
+
 int Stats::get_percent(int duration)
 {
     if(duration == 0)
@@ -7,14 +7,20 @@
 #include <SDL2/SDL_ttf.h>
 #include "Population.hpp"
 #include "Map.hpp"
+#include "StatsWriter.hpp"
+#include "Checkpoint.hpp"
+#include "Scenario.hpp"
+#include "Distribution.hpp"
 
 class Stats
 {
 public:
-    Stats();
+    Stats(Scenario const& scenario, bool graphics = true); //without graphics (simulation without window), the font is not loaded
     ~Stats();
 
-    void update(class Population const& population, class Map const& map);
+    void update(class Population const& population, class Map const& map, int now);
+    void update(std::vector <int> const& values, int now); //a row of get_columns_number() values
+    void update_fps();
 
     void render(SDL_Renderer *rederer, SDL_Point const& winsize);
 
@@ -24,20 +30,36 @@ public:
     void reset();
 
     bool save(std::string root, int id);
+    bool stream(std::string root, int id);
 
     void show_hide_data();
     void show_hide_graph();
     void select_graph(SDL_Point const& mouse_pos);
     void hide_all_graph();
+    void show_hide_distribution();
 
     bool has_failed();
     bool has_finished(int duration);
     int get_percent(int duration);
+    int get_elapsed_time() const;
+    int get_FPS() const;
+    void set_speed(double speed, int target); //simulated seconds per second reached and wanted (0 for as fast as possible), shown with the data
+    std::vector <std::string> const& get_names() const;
+    std::vector < std::vector <int> > const& get_values() const;
+    static int get_columns_number(Scenario const& scenario); //the species, the resources, then the distribution of each specie
+
+    void save_state(CheckpointWriter &cp, int now) const;
+    bool load_state(CheckpointReader &cp, int now);
 
 private:
     void render_text(SDL_Renderer *renderer, std::string text, int line);
     void render_text(SDL_Renderer *renderer, std::string text, int line, SDL_Color color);
     void render_text(SDL_Renderer *renderer, SDL_Point const& winsize, int maximum, int line);
+    void render_text(SDL_Renderer *renderer, std::string text, SDL_Point const& pos);
+    void render_distribution(SDL_Renderer *renderer, SDL_Point const& winsize);
+
+    std::string m_settings_directory;
+    bool m_graphics;
 
     TTF_Font *m_font;
     SDL_Color m_color;
@@ -47,11 +69,16 @@ private:
     int m_elapsed_time;
     int m_last_update;
     int m_FPS;
+    double m_speed;
+    int m_speed_target;
     int m_last_frame;
     std::vector<int> m_render_time;
 
     bool m_show_graph;
     bool m_show_data;
+    bool m_show_distribution;
+    int m_distribution_specie; //shown by the last render, -1 for none
+    SDL_Point m_distribution_origin; //top left corner of the distribution on the screen
 
     std::vector <int> m_maximum_value;
     std::vector <bool> m_selected_graph;
@@ -61,6 +88,8 @@ private:
     int m_species_number;
 
     std::vector <std::string> m_names;
+
+    StatsWriter m_writer;
 };
 
 #endif
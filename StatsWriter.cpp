@@ -0,0 +1,213 @@
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include "StatsWriter.hpp"
+
+#ifndef WIN32
+    #include <unistd.h>
+#else
+    #include <io.h>
+#endif
+
+static const char STATS_MAGIC[8] = {'S', 'W', 'S', 'T', 'A', 'T', 'S', 0};
+static const int32_t STATS_VERSION = 2;
+
+StatsWriter::StatsWriter()
+{
+    m_file = NULL;
+    m_columns = 0;
+    m_sync_interval = 60;
+    m_unsynced = 0;
+    m_stop = false;
+}
+
+StatsWriter::~StatsWriter()
+{
+    close();
+}
+
+bool StatsWriter::open(std::string const& file_name, std::vector <std::string> const& names, int counts, int sync_interval)
+{
+    close();
+
+    m_file = std::fopen(file_name.c_str(), "wb");
+    if(!m_file)
+        return false;
+
+    m_columns = names.size();
+    m_sync_interval = std::max(1, sync_interval);
+    m_unsynced = 0;
+
+    //the header is written at once so that a stream is readable as soon as it has been opened
+    std::vector <unsigned char> header(STATS_MAGIC, STATS_MAGIC + sizeof(STATS_MAGIC));
+    write_int(header, STATS_VERSION);
+    write_int(header, m_columns);
+    write_int(header, std::min(counts, m_columns));
+    for(int i = 0; i < names.size(); i++)
+    {
+        write_int(header, names[i].size());
+        header.insert(header.end(), names[i].begin(), names[i].end());
+    }
+    std::fwrite(header.data(), 1, header.size(), m_file);
+    std::fflush(m_file);
+
+    m_stop = false;
+    m_thread = std::thread(&StatsWriter::run, this);
+    return true;
+}
+
+void StatsWriter::close()
+{
+    if(m_thread.joinable())
+    {
+        {
+            std::lock_guard <std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_condition.notify_one();
+        m_thread.join(); //the thread writes the remaining rows before leaving
+    }
+    if(m_file)
+    {
+        std::fclose(m_file);
+        m_file = NULL;
+    }
+}
+
+bool StatsWriter::is_open() const
+{
+    return m_file != NULL;
+}
+
+void StatsWriter::append(int time, std::vector <int> const& values)
+{
+    if(!m_file)
+        return;
+
+    {
+        std::lock_guard <std::mutex> lock(m_mutex);
+        m_pending.push_back(time);
+        for(int i = 0; i < m_columns; i++)
+            m_pending.push_back(i < values.size() ? values[i] : 0);
+    }
+    m_condition.notify_one();
+}
+
+void StatsWriter::run()
+{
+    std::vector <int32_t> rows;
+    std::vector <unsigned char> buffer;
+    bool stop = false;
+    while(!stop)
+    {
+        {
+            std::unique_lock <std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]{ return m_stop || !m_pending.empty(); });
+            rows.swap(m_pending);
+            stop = m_stop;
+        }
+
+        buffer.clear();
+        for(int i = 0; i < rows.size(); i++)
+            write_int(buffer, rows[i]);
+        if(buffer.size())
+            std::fwrite(buffer.data(), 1, buffer.size(), m_file);
+
+        m_unsynced += rows.size() / (m_columns + 1);
+        rows.clear();
+        if(m_unsynced >= m_sync_interval || stop) //makes sure the rows are on the disk (a crash only loses the last interval)
+        {
+            std::fflush(m_file);
+            #ifndef WIN32
+                fsync(fileno(m_file));
+            #else
+                _commit(_fileno(m_file));
+            #endif
+            m_unsynced = 0;
+        }
+    }
+}
+
+void StatsWriter::write_int(std::vector <unsigned char> &buffer, int32_t value) const //little-endian whatever the machine
+{
+    uint32_t bits = value;
+    for(int i = 0; i < 4; i++)
+        buffer.push_back((bits >> (8 * i)) & 0xFF);
+}
+
+static bool read_int(std::ifstream &file, int32_t &value)
+{
+    unsigned char bytes[4];
+    if(!file.read(reinterpret_cast<char*>(bytes), 4))
+        return false;
+    value = int32_t(uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24);
+    return true;
+}
+
+bool convert_stats_stream(std::string const& input, std::string const& output, bool all_series)
+{
+    std::ifstream file(input, std::ios::binary);
+    if(!file)
+        return false;
+
+    char magic[sizeof(STATS_MAGIC)];
+    int32_t version = 0, columns = 0, counts = 0;
+    if(!file.read(magic, sizeof(magic)) || memcmp(magic, STATS_MAGIC, sizeof(magic)) || !read_int(file, version) || version < 1 || version > STATS_VERSION || !read_int(file, columns) || columns < 0)
+        return false;
+    if(version == 1) //before the distributions, every series was in stats.txt
+        counts = columns;
+    else if(!read_int(file, counts) || counts < 0 || counts > columns)
+        return false;
+
+    std::vector <std::string> names(columns);
+    for(int i = 0; i < columns; i++)
+    {
+        int32_t length = 0;
+        if(!read_int(file, length) || length < 0)
+            return false;
+        names[i].resize(length);
+        if(length && !file.read(&names[i][0], length))
+            return false;
+    }
+
+    //reads every complete row (an interrupted run may have left half of the last one)
+    std::vector < std::vector <int32_t> > rows;
+    std::vector <int32_t> row(columns + 1);
+    bool complete = true;
+    while(complete)
+    {
+        for(int i = 0; i < columns + 1 && complete; i++)
+            complete = read_int(file, row[i]);
+        if(complete)
+            rows.push_back(row);
+    }
+
+    //same layout as Stats::save, the series that always stayed at 0 are left out
+    std::vector <bool> shown(columns, false);
+    for(int t = 0; t < rows.size(); t++)
+        for(int i = 0; i < (all_series ? columns : counts); i++)
+            if(rows[t][i + 1] > 0)
+                shown[i] = true;
+
+    std::ofstream text(output);
+    if(!text)
+        return false;
+
+    text << "TIME ";
+    for(int i = 0; i < columns; i++)
+        if(shown[i])
+            text << names[i] << " ";
+    text << std::endl;
+
+    for(int t = 0; t + 1 < rows.size(); t++) //without the last sample, like Stats::save
+    {
+        text << rows[t][0] << " ";
+        for(int i = 0; i < columns; i++)
+            if(shown[i])
+                text << rows[t][i + 1] << " ";
+        text << "\n";
+    }
+    return bool(text);
+}
@@ -0,0 +1,44 @@
+#ifndef DEF_STATSWRITER
+#define DEF_STATSWRITER
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//binary stats stream: "SWSTATS" magic, version, number of series, number of those in stats.txt (the first ones), the names of the series (length + characters)
+//then one row per sample: the time followed by one value per series, all as little-endian int32
+class StatsWriter
+{
+public:
+    StatsWriter();
+    ~StatsWriter();
+
+    bool open(std::string const& file_name, std::vector <std::string> const& names, int counts, int sync_interval = 60); //the first counts series are the ones of stats.txt
+    void close();
+    bool is_open() const;
+
+    void append(int time, std::vector <int> const& values); //queues the sample, the background thread writes it
+
+private:
+    void run();
+    void write_int(std::vector <unsigned char> &buffer, int32_t value) const;
+
+    std::FILE *m_file;
+    int m_columns;
+    int m_sync_interval; //number of rows between two fsync
+    int m_unsynced;
+
+    std::vector <int32_t> m_pending;
+    bool m_stop;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::thread m_thread;
+};
+
+bool convert_stats_stream(std::string const& input, std::string const& output, bool all_series = false); //writes the stats.txt equivalent of a stream (even a partial one), with all_series the distributions too
+
+#endif
@@ -0,0 +1,165 @@
+#include <string>
+#include <cstring>
+#include <fstream>
+#include "Status.hpp"
+
+#ifndef WIN32
+    #include <sys/types.h>
+    #include <sys/stat.h>
+    #include <sys/mman.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+StatusPublisher::StatusPublisher()
+{
+    m_block = NULL;
+    m_interval = 100;
+    m_last_publish = 0;
+    m_published = false;
+}
+
+StatusPublisher::~StatusPublisher()
+{
+    close();
+}
+
+bool StatusPublisher::open(std::string const& file_name, int rate)
+{
+    close();
+    m_file_name = file_name;
+    m_interval = rate > 0 ? 1000 / rate : 0;
+    m_published = false;
+
+#ifndef WIN32
+    int file = ::open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if(file < 0)
+        return false;
+    if(ftruncate(file, sizeof(StatusBlock)) != 0)
+    {
+        ::close(file);
+        return false;
+    }
+    void *mapping = mmap(NULL, sizeof(StatusBlock), PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    ::close(file); //the mapping stays valid
+    if(mapping == MAP_FAILED)
+        return false;
+    m_block = static_cast<StatusBlock*>(mapping);
+#else
+    m_block = new StatusBlock;
+#endif
+
+    memset(&m_block->data, 0, sizeof(StatusData));
+    m_block->sequence.store(0);
+    m_block->version = STATUS_VERSION;
+    m_block->magic = STATUS_MAGIC; //written last: the reader ignores the block until then
+    return true;
+}
+
+void StatusPublisher::close()
+{
+    if(!m_block)
+        return;
+#ifndef WIN32
+    munmap(m_block, sizeof(StatusBlock));
+#else
+    delete m_block;
+#endif
+    m_block = NULL;
+}
+
+bool StatusPublisher::is_due(unsigned int now) const
+{
+    return m_block && (!m_published || now - m_last_publish >= m_interval);
+}
+
+void StatusPublisher::publish(StatusData const& data, unsigned int now)
+{
+    if(!m_block)
+        return;
+
+    uint32_t sequence = m_block->sequence.load(std::memory_order_relaxed);
+    m_block->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&m_block->data, &data, sizeof(StatusData));
+    m_block->sequence.store(sequence + 2, std::memory_order_release);
+
+#ifdef WIN32
+    std::ofstream file(m_file_name.c_str(), std::ios::binary); //no shared mapping, the block is rewritten at the same (limited) rate
+    file.write(reinterpret_cast<char const*>(m_block), sizeof(StatusBlock));
+#endif
+
+    m_last_publish = now;
+    m_published = true;
+}
+
+StatusReader::StatusReader()
+{
+    m_block = NULL;
+}
+
+StatusReader::~StatusReader()
+{
+    close();
+}
+
+bool StatusReader::open(std::string const& file_name)
+{
+    close();
+    m_file_name = file_name;
+
+#ifndef WIN32
+    int file = ::open(file_name.c_str(), O_RDONLY);
+    if(file < 0)
+        return false;
+    struct stat info;
+    void *mapping = MAP_FAILED;
+    if(fstat(file, &info) == 0 && info.st_size >= sizeof(StatusBlock))
+        mapping = mmap(NULL, sizeof(StatusBlock), PROT_READ, MAP_SHARED, file, 0);
+    ::close(file);
+    if(mapping == MAP_FAILED)
+        return false;
+    m_block = static_cast<StatusBlock const*>(mapping);
+#else
+    m_buffer.resize(sizeof(StatusBlock));
+    m_block = reinterpret_cast<StatusBlock const*>(m_buffer.data());
+#endif
+    return true;
+}
+
+void StatusReader::close()
+{
+#ifndef WIN32
+    if(m_block)
+        munmap(const_cast<StatusBlock*>(m_block), sizeof(StatusBlock));
+#endif
+    m_block = NULL;
+}
+
+bool StatusReader::read(StatusData &data) const
+{
+    if(!m_block)
+        return false;
+
+#ifdef WIN32
+    std::ifstream file(m_file_name.c_str(), std::ios::binary);
+    if(!file.read(reinterpret_cast<char*>(m_buffer.data()), m_buffer.size()))
+        return false;
+#endif
+
+    if(m_block->magic != STATUS_MAGIC || m_block->version != STATUS_VERSION)
+        return false;
+
+    //retries as long as the simulation was writing during the copy
+    for(int attempts = 0; attempts < 1000; attempts++)
+    {
+        uint32_t before = m_block->sequence.load(std::memory_order_acquire);
+        if(before & 1)
+            continue;
+        memcpy(&data, &m_block->data, sizeof(StatusData));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(m_block->sequence.load(std::memory_order_relaxed) == before)
+            return before != 0;
+    }
+    return false;
+}
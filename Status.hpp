@@ -0,0 +1,72 @@
+#ifndef DEF_STATUS
+#define DEF_STATUS
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+//progress of a simulation launched by the launcher, published in the memory-mapped file status_X.bin
+//the launcher reads it with StatusReader, no file is rewritten while the simulation runs
+static const uint32_t STATUS_MAGIC = 0x53545753; //"SWTS"
+static const uint32_t STATUS_VERSION = 1;
+static const int STATUS_MAX_SPECIES = 64;
+
+struct StatusData
+{
+    int32_t percent;
+    int32_t failed;
+    int32_t finished;
+    int32_t elapsed_time; //simulated seconds
+    double steps_per_second;
+    int32_t total; //animals alive
+    int32_t species_number;
+    int32_t population[STATUS_MAX_SPECIES]; //animals alive of each specie (the first STATUS_MAX_SPECIES species)
+};
+
+struct StatusBlock
+{
+    uint32_t magic;
+    uint32_t version;
+    std::atomic <uint32_t> sequence; //seqlock: odd while the simulation is writing the data
+    StatusData data;
+};
+
+class StatusPublisher
+{
+public:
+    StatusPublisher();
+    ~StatusPublisher();
+
+    bool open(std::string const& file_name, int rate); //rate: maximum number of updates per second
+    void close();
+
+    bool is_due(unsigned int now) const; //true if the last update is older than 1/rate second
+    void publish(StatusData const& data, unsigned int now);
+
+private:
+    StatusBlock *m_block;
+    std::string m_file_name;
+    unsigned int m_interval; //ms
+    unsigned int m_last_publish;
+    bool m_published;
+};
+
+class StatusReader
+{
+public:
+    StatusReader();
+    ~StatusReader();
+
+    bool open(std::string const& file_name);
+    void close();
+
+    bool read(StatusData &data) const; //consistent copy of the last update (false if nothing has been published yet)
+
+private:
+    StatusBlock const* m_block;
+    mutable std::vector <unsigned char> m_buffer; //used instead of the mapping where mmap is not available
+    std::string m_file_name;
+};
+
+#endif
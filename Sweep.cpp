@@ -0,0 +1,415 @@
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <dirent.h>
+#ifndef WIN32
+    #include <sys/types.h>
+    #include <sys/stat.h>
+#endif
+#include "Sweep.hpp"
+#include "World.hpp"
+#include "FileReader.hpp"
+
+static void create_directory(std::string const& file_name) //of the file (one level, like the results folder of the stats)
+{
+    size_t end = file_name.find_last_of("/\\");
+    if(end == std::string::npos)
+        return;
+    std::string directory = file_name.substr(0, end);
+    #if defined(_WIN32)
+        mkdir(directory.c_str());
+    #else
+        mkdir(directory.c_str(), 0777);
+    #endif
+}
+
+Sweep::Sweep()
+{
+    m_duration = 0;
+    m_step = 100;
+    m_threads = 0;
+    m_stop_on_failure = false;
+    m_same_map = false;
+    m_finished = 0;
+    m_skipped = 0;
+}
+
+bool Sweep::load(std::string const& file_name)
+{
+    FileReader fr;
+    fr.read(file_name);
+
+    if(!m_base.load(fr.has("settings") ? fr.getString("settings") : "settings"))
+    {
+        for(int i = 0; i < m_base.get_errors().size(); i++)
+            std::cerr << m_base.get_errors()[i] << std::endl;
+        return false;
+    }
+    m_duration = fr.getInt("duration");
+    m_step = fr.has("step") ? fr.getInt("step") : 100;
+    m_threads = fr.has("threads") ? fr.getInt("threads") : 0;
+    m_stop_on_failure = fr.has("stop_on_failure") && fr.getInt("stop_on_failure");
+    m_same_map = fr.has("same_map") && fr.getInt("same_map");
+    m_output_name = fr.has("output") ? fr.getString("output") : "results//sweep.txt";
+    m_summary_name = fr.has("summary") ? fr.getString("summary") : "results//sweep_summary.txt";
+
+    //the seeds of the replicates: either listed, or "replicates" seeds starting at "seed"
+    std::vector <unsigned int> seeds;
+    if(fr.has("seeds"))
+    {
+        std::vector <double> values = fr.getVectorDouble("seeds");
+        for(int i = 0; i < values.size(); i++)
+            seeds.push_back(values[i]);
+    }
+    else
+    {
+        int first = fr.has("seed") ? fr.getInt("seed") : 1;
+        int replicates = fr.has("replicates") ? fr.getInt("replicates") : 1;
+        for(int i = 0; i < replicates; i++)
+            seeds.push_back(first + i);
+    }
+
+    //parameter_N=name with either values_N=a,b,c or from_N, to_N and step_N
+    m_parameters.clear();
+    for(int i = 1; fr.has("parameter_" + std::to_string(i)); i++)
+    {
+        std::string index = std::to_string(i);
+        SweepParameter parameter;
+        parameter.name = fr.getString("parameter_" + index);
+        if(fr.has("values_" + index))
+            parameter.values = fr.getVectorDouble("values_" + index);
+        else
+        {
+            double from = fr.getDouble("from_" + index), to = fr.getDouble("to_" + index), step = fr.getDouble("step_" + index);
+            for(int n = 0; step > 0 && from + n * step <= to + 1e-9; n++)
+                parameter.values.push_back(from + n * step);
+        }
+        if(parameter.values.empty())
+        {
+            std::cerr << file_name << ": " << parameter.name << " n'a aucune valeur" << std::endl;
+            return false;
+        }
+        m_parameters.push_back(parameter);
+    }
+
+    return prepare(seeds, file_name);
+}
+
+bool Sweep::load(int argc, char *argv[])
+{
+    std::string settings = "settings";
+    unsigned int first = 1;
+    int replicates = 0;
+    m_duration = 600;
+    m_same_map = true;
+    m_output_name = "results//ensemble.txt";
+    m_summary_name = "results//ensemble_summary.txt";
+    for(int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string option = argv[i], value = argv[i + 1];
+        try
+        {
+            if(option == "--replicates")
+                replicates = std::stoi(value);
+            else if(option == "--seed")
+                first = std::stoul(value);
+            else if(option == "--settings")
+                settings = value;
+            else if(option == "--duration")
+                m_duration = std::stoi(value);
+            else if(option == "--step")
+                m_step = std::stoi(value);
+            else if(option == "--threads")
+                m_threads = std::stoi(value);
+            else if(option == "--stop-on-failure")
+                m_stop_on_failure = std::stoi(value);
+            else if(option == "--same-map")
+                m_same_map = std::stoi(value);
+            else if(option == "--output")
+                m_output_name = value;
+            else if(option == "--summary")
+                m_summary_name = value;
+            else
+            {
+                std::cerr << "option inconnue : " << option << std::endl;
+                return false;
+            }
+        }
+        catch(std::exception const&) //std::stoi
+        {
+            std::cerr << "valeur invalide pour " << option << " : " << value << std::endl;
+            return false;
+        }
+    }
+    if(argc % 2 == 0)
+    {
+        std::cerr << "valeur manquante pour " << argv[argc - 1] << std::endl;
+        return false;
+    }
+    if(replicates <= 0 || m_duration <= 0 || m_step <= 0 || m_threads < 0)
+    {
+        std::cerr << "--replicates, --duration et --step doivent etre positifs" << std::endl;
+        return false;
+    }
+
+    if(!m_base.load(settings))
+    {
+        for(int i = 0; i < m_base.get_errors().size(); i++)
+            std::cerr << m_base.get_errors()[i] << std::endl;
+        return false;
+    }
+
+    std::vector <unsigned int> seeds;
+    for(int i = 0; i < replicates; i++)
+        seeds.push_back(first + i);
+    m_parameters.clear();
+    return prepare(seeds, "ensemble");
+}
+
+bool Sweep::prepare(std::vector <unsigned int> const& seeds, std::string const& source)
+{
+    if(m_duration <= 0 || m_step <= 0)
+    {
+        std::cerr << source << ": duration et step doivent etre positifs" << std::endl;
+        return false;
+    }
+    if(seeds.empty())
+    {
+        std::cerr << source << ": aucune graine" << std::endl;
+        return false;
+    }
+
+    //every combination of the values
+    int configurations_number = 1;
+    for(int i = 0; i < m_parameters.size(); i++)
+        configurations_number *= m_parameters[i].values.size();
+
+    m_configurations.assign(configurations_number, m_base);
+    m_configuration_values.assign(configurations_number, std::vector <double>(m_parameters.size()));
+    for(int c = 0; c < configurations_number; c++)
+    {
+        int rest = c;
+        for(int i = m_parameters.size() - 1; i >= 0; i--)
+        {
+            double value = m_parameters[i].values[rest % m_parameters[i].values.size()];
+            rest /= m_parameters[i].values.size();
+            m_configuration_values[c][i] = value;
+            if(!m_configurations[c].set(m_parameters[i].name, value))
+            {
+                std::cerr << source << ": le parametre " << m_parameters[i].name << " n'existe pas" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    m_runs.clear();
+    for(int c = 0; c < configurations_number; c++)
+        for(int s = 0; s < seeds.size(); s++)
+            m_runs.push_back({c, seeds[s]});
+    return true;
+}
+
+bool Sweep::run()
+{
+    create_directory(m_output_name);
+    create_directory(m_summary_name);
+    m_output.open(m_output_name);
+    if(!m_output)
+    {
+        std::cerr << m_output_name << " n'a pas pu etre ouvert" << std::endl;
+        return false;
+    }
+
+    //header: the identification of the run, then the same columns as stats.txt (without hiding the empty series)
+    m_output << "RUN CONFIGURATION SEED ";
+    for(int i = 0; i < m_parameters.size(); i++)
+        m_output << m_parameters[i].name << " ";
+    m_output << "TIME ";
+    for(int i = 0; i < m_base.species_name.size(); i++)
+        m_output << m_base.species_name[i] << " ";
+    for(int i = 0; i < m_base.resources_name.size(); i++)
+        m_output << m_base.resources_name[i] << " ";
+    m_output << std::endl;
+
+    m_moments.assign(m_configurations.size(), std::vector < std::vector <SweepMoments> >());
+    m_maps.assign(m_configurations.size(), std::vector <unsigned char>());
+    if(m_same_map)
+        run_workers(m_configurations.size(), [this](int configuration) { generate_map(configuration); });
+    run_workers(m_runs.size(), [this](int index) { run_simulation(index); });
+
+    m_output.close();
+    write_summary();
+    if(m_skipped)
+        std::cerr << m_skipped << " simulation(s) ignoree(s) sur " << m_runs.size() << std::endl;
+    return m_skipped == 0;
+}
+
+void Sweep::run_workers(int tasks, std::function<void(int)> const& task)
+{
+    int threads = m_threads > 0 ? m_threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<int>(threads, tasks);
+
+    std::atomic <int> next(0);
+    std::vector <std::thread> workers;
+    for(int t = 0; t < threads; t++)
+    {
+        workers.push_back(std::thread([tasks, &task, &next]()
+        {
+            for(int index = next++; index < tasks; index = next++)
+                task(index);
+        }));
+    }
+    for(int t = 0; t < workers.size(); t++)
+        workers[t].join();
+}
+
+void Sweep::generate_map(int configuration)
+{
+    //the seed of the first replicate, so that it simulates the same world as without the shared map
+    unsigned int seed = 0;
+    for(int i = 0; i < m_runs.size(); i++)
+    {
+        if(m_runs[i].configuration == configuration)
+        {
+            seed = m_runs[i].seed;
+            break;
+        }
+    }
+    World world(m_configurations[configuration], seed);
+    world.generate();
+    world.save_map(m_maps[configuration]);
+}
+
+void Sweep::run_simulation(int index)
+{
+    SweepRun const& run = m_runs[index];
+    World world(m_configurations[run.configuration], run.seed);
+    if(!m_same_map)
+        world.generate();
+    else if(!world.generate(m_maps[run.configuration]))
+    {
+        std::lock_guard <std::mutex> lock(m_output_mutex);
+        m_skipped += 1;
+        std::cerr << "simulation " << index + 1 << " : la carte de la configuration " << run.configuration + 1 << " n'a pas pu etre chargee, simulation ignoree" << std::endl;
+        return;
+    }
+
+    Stats &stats = world.get_stats();
+    while(!stats.has_finished(m_duration) && !(m_stop_on_failure && stats.has_failed()))
+        world.update(m_step);
+
+    write_results(index, world);
+}
+
+std::string Sweep::get_values_text(int configuration) const
+{
+    std::string text;
+    for(int i = 0; i < m_parameters.size(); i++)
+    {
+        std::string value = std::to_string(m_configuration_values[configuration][i]);
+        value.erase(value.find_last_not_of('0') + 1);
+        if(value[value.size() - 1] == '.')
+            value.erase(value.size() - 1);
+        text += value + " ";
+    }
+    return text;
+}
+
+void Sweep::write_results(int index, World &world)
+{
+    SweepRun const& run = m_runs[index];
+    std::vector < std::vector <int> > const& values = world.get_stats().get_values();
+    int columns = m_base.get_species_number() + m_base.get_resources_number(); //the columns of the header, without the distributions
+
+    //formatted before taking the lock so that the workers only wait for the write itself
+    std::string prefix = std::to_string(index + 1) + " " + std::to_string(run.configuration + 1) + " " + std::to_string(run.seed) + " " + get_values_text(run.configuration);
+
+    std::string text;
+    for(int t = 0; t < values.size(); t++)
+    {
+        text += prefix + std::to_string(t) + " ";
+        for(int i = 0; i < columns; i++)
+            text += std::to_string(values[t][i]) + " ";
+        text += "\n";
+    }
+
+    std::lock_guard <std::mutex> lock(m_output_mutex);
+    m_output << text;
+    m_output.flush();
+
+    //a series stopped by a failure keeps its last values until the end of the duration, so that every second has all the replicates
+    //(dropping them would only keep the replicates which have not failed yet, and bias the mean towards them)
+    std::vector < std::vector <SweepMoments> > &moments = m_moments[run.configuration];
+    int rows = values.empty() ? 0 : std::max<int>(values.size(), m_duration + 1);
+    if(moments.size() < rows)
+        moments.resize(rows, std::vector <SweepMoments>(columns, SweepMoments{0, 0, 0}));
+    for(int t = 0; t < rows; t++)
+    {
+        std::vector <int> const& row = values[std::min<int>(t, values.size() - 1)];
+        for(int i = 0; i < columns; i++)
+        {
+            SweepMoments &m = moments[t][i];
+            double delta = row[i] - m.mean;
+            m.number += 1;
+            m.mean += delta / m.number;
+            m.squares += delta * (row[i] - m.mean);
+        }
+    }
+
+    m_finished += 1;
+    std::cout << "simulation " << m_finished << "/" << m_runs.size() << " terminee" << std::endl;
+}
+
+static double get_student_quantile(int freedom) //t at 97.5% for the degrees of freedom, for a 95% confidence interval
+{
+    static const double quantiles[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131,
+                                       2.120, 2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if(freedom <= 30)
+        return quantiles[freedom - 1];
+    return 1.96 + 2.4 / freedom; //within 0.003 of the exact quantile beyond 30, 1.96 for a large number of replicates
+}
+
+void Sweep::write_summary()
+{
+    std::ofstream summary(m_summary_name);
+    if(!summary)
+    {
+        std::cerr << m_summary_name << " n'a pas pu etre ouvert" << std::endl;
+        return;
+    }
+
+    //each column is followed by the bounds of its 95% confidence interval (Student's t with n - 1 degrees of freedom, no width with a single replicate)
+    std::vector <std::string> names(m_base.species_name);
+    names.insert(names.end(), m_base.resources_name.begin(), m_base.resources_name.end());
+    summary << "CONFIGURATION ";
+    for(int i = 0; i < m_parameters.size(); i++)
+        summary << m_parameters[i].name << " ";
+    summary << "TIME REPLICATES ";
+    for(int i = 0; i < names.size(); i++)
+        summary << names[i] << " " << names[i] << "_low " << names[i] << "_high ";
+    summary << std::endl;
+
+    char number[32];
+    for(int c = 0; c < m_moments.size(); c++)
+    {
+        std::string prefix = std::to_string(c + 1) + " " + get_values_text(c);
+        for(int t = 0; t < m_moments[c].size(); t++)
+        {
+            std::vector <SweepMoments> const& moments = m_moments[c][t];
+            summary << prefix << t << " " << moments[0].number << " ";
+            for(int i = 0; i < moments.size(); i++)
+            {
+                double margin = moments[i].number > 1 ? get_student_quantile(moments[i].number - 1) * std::sqrt(moments[i].squares / (moments[i].number - 1) / moments[i].number) : 0;
+                snprintf(number, sizeof(number), "%.2f %.2f %.2f ", moments[i].mean, moments[i].mean - margin, moments[i].mean + margin);
+                summary << number;
+            }
+            summary << "\n";
+        }
+    }
+}
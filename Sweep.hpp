@@ -0,0 +1,73 @@
+#ifndef DEF_SWEEP
+#define DEF_SWEEP
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <fstream>
+#include <functional>
+#include "Scenario.hpp"
+
+struct SweepParameter
+{
+    std::string name; //for example "specie_3.speed"
+    std::vector <double> values;
+};
+
+struct SweepRun
+{
+    int configuration;
+    unsigned int seed;
+};
+
+struct SweepMoments //of one column at one second across the replicates, updated one replicate at a time
+{
+    int number;
+    double mean;
+    double squares; //sum of the squared deviations from the mean
+};
+
+//runs many simulations without window in the same process, one per configuration and seed
+//the configurations are every combination of the values of the parameters, their scenario is shared by all their replicates
+//an ensemble is a sweep without parameters: the replicates of the settings only, which can also start from the same map
+class Sweep
+{
+public:
+    Sweep();
+
+    bool load(std::string const& file_name);
+    bool load(int argc, char *argv[]); //ensemble given by the options of the command line
+    bool run();
+
+private:
+    bool prepare(std::vector <unsigned int> const& seeds, std::string const& source); //every configuration and the runs of their replicates
+    void run_workers(int tasks, std::function<void(int)> const& task); //on m_threads threads, each takes the next task until there is none left
+    void generate_map(int configuration);
+    void run_simulation(int index);
+    void write_results(int index, class World &world);
+    void write_summary();
+    std::string get_values_text(int configuration) const; //values of the parameters of the configuration
+
+    Scenario m_base;
+    std::vector <SweepParameter> m_parameters;
+    std::vector <Scenario> m_configurations;
+    std::vector < std::vector <double> > m_configuration_values;
+    std::vector <SweepRun> m_runs;
+
+    int m_duration; //simulated seconds
+    int m_step; //simulated ms per step
+    int m_threads;
+    bool m_stop_on_failure;
+    bool m_same_map; //the replicates of a configuration start from the map of its first seed, generated once
+    std::string m_output_name;
+    std::string m_summary_name;
+
+    std::vector < std::vector <unsigned char> > m_maps; //initial map of each configuration with m_same_map, only read by the runs
+    std::ofstream m_output;
+    std::mutex m_output_mutex;
+    int m_finished;
+    int m_skipped; //runs whose map could not be loaded (under m_output_mutex)
+    std::vector < std::vector < std::vector <SweepMoments> > > m_moments; //by configuration, second and column (under m_output_mutex)
+};
+
+#endif
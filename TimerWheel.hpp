@@ -0,0 +1,150 @@
+#ifndef DEF_TIMERWHEEL
+#define DEF_TIMERWHEEL
+
+#include <vector>
+#include <algorithm>
+
+//timers of a value due at a time in ms, in a hierarchical wheel of LEVELS levels of 2^BITS slots: the first level has a slot per ms,
+//each following one a slot per turn of the previous one, whose timers are moved down when the time reaches it
+//adding and removing a timer is O(1) and advancing the time only goes through the slots crossed and the timers due
+template <typename T, int BITS = 6, int LEVELS = 4>
+class TimerWheel
+{
+public:
+    static const int SLOTS = 1 << BITS;
+
+    TimerWheel(): m_now(0), m_size(0)
+    {
+        m_slots.assign(LEVELS * SLOTS, -1);
+    }
+
+    void reset(int now) //removes all the timers
+    {
+        m_timers.clear();
+        m_free.clear();
+        m_slots.assign(LEVELS * SLOTS, -1);
+        m_now = now;
+        m_size = 0;
+    }
+
+    int get_time() const
+    {
+        return m_now;
+    }
+
+    int size() const
+    {
+        return m_size;
+    }
+
+    int add(int due, T const& value) //returns the handle of the timer, a due time already past expires at the next advance
+    {
+        int handle;
+        if(m_free.empty())
+        {
+            handle = m_timers.size();
+            m_timers.push_back(Timer());
+        }
+        else
+        {
+            handle = m_free.back();
+            m_free.pop_back();
+        }
+        m_timers[handle].due = due;
+        m_timers[handle].value = value;
+        link(handle, m_now + 1); //the current slot has already expired
+        m_size += 1;
+        return handle;
+    }
+
+    void remove(int handle)
+    {
+        unlink(handle);
+        m_free.push_back(handle);
+        m_size -= 1;
+    }
+
+    template <typename F>
+    void advance(int now, F const& expire) //calls expire(value) for every timer due until now, the handles are free before the call
+    {
+        while(m_now < now)
+        {
+            m_now += 1;
+            for(int level = LEVELS - 1; level > 0; level--) //the slots of the upper levels reached by the time, from the highest
+                if((m_now & ((1 << (BITS * level)) - 1)) == 0)
+                    cascade(level);
+
+            int &slot = m_slots[m_now & (SLOTS - 1)];
+            if(slot < 0)
+                continue;
+            m_expired.clear();
+            for(int handle = slot; handle >= 0; handle = m_timers[handle].next)
+            {
+                m_expired.push_back(m_timers[handle].value);
+                m_free.push_back(handle);
+                m_size -= 1;
+            }
+            slot = -1;
+            for(int i = 0; i < m_expired.size(); i++) //may add timers
+                expire(m_expired[i]);
+        }
+    }
+
+private:
+    struct Timer
+    {
+        int due;
+        T value;
+        int slot; //index in m_slots
+        int prev, next; //in the list of the slot, -1 at the ends
+    };
+
+    void link(int handle, int earliest)
+    {
+        Timer &timer = m_timers[handle];
+        int due = std::max(timer.due, earliest);
+        int level = 0;
+        while(level < LEVELS - 1 && ((due ^ m_now) >> (BITS * (level + 1))) != 0) //the first level whose current turn contains the due time
+            level += 1;
+        timer.slot = level * SLOTS + ((due >> (BITS * level)) & (SLOTS - 1)); //further than the last level: comes back at the next turn
+
+        timer.prev = -1;
+        timer.next = m_slots[timer.slot];
+        if(timer.next >= 0)
+            m_timers[timer.next].prev = handle;
+        m_slots[timer.slot] = handle;
+    }
+
+    void unlink(int handle)
+    {
+        Timer const& timer = m_timers[handle];
+        if(timer.prev >= 0)
+            m_timers[timer.prev].next = timer.next;
+        else
+            m_slots[timer.slot] = timer.next;
+        if(timer.next >= 0)
+            m_timers[timer.next].prev = timer.prev;
+    }
+
+    void cascade(int level) //moves the timers of the current slot of a level to the lower ones
+    {
+        int &slot = m_slots[level * SLOTS + ((m_now >> (BITS * level)) & (SLOTS - 1))];
+        int handle = slot;
+        slot = -1;
+        while(handle >= 0)
+        {
+            int next = m_timers[handle].next;
+            link(handle, m_now); //before the current slot expires
+            handle = next;
+        }
+    }
+
+    std::vector <Timer> m_timers;
+    std::vector <int> m_free; //handles of the removed timers
+    std::vector <int> m_slots; //first timer of each slot, level after level
+    std::vector <T> m_expired;
+    int m_now;
+    int m_size;
+};
+
+#endif
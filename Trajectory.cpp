@@ -0,0 +1,288 @@
+#include <cstring>
+#include <algorithm>
+#include "Trajectory.hpp"
+#include "Population.hpp"
+#include "Profiler.hpp"
+
+#ifndef WIN32
+    #include <sys/types.h>
+    #include <sys/stat.h>
+    #include <sys/mman.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+static const int TRAJECTORY_BUFFERS = 4; //chunks in memory: one being filled, the others waiting for the thread
+
+//offsets of the columns in a chunk, after its header: time, id, x, y, health (4 bytes each), specie (2 bytes), flags (1 byte)
+static size_t get_column_offset(int column, uint32_t records)
+{
+    static const size_t sizes[] = {4, 4, 4, 4, 4, 2, 1};
+    size_t offset = sizeof(TrajectoryChunkHeader);
+    for(int i = 0; i < column; i++)
+        offset += sizes[i] * records;
+    return offset;
+}
+
+uint32_t get_trajectory_chunk_size(uint32_t records)
+{
+    return (get_column_offset(7, records) + 7) / 8 * 8;
+}
+
+TrajectoryWriter::TrajectoryWriter()
+{
+    m_interval = 1;
+    m_steps = 0;
+    m_chunk = NULL;
+    m_count = 0;
+    m_closing = false;
+    m_error = false;
+}
+
+TrajectoryWriter::~TrajectoryWriter()
+{
+    close();
+}
+
+bool TrajectoryWriter::open(std::string const& file_name, int species_number, int interval, std::vector <int> const& species)
+{
+    close();
+    m_file.open(file_name.c_str(), std::ios::binary | std::ios::trunc);
+    if(!m_file)
+        return false;
+
+    m_interval = std::max(1, interval);
+    m_steps = 0;
+    m_species.assign(species_number, species.empty());
+    for(int i = 0; i < species.size(); i++)
+        if(species[i] >= 1 && species[i] <= species_number)
+            m_species[species[i] - 1] = true;
+
+    TrajectoryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "SWTRAJ", 6);
+    header.version = TRAJECTORY_VERSION;
+    header.species_number = species_number;
+    header.interval = m_interval;
+    header.chunk_records = TRAJECTORY_CHUNK;
+    header.chunk_size = get_trajectory_chunk_size(TRAJECTORY_CHUNK);
+    if(!m_file.write(reinterpret_cast<char const*>(&header), sizeof(header)))
+        return false;
+
+    m_buffers.assign(TRAJECTORY_BUFFERS, std::vector <unsigned char>(header.chunk_size, 0));
+    m_free.clear();
+    for(int i = 1; i < m_buffers.size(); i++)
+        m_free.push_back(&m_buffers[i]);
+    m_queue.clear();
+    m_chunk = &m_buffers[0];
+    m_count = 0;
+    m_closing = false;
+    m_error = false;
+    m_thread = std::thread(&TrajectoryWriter::write_chunks, this);
+    return true;
+}
+
+void TrajectoryWriter::record(Population const& population, int now)
+{
+    if(!m_chunk || m_steps++ % m_interval != 0)
+        return;
+    PROFILE_ZONE("TrajectoryWriter::record");
+
+    std::vector <Animal*> const& animals = population.m_animals;
+    for(int i = 0; i < animals.size(); i++)
+    {
+        Animal const& animal = *animals[i];
+        int specie = animal.get_specie();
+        if(!m_species[specie - 1])
+            continue;
+
+        unsigned char *chunk = m_chunk->data();
+        TrajectoryChunkHeader &header = *reinterpret_cast<TrajectoryChunkHeader*>(chunk);
+        if(m_count == 0)
+            header.first_time = now;
+        header.last_time = now;
+
+        Vector2d pos = animal.get_position();
+        uint8_t flags = (animal.is_alive(now) ? TRAJECTORY_ALIVE : 0) | (animal.is_male() ? TRAJECTORY_MALE : 0) | (animal.is_hungry(now) ? TRAJECTORY_HUNGRY : 0);
+        reinterpret_cast<int32_t*>(chunk + get_column_offset(0, TRAJECTORY_CHUNK))[m_count] = now;
+        reinterpret_cast<int32_t*>(chunk + get_column_offset(1, TRAJECTORY_CHUNK))[m_count] = animal.get_id();
+        reinterpret_cast<float*>(chunk + get_column_offset(2, TRAJECTORY_CHUNK))[m_count] = pos.x;
+        reinterpret_cast<float*>(chunk + get_column_offset(3, TRAJECTORY_CHUNK))[m_count] = pos.y;
+        reinterpret_cast<int32_t*>(chunk + get_column_offset(4, TRAJECTORY_CHUNK))[m_count] = animal.get_health(now);
+        reinterpret_cast<uint16_t*>(chunk + get_column_offset(5, TRAJECTORY_CHUNK))[m_count] = specie;
+        reinterpret_cast<uint8_t*>(chunk + get_column_offset(6, TRAJECTORY_CHUNK))[m_count] = flags;
+        m_count += 1;
+        if(m_count == TRAJECTORY_CHUNK)
+            submit();
+    }
+}
+
+void TrajectoryWriter::submit()
+{
+    reinterpret_cast<TrajectoryChunkHeader*>(m_chunk->data())->count = m_count;
+    std::unique_lock <std::mutex> lock(m_mutex);
+    m_queue.push_back(m_chunk);
+    m_changed.notify_all();
+    m_changed.wait(lock, [this]
+    {
+        return !m_free.empty();
+    });
+    m_chunk = m_free.back();
+    m_free.pop_back();
+    m_count = 0;
+}
+
+void TrajectoryWriter::write_chunks()
+{
+    Profiler::set_thread_name("trajectoires");
+    std::unique_lock <std::mutex> lock(m_mutex);
+    while(true)
+    {
+        m_changed.wait(lock, [this]
+        {
+            return m_closing || !m_queue.empty();
+        });
+        if(m_queue.empty())
+            return;
+
+        std::vector <unsigned char> *chunk = m_queue.front();
+        m_queue.pop_front();
+        lock.unlock();
+        bool written = bool(m_file.write(reinterpret_cast<char const*>(chunk->data()), chunk->size()));
+        lock.lock();
+        m_error = m_error || !written;
+        m_free.push_back(chunk);
+        m_changed.notify_all();
+    }
+}
+
+void TrajectoryWriter::close()
+{
+    if(!m_chunk)
+        return;
+    if(m_count > 0)
+        submit();
+    {
+        std::lock_guard <std::mutex> lock(m_mutex);
+        m_closing = true;
+        m_changed.notify_all();
+    }
+    m_thread.join();
+    m_file.close();
+    m_chunk = NULL;
+    m_buffers.clear();
+    m_free.clear();
+}
+
+bool TrajectoryWriter::get_error() const
+{
+    return m_error;
+}
+
+TrajectoryReader::TrajectoryReader()
+{
+    m_data = NULL;
+    m_size = 0;
+    m_chunks = 0;
+    memset(&m_header, 0, sizeof(m_header));
+}
+
+TrajectoryReader::~TrajectoryReader()
+{
+    close();
+}
+
+bool TrajectoryReader::open(std::string const& file_name)
+{
+    close();
+#ifndef WIN32
+    int file = ::open(file_name.c_str(), O_RDONLY);
+    if(file < 0)
+        return false;
+    struct stat status;
+    if(fstat(file, &status) != 0 || status.st_size < sizeof(TrajectoryHeader))
+    {
+        ::close(file);
+        return false;
+    }
+    void *mapping = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, file, 0);
+    ::close(file); //the mapping stays valid
+    if(mapping == MAP_FAILED)
+        return false;
+    madvise(mapping, status.st_size, MADV_SEQUENTIAL);
+    m_data = static_cast<unsigned char const*>(mapping);
+    m_size = status.st_size;
+#else
+    std::ifstream file(file_name.c_str(), std::ios::binary);
+    m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if(m_buffer.size() < sizeof(TrajectoryHeader))
+        return false;
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#endif
+
+    memcpy(&m_header, m_data, sizeof(m_header));
+    if(memcmp(m_header.magic, "SWTRAJ", 6) || m_header.version != TRAJECTORY_VERSION || m_header.chunk_records == 0
+       || m_header.chunk_size != get_trajectory_chunk_size(m_header.chunk_records))
+    {
+        close();
+        return false;
+    }
+    m_chunks = (m_size - sizeof(TrajectoryHeader)) / m_header.chunk_size;
+    return true;
+}
+
+void TrajectoryReader::close()
+{
+#ifndef WIN32
+    if(m_data)
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+    m_buffer.clear();
+    m_data = NULL;
+    m_size = 0;
+    m_chunks = 0;
+}
+
+int TrajectoryReader::get_species_number() const
+{
+    return m_header.species_number;
+}
+
+int TrajectoryReader::get_interval() const
+{
+    return m_header.interval;
+}
+
+uint64_t TrajectoryReader::get_records_number() const
+{
+    uint64_t number = 0;
+    for(int i = 0; i < m_chunks; i++)
+        number += get_chunk(i).count;
+    return number;
+}
+
+int TrajectoryReader::get_chunks_number() const
+{
+    return m_chunks;
+}
+
+TrajectoryChunk TrajectoryReader::get_chunk(int index) const
+{
+    uint32_t records = m_header.chunk_records;
+    unsigned char const* data = m_data + sizeof(TrajectoryHeader) + size_t(index) * m_header.chunk_size;
+    TrajectoryChunkHeader const& header = *reinterpret_cast<TrajectoryChunkHeader const*>(data);
+
+    TrajectoryChunk chunk;
+    chunk.count = std::min(header.count, records);
+    chunk.first_time = header.first_time;
+    chunk.last_time = header.last_time;
+    chunk.time = reinterpret_cast<int32_t const*>(data + get_column_offset(0, records));
+    chunk.id = reinterpret_cast<int32_t const*>(data + get_column_offset(1, records));
+    chunk.x = reinterpret_cast<float const*>(data + get_column_offset(2, records));
+    chunk.y = reinterpret_cast<float const*>(data + get_column_offset(3, records));
+    chunk.health = reinterpret_cast<int32_t const*>(data + get_column_offset(4, records));
+    chunk.specie = reinterpret_cast<uint16_t const*>(data + get_column_offset(5, records));
+    chunk.flags = reinterpret_cast<uint8_t const*>(data + get_column_offset(6, records));
+    return chunk;
+}
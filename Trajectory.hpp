@@ -0,0 +1,120 @@
+#ifndef DEF_TRAJECTORY
+#define DEF_TRAJECTORY
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+//trajectories of the animals for the offline analyses: one record (time, id, position, health, specie, state) per animal and per recorded step
+//the file is a header followed by chunks of the same size, each holding a small header and then the records column after column,
+//so that a reader maps the file and scans only the columns it needs without parsing anything (little endian, like the machine writing it)
+static const int32_t TRAJECTORY_VERSION = 1;
+static const uint32_t TRAJECTORY_CHUNK = 65536; //records per chunk, about 1.5 MB
+
+enum TrajectoryFlag
+{
+    TRAJECTORY_ALIVE = 1, TRAJECTORY_MALE = 2, TRAJECTORY_HUNGRY = 4
+};
+
+struct TrajectoryHeader
+{
+    char magic[8]; //"SWTRAJ"
+    int32_t version;
+    int32_t species_number;
+    int32_t interval; //steps between two records of the animals
+    uint32_t chunk_records; //capacity of a chunk
+    uint32_t chunk_size; //bytes of a chunk, header included
+    uint32_t reserved;
+};
+
+struct TrajectoryChunkHeader
+{
+    uint32_t count; //records used, only the last chunk is not full
+    int32_t first_time, last_time; //simulated ms
+    uint32_t reserved;
+};
+
+//columns of a chunk of capacity records
+struct TrajectoryChunk
+{
+    uint32_t count;
+    int32_t first_time, last_time;
+    int32_t const* time; //simulated ms
+    int32_t const* id;
+    float const* x;
+    float const* y;
+    int32_t const* health;
+    uint16_t const* specie;
+    uint8_t const* flags; //TrajectoryFlag
+};
+
+uint32_t get_trajectory_chunk_size(uint32_t records);
+
+//appends the records of the animals to a trajectory file: World::update calls record() after each step
+//the records are copied in a chunk in memory and a full chunk is written in one piece by a thread of the writer, the simulation only waits for it
+//when all the chunks are waiting to be written
+class TrajectoryWriter
+{
+public:
+    TrajectoryWriter();
+    ~TrajectoryWriter(); //writes the last chunk
+
+    bool open(std::string const& file_name, int species_number, int interval, std::vector <int> const& species); //every interval steps, only the species given (all if empty)
+    void record(class Population const& population, int now);
+    void close();
+    bool get_error() const;
+
+private:
+    void submit(); //hands the current chunk to the thread
+    void write_chunks(); //loop of the thread
+
+    std::ofstream m_file;
+    int m_interval;
+    int m_steps;
+    std::vector <bool> m_species; //recorded species, by specie - 1
+
+    std::vector <unsigned char> *m_chunk; //being filled, NULL when the writer is closed
+    uint32_t m_count;
+    std::vector < std::vector <unsigned char> > m_buffers;
+    std::vector < std::vector <unsigned char>* > m_free;
+    std::deque < std::vector <unsigned char>* > m_queue; //full chunks, in order
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    bool m_closing;
+    std::atomic <bool> m_error; //a chunk could not be written, read by get_error() without the lock
+};
+
+//reads a trajectory file through a mapping of the whole file (read in memory where mmap is not available)
+//a chunk cut by the end of the simulation is ignored
+class TrajectoryReader
+{
+public:
+    TrajectoryReader();
+    ~TrajectoryReader();
+
+    bool open(std::string const& file_name);
+    void close();
+
+    int get_species_number() const;
+    int get_interval() const;
+    uint64_t get_records_number() const;
+    int get_chunks_number() const;
+    TrajectoryChunk get_chunk(int index) const;
+
+private:
+    unsigned char const* m_data;
+    size_t m_size;
+    std::vector <unsigned char> m_buffer; //used instead of the mapping where mmap is not available
+    TrajectoryHeader m_header;
+    int m_chunks;
+};
+
+#endif
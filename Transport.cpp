@@ -0,0 +1,160 @@
+#include <cstring>
+#include <cstdint>
+#include "Transport.hpp"
+
+#ifndef WIN32
+    #include <sys/types.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+SocketTransport::SocketTransport(int socket): m_socket(socket)
+{}
+
+SocketTransport::~SocketTransport()
+{
+    close();
+}
+
+void SocketTransport::close()
+{
+#ifndef WIN32
+    if(m_socket >= 0)
+        ::close(m_socket);
+#endif
+    m_socket = -1;
+}
+
+bool SocketTransport::create_pair(SocketTransport *&first, SocketTransport *&second)
+{
+#ifndef WIN32
+    int sockets[2];
+    if(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+        return false;
+    first = new SocketTransport(sockets[0]);
+    second = new SocketTransport(sockets[1]);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool SocketTransport::listen(std::string const& path, int connections, std::vector <Transport*> &transports)
+{
+#ifndef WIN32
+    struct sockaddr_un address;
+    if(path.size() >= sizeof(address.sun_path))
+        return false;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path.c_str());
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(server < 0)
+        return false;
+    unlink(path.c_str()); //left by a previous run
+    if(bind(server, (struct sockaddr*)&address, sizeof(address)) != 0 || ::listen(server, connections) != 0)
+    {
+        ::close(server);
+        return false;
+    }
+
+    for(int i = 0; i < connections; i++)
+    {
+        int client = accept(server, NULL, NULL);
+        if(client < 0)
+        {
+            ::close(server);
+            unlink(path.c_str());
+            return false;
+        }
+        transports.push_back(new SocketTransport(client));
+    }
+    ::close(server);
+    unlink(path.c_str());
+    return true;
+#else
+    return false;
+#endif
+}
+
+SocketTransport* SocketTransport::connect(std::string const& path)
+{
+#ifndef WIN32
+    struct sockaddr_un address;
+    if(path.size() >= sizeof(address.sun_path))
+        return NULL;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path.c_str());
+
+    int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(client < 0)
+        return NULL;
+    if(::connect(client, (struct sockaddr*)&address, sizeof(address)) != 0)
+    {
+        ::close(client);
+        return NULL;
+    }
+    return new SocketTransport(client);
+#else
+    return NULL;
+#endif
+}
+
+bool SocketTransport::send(std::vector <unsigned char> const& message)
+{
+    uint64_t size = message.size();
+    return send_all(&size, sizeof(size)) && send_all(message.data(), message.size());
+}
+
+bool SocketTransport::receive(std::vector <unsigned char> &message)
+{
+    uint64_t size = 0;
+    if(!receive_all(&size, sizeof(size)))
+        return false;
+    message.resize(size);
+    return receive_all(message.data(), size);
+}
+
+bool SocketTransport::send_all(void const* data, size_t size)
+{
+#ifndef WIN32
+    char const* bytes = static_cast<char const*>(data);
+    while(size > 0)
+    {
+        ssize_t sent = ::send(m_socket, bytes, size, MSG_NOSIGNAL); //a worker which has stopped must not kill the coordinator
+        if(sent < 0 && errno == EINTR)
+            continue;
+        if(sent <= 0)
+            return false;
+        bytes += sent;
+        size -= sent;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool SocketTransport::receive_all(void *data, size_t size)
+{
+#ifndef WIN32
+    char *bytes = static_cast<char*>(data);
+    while(size > 0)
+    {
+        ssize_t received = recv(m_socket, bytes, size, 0);
+        if(received < 0 && errno == EINTR)
+            continue;
+        if(received <= 0)
+            return false;
+        bytes += received;
+        size -= received;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,44 @@
+#ifndef DEF_TRANSPORT
+#define DEF_TRANSPORT
+
+#include <string>
+#include <vector>
+
+//connection between the coordinator of a cluster and one of its workers
+//it only has to deliver whole messages in order: local sockets for now, the network of a real cluster later
+class Transport
+{
+public:
+    virtual ~Transport() {}
+
+    virtual bool send(std::vector <unsigned char> const& message) = 0;
+    virtual bool receive(std::vector <unsigned char> &message) = 0; //waits for the next message, false if the connection is closed
+};
+
+//Unix domain socket: each message is preceded by its size
+class SocketTransport : public Transport
+{
+public:
+    explicit SocketTransport(int socket);
+    ~SocketTransport();
+
+    static bool create_pair(SocketTransport *&first, SocketTransport *&second); //two connected ends, for a worker started with fork()
+    static bool listen(std::string const& path, int connections, std::vector <Transport*> &transports); //waits for the workers
+    static SocketTransport* connect(std::string const& path);
+
+    bool send(std::vector <unsigned char> const& message);
+    bool receive(std::vector <unsigned char> &message);
+
+    void close();
+
+private:
+    SocketTransport(SocketTransport const&);
+    SocketTransport& operator=(SocketTransport const&);
+
+    bool send_all(void const* data, size_t size);
+    bool receive_all(void *data, size_t size);
+
+    int m_socket;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef DEF_TRIPLEBUFFER
+#define DEF_TRIPLEBUFFER
+
+#include <mutex>
+#include <utility>
+
+//three values passed from a producer thread to a consumer thread without either of them waiting for the other:
+//the producer fills the back one and publishes it, the consumer takes the last published one; the ones published in between are skipped
+//the lock only covers the exchange of the indices, never the filling or the reading
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer(): m_back(0), m_middle(1), m_front(2), m_fresh(false)
+    {}
+
+    T& get_back() //only used by the producer, until it is published
+    {
+        return m_buffers[m_back];
+    }
+
+    void publish()
+    {
+        std::lock_guard <std::mutex> lock(m_mutex);
+        std::swap(m_back, m_middle);
+        m_fresh = true;
+    }
+
+    T const& get_front() const //only used by the consumer, until the next fetch
+    {
+        return m_buffers[m_front];
+    }
+
+    bool fetch(T *previous = NULL) //takes the last published value if there is a new one, the front one is swapped with previous before
+    {
+        std::lock_guard <std::mutex> lock(m_mutex);
+        if(!m_fresh)
+            return false;
+        if(previous)
+            std::swap(*previous, m_buffers[m_front]);
+        std::swap(m_front, m_middle);
+        m_fresh = false;
+        return true;
+    }
+
+private:
+    TripleBuffer(TripleBuffer const&);
+    TripleBuffer& operator=(TripleBuffer const&);
+
+    T m_buffers[3];
+    int m_back, m_middle, m_front;
+    bool m_fresh; //the middle one has been published and not taken yet
+    std::mutex m_mutex;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include <string>
+#include "WorkerPool.hpp"
+#include "Profiler.hpp"
+
+WorkerPool::WorkerPool(int threads)
+{
+    m_task = NULL;
+    m_tasks = 0;
+    m_next = 0;
+    m_remaining = 0;
+    m_generation = 0;
+    m_stop = false;
+
+    for(int i = 1; i < threads; i++)
+        m_threads.push_back(std::thread(&WorkerPool::work, this, i));
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard <std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_start.notify_all();
+    for(int i = 0; i < m_threads.size(); i++)
+        m_threads[i].join();
+}
+
+int WorkerPool::get_threads_number() const
+{
+    return m_threads.size() + 1;
+}
+
+void WorkerPool::run(int tasks, std::function<void(int)> const& task)
+{
+    {
+        std::lock_guard <std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_tasks = tasks;
+        m_next = 0;
+        m_remaining = tasks;
+        m_generation += 1;
+    }
+    m_start.notify_all();
+
+    work_on_tasks();
+
+    std::unique_lock <std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return m_remaining == 0; });
+    m_task = NULL;
+}
+
+void WorkerPool::work(int worker)
+{
+    Profiler::set_thread_name("worker_" + std::to_string(worker));
+    uint64_t generation = 0;
+    while(true)
+    {
+        {
+            std::unique_lock <std::mutex> lock(m_mutex);
+            m_start.wait(lock, [this, generation]() { return m_stop || m_generation != generation; });
+            if(m_stop)
+                return;
+            generation = m_generation;
+        }
+        work_on_tasks();
+    }
+}
+
+void WorkerPool::work_on_tasks()
+{
+    while(true)
+    {
+        int index;
+        std::function<void(int)> const* task;
+        {
+            std::lock_guard <std::mutex> lock(m_mutex);
+            if(m_next >= m_tasks)
+                return;
+            index = m_next++;
+            task = m_task;
+        }
+
+        (*task)(index);
+
+        bool last;
+        {
+            std::lock_guard <std::mutex> lock(m_mutex);
+            last = (--m_remaining == 0);
+        }
+        if(last)
+            m_done.notify_all();
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef DEF_WORKERPOOL
+#define DEF_WORKERPOOL
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+
+//threads kept alive from one step to the next: run() hands them the tasks of a step and returns once they are all done
+//the calling thread works too, so a pool of N threads only starts N - 1 of them
+class WorkerPool
+{
+public:
+    explicit WorkerPool(int threads);
+    ~WorkerPool();
+
+    int get_threads_number() const;
+    void run(int tasks, std::function<void(int)> const& task); //task(0) to task(tasks - 1), in any order and any thread
+
+private:
+    WorkerPool(WorkerPool const&);
+    WorkerPool& operator=(WorkerPool const&);
+
+    void work(int worker);
+    void work_on_tasks(); //until there is no task left to take
+
+    std::vector <std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+
+    std::function<void(int)> const* m_task;
+    int m_tasks;
+    int m_next; //next task to take
+    int m_remaining; //tasks not finished yet
+    uint64_t m_generation; //number of calls to run, wakes the workers up
+    bool m_stop;
+};
+
+#endif
@@ -0,0 +1,214 @@
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include "World.hpp"
+#include "Checkpoint.hpp"
+#include "Profiler.hpp"
+
+World::World(Scenario const& scenario, uint64_t seed, SDL_Renderer *renderer): m_scenario(scenario), m_random(seed)
+{
+    m_time = 0;
+
+    m_map = new Map(m_scenario, m_random, renderer);
+    m_population = new Population(m_scenario, m_random, renderer);
+    m_stats = new Stats(m_scenario, renderer != NULL);
+    m_recorder = NULL;
+    m_trajectories = NULL;
+    m_density = NULL;
+    m_density_cell = DENSITY_CELL;
+    m_density_interval = 1000;
+}
+
+World::~World()
+{
+    if(m_recorder)
+        m_recorder->flush(*this);
+    delete m_recorder;
+    delete m_trajectories;
+    delete m_density;
+    delete m_map;
+    delete m_population;
+    delete m_stats;
+}
+
+bool World::get_error() const
+{
+    if(m_map->get_error() || m_population->get_error() || m_stats->get_error())
+        return true;
+    return false;
+}
+
+void World::generate()
+{
+    m_time = 0;
+    m_map->generate();
+    m_population->generate();
+}
+
+bool World::generate(std::vector <unsigned char> const& map_state)
+{
+    if(map_state.empty())
+        return false;
+    CheckpointReader cp;
+    cp.open(map_state);
+    m_time = 0;
+    if(!m_map->load_state(cp, 0))
+        return false;
+    m_population->generate(); //the animals do not depend on the map, the same seed gives the same ones as with generate()
+    return true;
+}
+
+void World::save_map(std::vector <unsigned char> &map_state) const
+{
+    CheckpointWriter cp;
+    m_map->save_state(cp, m_time);
+    cp.write(map_state);
+}
+
+void World::set_threads(int threads)
+{
+    m_population->set_threads(threads);
+}
+
+void World::update(int dt)
+{
+    PROFILE_ZONE("World::update");
+    m_time += dt;
+    {
+        PROFILE_ZONE("Map::update");
+        m_map->update(m_time);
+    }
+    {
+        PROFILE_ZONE("Population::update");
+        m_population->update(*m_map, m_time);
+    }
+    {
+        PROFILE_ZONE("Stats::update");
+        m_stats->update(*m_population, *m_map, m_time);
+    }
+    if(m_density && (m_density->get_time() < 0 || m_time - m_density->get_time() >= m_density_interval || m_time < m_density->get_time()))
+        m_density->build(*m_population, m_time);
+    if(m_recorder)
+        m_recorder->record(*this);
+    if(m_trajectories)
+        m_trajectories->record(*m_population, m_time);
+}
+
+int World::get_time() const
+{
+    return m_time;
+}
+
+uint64_t World::get_seed() const
+{
+    return m_random.get_seed();
+}
+
+Scenario const& World::get_scenario() const
+{
+    return m_scenario;
+}
+
+Map& World::get_map()
+{
+    return *m_map;
+}
+
+Population& World::get_population()
+{
+    return *m_population;
+}
+
+Stats& World::get_stats()
+{
+    return *m_stats;
+}
+
+DensityMap const& World::get_density() const
+{
+    if(!create_density())
+        m_density->build(*m_population, m_time); //first use: counted now, then rebuilt by the updates
+    return *m_density;
+}
+
+bool World::create_density() const
+{
+    if(m_density)
+        return true;
+    m_density = new DensityMap(m_scenario.width, m_scenario.height, m_scenario.get_species_number(), m_density_cell);
+    return false;
+}
+
+bool World::save_checkpoint(std::string const& file_name) const //saves the whole state of the world to continue it later
+{
+    static const char magic[8] = {'S', 'W', 'C', 'H', 'K', 'P', 'T', 0};
+
+    CheckpointWriter cp;
+    cp.add(magic, sizeof(magic));
+    cp.add_value(CHECKPOINT_VERSION);
+    cp.add_value(uint64_t(m_random.get_seed())); //the generator has no state besides its key
+    cp.add_value(int32_t(m_time));
+
+    m_map->save_state(cp, m_time);
+    m_population->save_state(cp, m_time);
+    m_stats->save_state(cp, m_time);
+    return cp.write(file_name);
+}
+
+bool World::load_checkpoint(std::string const& file_name)
+{
+    CheckpointReader cp;
+    if(!cp.open(file_name))
+        return false;
+
+    char magic[8];
+    int32_t version = 0, time = 0;
+    uint64_t seed = 0;
+    if(!cp.read(magic, sizeof(magic)) || memcmp(magic, "SWCHKPT", 8) || !cp.read_value(version) || version != CHECKPOINT_VERSION)
+        return false;
+    if(!cp.read_value(seed) || !cp.read_value(time))
+        return false;
+
+    if(!m_map->load_state(cp, time) || !m_population->load_state(cp, time) || !m_stats->load_state(cp, time))
+        return false;
+
+    m_random = Random(seed);
+    m_time = time;
+    return true;
+}
+
+bool World::record(std::string const& file_name, int keyframe_interval)
+{
+    delete m_recorder;
+    m_recorder = new EventRecorder();
+    if(m_recorder->open(file_name, *this, keyframe_interval))
+        return true;
+    delete m_recorder;
+    m_recorder = NULL;
+    return false;
+}
+
+void World::set_density(int cell, int interval)
+{
+    delete m_density;
+    m_density = NULL; //created with the new cells when it is used
+    m_density_cell = cell;
+    m_density_interval = std::max(1, interval);
+}
+
+bool World::export_density(std::string const& file_name)
+{
+    create_density(); //built at the next update
+    return m_density->export_rasters(file_name);
+}
+
+bool World::dump_trajectories(std::string const& file_name, int interval, std::vector <int> const& species)
+{
+    delete m_trajectories;
+    m_trajectories = new TrajectoryWriter();
+    if(m_trajectories->open(file_name, m_scenario.get_species_number(), interval, species))
+        return true;
+    delete m_trajectories;
+    m_trajectories = NULL;
+    return false;
+}
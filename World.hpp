@@ -0,0 +1,64 @@
+#ifndef DEF_WORLD
+#define DEF_WORLD
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+#include "Scenario.hpp"
+#include "Random.hpp"
+#include "Map.hpp"
+#include "Population.hpp"
+#include "Stats.hpp"
+#include "EventLog.hpp"
+#include "Trajectory.hpp"
+#include "Density.hpp"
+
+//one simulated world: its map, its animals, its stats and its own clock and random key
+//several worlds can run in parallel (in different threads) on the same scenario
+class World
+{
+public:
+    World(Scenario const& scenario, uint64_t seed, SDL_Renderer *renderer = NULL); //without renderer, nothing needed for the display is loaded
+    ~World();
+
+    bool get_error() const;
+
+    void generate();
+    bool generate(std::vector <unsigned char> const& map_state); //starts from a map saved by save_map (shared by the replicates of a scenario), only the animals are generated
+    void save_map(std::vector <unsigned char> &map_state) const;
+    void set_threads(int threads); //threads sharing the simulation of the animals, each on its own strip of the map
+    void update(int dt); //advances the simulation by dt ms of simulated time
+
+    int get_time() const;
+    uint64_t get_seed() const;
+    Scenario const& get_scenario() const;
+    Map& get_map();
+    Population& get_population();
+    Stats& get_stats();
+    DensityMap const& get_density() const; //animals by cell, for the region queries (counted at the first call, then at every rebuild)
+
+    bool save_checkpoint(std::string const& file_name) const;
+    bool load_checkpoint(std::string const& file_name);
+    bool record(std::string const& file_name, int keyframe_interval); //writes the event log of the following steps, with a keyframe every keyframe_interval simulated seconds
+    void set_density(int cell, int interval); //cells of cell blocks, rebuilt every interval simulated ms (the stats interval by default)
+    bool export_density(std::string const& file_name); //appends the counts of the cells to the file at every rebuild
+    bool dump_trajectories(std::string const& file_name, int interval, std::vector <int> const& species); //writes the animals every interval steps (only the species given, all if empty)
+
+private:
+    bool create_density() const; //false if the density did not exist yet
+
+    Scenario const& m_scenario;
+    Random m_random; //shared (read only) by the map and the population
+    int m_time; //simulated time in ms
+
+    Map *m_map;
+    Population *m_population;
+    Stats *m_stats;
+    EventRecorder *m_recorder; //NULL when the world is not recorded
+    TrajectoryWriter *m_trajectories; //NULL when the trajectories are not written
+    mutable DensityMap *m_density; //NULL until the density is used, the worlds which do not use it do not count their animals
+    int m_density_cell;
+    int m_density_interval;
+};
+
+#endif
@@ -1,11 +1,82 @@
 #include "Simulation.hpp"
 #include <map>
 #include <iostream>
+#include <vector>
+#include <string>
+#include <ctime>
+#include <stdexcept>
 
-Settings getSettings(int argc, char *argv[])
+static bool getSettings(int argc, char *argv[], Settings &settings)
 {
-    Settings settings;
-    if(argc == 1) //default settings when lauching from the programm itself
+    settings.checkpointInterval = 0;
+    settings.statusRate = 10;
+    settings.scenario = "settings";
+    settings.seed = time(0);
+    settings.threads = 1;
+    settings.step = 20;
+    settings.keyframes = 60;
+
+    //the options ("--name value") can be given in any order, the other values are the ones given by the launcher
+    std::vector <char*> values;
+    for(int i = 0; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if(option.compare(0, 2, "--") != 0)
+        {
+            values.push_back(argv[i]);
+            continue;
+        }
+        if(i + 1 >= argc)
+        {
+            std::cerr << "valeur manquante pour " << option << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        try
+        {
+            if(option == "--checkpoint")
+                settings.checkpoint = value;
+            else if(option == "--checkpoint-interval")
+                settings.checkpointInterval = std::stoi(value);
+            else if(option == "--status-rate")
+                settings.statusRate = std::stoi(value);
+            else if(option == "--seed")
+                settings.seed = std::stoull(value);
+            else if(option == "--trace")
+                settings.trace = value;
+            else if(option == "--scenario")
+                settings.scenario = value;
+            else if(option == "--threads")
+                settings.threads = std::stoi(value);
+            else if(option == "--step")
+                settings.step = std::stoi(value);
+            else if(option == "--record")
+                settings.record = value;
+            else if(option == "--keyframes")
+                settings.keyframes = std::stoi(value);
+            else if(option == "--replay")
+                settings.replay = value;
+            else
+            {
+                std::cerr << "option inconnue : " << option << std::endl;
+                return false;
+            }
+        }
+        catch(std::exception const&) //std::stoi
+        {
+            std::cerr << "valeur invalide pour " << option << " : " << value << std::endl;
+            return false;
+        }
+    }
+    if(settings.step <= 0 || settings.threads <= 0 || settings.keyframes <= 0)
+    {
+        std::cerr << "--step, --threads et --keyframes doivent etre positifs" << std::endl;
+        return false;
+    }
+    argc = values.size();
+    argv = values.data();
+
+    if(argc < 8) //default settings when lauching from the programm itself
     {
         settings.id = 0;
         settings.duration = 0;
@@ -19,21 +90,36 @@ Settings getSettings(int argc, char *argv[])
     }
     else //reading settings from argv when launching from the launcher
     {
-        settings.id = std::stoi(argv[0]);
-        settings.duration = std::stoi(argv[1]);
-        settings.speed = std::stoi(argv[2]);
-        settings.stopOnFailure = std::stoi(argv[3]);
-        settings.saveOnFailure = std::stoi(argv[4]);
-        settings.minFailureSave = std::stoi(argv[5]);
-        settings.hide = std::stoi(argv[6]);
+        try
+        {
+            settings.id = std::stoi(argv[0]);
+            settings.duration = std::stoi(argv[1]);
+            settings.speed = std::stoi(argv[2]);
+            settings.stopOnFailure = std::stoi(argv[3]);
+            settings.saveOnFailure = std::stoi(argv[4]);
+            settings.minFailureSave = std::stoi(argv[5]);
+            settings.hide = std::stoi(argv[6]);
+        }
+        catch(std::exception const&)
+        {
+            std::cerr << "parametres du lanceur invalides" << std::endl;
+            return false;
+        }
         settings.directory = argv[7];
     }
-    return settings;
+    return true;
 }
 
 int main(int argc, char *argv[])
 {
-    Simulation *simulation = new Simulation(getSettings(argc, argv));
+    Settings settings;
+    if(!getSettings(argc, argv, settings))
+    {
+        std::cerr << "usage: simuworld [id duree vitesse arret_sur_echec sauvegarde_sur_echec pourcentage_minimal masquer dossier] [--scenario dir|file.bin] [--seed N] [--threads N] [--step ms]"
+                  << " [--checkpoint file] [--checkpoint-interval s] [--status-rate N] [--trace file.json] [--record file.swlog] [--keyframes s] [--replay file.swlog]" << std::endl;
+        return 1;
+    }
+    Simulation *simulation = new Simulation(settings);
 
     if(simulation->get_error()) //checks if the simulation has been created successfully
         return 0;
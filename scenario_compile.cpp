@@ -0,0 +1,42 @@
+#include <iostream>
+#include "Scenario.hpp"
+
+//checks all the settings of a directory at once, and writes them in a single binary file
+//the simulations (--scenario, --settings or settings= of a sweep) then load them with one mapping instead of parsing every file
+int main(int argc, char *argv[])
+{
+    if(argc != 2 && argc != 3)
+    {
+        std::cerr << "usage: scenario_compile <dossier des parametres> [scenario.bin]" << std::endl;
+        std::cerr << "sans fichier de sortie, les parametres sont seulement verifies" << std::endl;
+        return 1;
+    }
+
+    Scenario scenario;
+    if(!scenario.load(argv[1]))
+    {
+        std::vector <std::string> const& errors = scenario.get_errors();
+        for(int i = 0; i < errors.size(); i++)
+            std::cerr << errors[i] << std::endl;
+        std::cerr << errors.size() << " erreur(s)" << std::endl;
+        return 1;
+    }
+
+    std::vector <std::string> const& warnings = scenario.get_warnings();
+    for(int i = 0; i < warnings.size(); i++)
+        std::cerr << "attention, " << warnings[i] << std::endl;
+
+    std::cout << argv[1] << " : " << scenario.get_species_number() << " especes, " << scenario.get_resources_number() << " ressources, "
+              << scenario.get_biomes_number() << " biomes, carte de " << scenario.width << "x" << scenario.height << std::endl;
+
+    if(argc == 3)
+    {
+        if(!scenario.save_compiled(argv[2]))
+        {
+            std::cerr << argv[2] << " n'a pas pu etre ecrit" << std::endl;
+            return 1;
+        }
+        std::cout << "scenario compile dans " << argv[2] << std::endl;
+    }
+    return 0;
+}
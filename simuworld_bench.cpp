@@ -0,0 +1,18 @@
+#include <iostream>
+#include "Benchmark.hpp"
+
+//times the stages of the simulation on synthetic worlds, the results are written in JSON to compare them between versions
+int main(int argc, char *argv[])
+{
+    Benchmark benchmark;
+    if(!benchmark.load(argc, argv))
+    {
+        std::cerr << "usage: simuworld_bench [--settings dir] [--seed N] [--repetitions N] [--sizes 1000,10000] [--ranges 5,20] [--output file.json]" << std::endl;
+        return 1;
+    }
+
+    benchmark.run();
+    if(!benchmark.write_json())
+        return 1;
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include <stdexcept>
+#include "Scenario.hpp"
+#include "Cluster.hpp"
+#include "Transport.hpp"
+
+#ifndef WIN32
+    #include <sys/types.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+struct ClusterSettings
+{
+    std::string settings; //directory of the settings (read by every worker)
+    std::string directory; //directory of the results
+    std::string socket; //path of the socket the workers connect to, empty to start them here
+    std::string connect; //path of the socket of the coordinator: this process is a worker
+    int id;
+    int duration; //simulated seconds
+    int step; //simulated ms per step
+    int workers;
+    bool stopOnFailure;
+    bool save;
+    uint64_t seed;
+};
+
+static bool getSettings(int argc, char *argv[], ClusterSettings &settings)
+{
+    settings.settings = "settings";
+    settings.directory = "results";
+    settings.id = 0;
+    settings.duration = 60;
+    settings.step = 100;
+    settings.workers = 2;
+    settings.stopOnFailure = false;
+    settings.save = false;
+    settings.seed = 1;
+
+    for(int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string option = argv[i], value = argv[i + 1];
+        try
+        {
+            if(option == "--settings")
+                settings.settings = value;
+            else if(option == "--directory")
+                settings.directory = value;
+            else if(option == "--socket")
+                settings.socket = value;
+            else if(option == "--connect")
+                settings.connect = value;
+            else if(option == "--id")
+                settings.id = std::stoi(value);
+            else if(option == "--duration")
+                settings.duration = std::stoi(value);
+            else if(option == "--step")
+                settings.step = std::stoi(value);
+            else if(option == "--workers")
+                settings.workers = std::stoi(value);
+            else if(option == "--stop-on-failure")
+                settings.stopOnFailure = std::stoi(value);
+            else if(option == "--save")
+                settings.save = std::stoi(value);
+            else if(option == "--seed")
+                settings.seed = std::stoull(value);
+            else
+            {
+                std::cerr << "option inconnue : " << option << std::endl;
+                return false;
+            }
+        }
+        catch(std::exception const&) //std::stoi
+        {
+            std::cerr << "valeur invalide pour " << option << " : " << value << std::endl;
+            return false;
+        }
+    }
+    return argc % 2 == 1 && settings.duration > 0 && settings.step > 0 && settings.workers > 0;
+}
+
+//one world split between several processes, each simulating a strip of the map
+//without --socket, the workers are started here and connected with socket pairs; with it, they are started apart with --connect
+int main(int argc, char *argv[])
+{
+    ClusterSettings settings;
+    if(!getSettings(argc, argv, settings))
+    {
+        std::cerr << "usage: simuworld_cluster [--settings dir] [--seed N] [--duration s] [--step ms] [--workers N] [--stop-on-failure 0|1] [--directory dir] [--id N] [--save 0|1] [--socket path]" << std::endl;
+        std::cerr << "       simuworld_cluster --connect path (un processus du cluster)" << std::endl;
+        return 1;
+    }
+
+#ifndef WIN32
+    if(!settings.connect.empty())
+    {
+        SocketTransport *transport = SocketTransport::connect(settings.connect);
+        if(!transport)
+        {
+            std::cerr << settings.connect << " : connexion impossible" << std::endl;
+            return 1;
+        }
+        ClusterWorker worker(*transport);
+        int code = worker.run();
+        delete transport;
+        return code;
+    }
+
+    Scenario scenario;
+    if(!scenario.load(settings.settings))
+    {
+        for(int i = 0; i < scenario.get_errors().size(); i++)
+            std::cerr << scenario.get_errors()[i] << std::endl;
+        return 1;
+    }
+    settings.workers = std::min(settings.workers, scenario.width); //at least a column per worker
+
+    std::vector <Transport*> transports;
+    std::vector <pid_t> children;
+    if(!settings.socket.empty())
+    {
+        std::cout << "attente de " << settings.workers << " processus sur " << settings.socket << std::endl;
+        if(!SocketTransport::listen(settings.socket, settings.workers, transports))
+        {
+            std::cerr << settings.socket << " : ecoute impossible" << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        std::vector <SocketTransport*> sockets;
+        for(int w = 0; w < settings.workers; w++)
+        {
+            SocketTransport *coordinator_end = NULL, *worker_end = NULL;
+            if(!SocketTransport::create_pair(coordinator_end, worker_end))
+            {
+                std::cerr << "les processus du cluster n'ont pas pu etre crees" << std::endl;
+                return 1;
+            }
+            pid_t child = fork();
+            if(child == 0)
+            {
+                for(int i = 0; i < sockets.size(); i++) //the connections of the other workers
+                    sockets[i]->close();
+                coordinator_end->close();
+                ClusterWorker worker(*worker_end);
+                _exit(worker.run());
+            }
+            delete worker_end;
+            if(child < 0)
+            {
+                delete coordinator_end;
+                std::cerr << "les processus du cluster n'ont pas pu etre crees" << std::endl;
+                return 1;
+            }
+            sockets.push_back(coordinator_end);
+            transports.push_back(coordinator_end);
+            children.push_back(child);
+        }
+    }
+
+    ClusterCoordinator coordinator(scenario, transports);
+    bool success = coordinator.start(settings.settings, settings.seed);
+
+    Stats &stats = coordinator.get_stats();
+    if(settings.id)
+        stats.stream(settings.directory, settings.id);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    long long steps = 0;
+    while(success && !stats.has_finished(settings.duration) && !(settings.stopOnFailure && stats.has_failed()))
+    {
+        success = coordinator.update(settings.step);
+        steps += 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    coordinator.stop();
+
+    for(int i = 0; i < transports.size(); i++)
+        delete transports[i]; //the workers see the end of the connection
+    for(int i = 0; i < children.size(); i++)
+        waitpid(children[i], NULL, 0);
+
+    if(!success)
+    {
+        std::cerr << "le cluster s'est arrete : un processus ne repond plus" << std::endl;
+        return 1;
+    }
+
+    std::cout << "temps simule : " << stats.get_elapsed_time() << " s, " << steps << " pas en " << seconds << " s ("
+              << (seconds > 0 ? steps / seconds : 0) << " pas/s), " << settings.workers << " processus, "
+              << coordinator.get_animals_number() << " animaux" << (stats.has_failed() ? ", echec" : "") << std::endl;
+
+    if(settings.save && !stats.save(settings.directory, settings.id))
+    {
+        std::cerr << "les resultats n'ont pas pu etre enregistres dans " << settings.directory << std::endl;
+        return 1;
+    }
+    return 0;
+#else
+    std::cerr << "simuworld_cluster n'est pas disponible sous Windows" << std::endl;
+    return 1;
+#endif
+}
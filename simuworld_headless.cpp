@@ -0,0 +1,221 @@
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include "Scenario.hpp"
+#include "World.hpp"
+#include "Profiler.hpp"
+
+struct HeadlessSettings
+{
+    std::string settings; //directory of the settings
+    std::string directory; //directory of the results
+    std::string checkpoint; //checkpoint to restore at the start (empty for a new simulation)
+    std::string trace; //file of the profile written at the end (empty for none)
+    std::string record; //event log written during the simulation (empty for none)
+    int keyframes; //simulated seconds between two keyframes of the event log
+    std::string trajectories; //trajectories of the animals written during the simulation (empty for none)
+    int trajectoryInterval; //steps between two records of the trajectories
+    std::vector <int> trajectorySpecies; //species of the trajectories, all if empty
+    std::string density; //rasters of the density written during the simulation (empty for none)
+    int densityCell; //blocks per side of a cell of the density
+    int densityInterval; //simulated ms between two rebuilds of the density
+    std::vector < std::vector <int> > zones; //x,y,w,h in blocks, whose animals are counted at the end
+    int id;
+    int duration; //simulated seconds
+    int step; //simulated ms per step
+    int threads; //threads simulating the animals, each on a strip of the map
+    bool stopOnFailure;
+    bool save;
+    uint64_t seed;
+};
+
+static std::vector <int> parse_list(std::string const& text) //"1,3" -> {1, 3}
+{
+    std::vector <int> values;
+    size_t start = 0;
+    while(start < text.size())
+    {
+        size_t end = text.find(',', start);
+        if(end == std::string::npos)
+            end = text.size();
+        if(end > start)
+            values.push_back(std::stoi(text.substr(start, end - start)));
+        start = end + 1;
+    }
+    return values;
+}
+
+static bool getSettings(int argc, char *argv[], HeadlessSettings &settings)
+{
+    settings.settings = "settings";
+    settings.directory = "results";
+    settings.id = 0;
+    settings.duration = 60;
+    settings.step = 100;
+    settings.threads = 1;
+    settings.stopOnFailure = false;
+    settings.save = false;
+    settings.seed = 1;
+    settings.keyframes = 60;
+    settings.trajectoryInterval = 1;
+    settings.densityCell = DENSITY_CELL;
+    settings.densityInterval = 1000;
+
+    for(int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string option = argv[i], value = argv[i + 1];
+        try
+        {
+            if(option == "--settings")
+                settings.settings = value;
+            else if(option == "--directory")
+                settings.directory = value;
+            else if(option == "--checkpoint")
+                settings.checkpoint = value;
+            else if(option == "--id")
+                settings.id = std::stoi(value);
+            else if(option == "--duration")
+                settings.duration = std::stoi(value);
+            else if(option == "--step")
+                settings.step = std::stoi(value);
+            else if(option == "--stop-on-failure")
+                settings.stopOnFailure = std::stoi(value);
+            else if(option == "--save")
+                settings.save = std::stoi(value);
+            else if(option == "--seed")
+                settings.seed = std::stoull(value);
+            else if(option == "--trace")
+                settings.trace = value;
+            else if(option == "--threads")
+                settings.threads = std::stoi(value);
+            else if(option == "--record")
+                settings.record = value;
+            else if(option == "--keyframes")
+                settings.keyframes = std::stoi(value);
+            else if(option == "--trajectories")
+                settings.trajectories = value;
+            else if(option == "--trajectory-interval")
+                settings.trajectoryInterval = std::stoi(value);
+            else if(option == "--trajectory-species")
+                settings.trajectorySpecies = parse_list(value);
+            else if(option == "--density")
+                settings.density = value;
+            else if(option == "--density-cell")
+                settings.densityCell = std::stoi(value);
+            else if(option == "--density-interval")
+                settings.densityInterval = std::stoi(value);
+            else if(option == "--zone")
+            {
+                settings.zones.push_back(parse_list(value));
+                if(settings.zones.back().size() != 4)
+                    return false;
+            }
+            else
+            {
+                std::cerr << "option inconnue : " << option << std::endl;
+                return false;
+            }
+        }
+        catch(std::exception const&) //std::stoi and parse_list
+        {
+            std::cerr << "valeur invalide pour " << option << " : " << value << std::endl;
+            return false;
+        }
+    }
+    return argc % 2 == 1 && settings.duration > 0 && settings.step > 0 && settings.threads > 0 && settings.keyframes > 0 && settings.trajectoryInterval > 0 && settings.densityCell > 0 && settings.densityInterval > 0;
+}
+
+//runs one simulation without window, as fast as possible
+int main(int argc, char *argv[])
+{
+    HeadlessSettings settings;
+    if(!getSettings(argc, argv, settings))
+    {
+        std::cerr << "usage: simuworld_headless [--settings dir] [--seed N] [--duration s] [--step ms] [--stop-on-failure 0|1] [--checkpoint file] [--directory dir] [--id N] [--save 0|1] [--trace file.json] [--threads N] [--record file.swlog] [--keyframes s] [--trajectories file.swtraj] [--trajectory-interval steps] [--trajectory-species 1,3] [--density file.swdens] [--density-cell blocks] [--density-interval ms] [--zone x,y,w,h]" << std::endl;
+        return 1;
+    }
+
+    Scenario scenario;
+    if(!scenario.load(settings.settings))
+    {
+        for(int i = 0; i < scenario.get_errors().size(); i++)
+            std::cerr << scenario.get_errors()[i] << std::endl;
+        return 1;
+    }
+    World world(scenario, settings.seed);
+    world.set_threads(settings.threads);
+    world.generate();
+    if(!settings.checkpoint.empty() && !world.load_checkpoint(settings.checkpoint))
+    {
+        std::cerr << settings.checkpoint << " n'a pas pu etre restaure" << std::endl;
+        return 1;
+    }
+
+    if(!settings.record.empty() && !world.record(settings.record, settings.keyframes))
+    {
+        std::cerr << settings.record << " n'a pas pu etre cree" << std::endl;
+        return 1;
+    }
+    if(!settings.trajectories.empty() && !world.dump_trajectories(settings.trajectories, settings.trajectoryInterval, settings.trajectorySpecies))
+    {
+        std::cerr << settings.trajectories << " n'a pas pu etre cree" << std::endl;
+        return 1;
+    }
+    world.set_density(settings.densityCell, settings.densityInterval); //only counted with --density or --zone
+    if(!settings.density.empty() && !world.export_density(settings.density))
+    {
+        std::cerr << settings.density << " n'a pas pu etre cree" << std::endl;
+        return 1;
+    }
+
+    Stats &stats = world.get_stats();
+    if(settings.id)
+        stats.stream(settings.directory, settings.id);
+
+    Profiler::set_thread_name("headless");
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    long long steps = 0;
+    while(!stats.has_finished(settings.duration) && !(settings.stopOnFailure && stats.has_failed()))
+    {
+        world.update(settings.step);
+        steps += 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "temps simule : " << stats.get_elapsed_time() << " s, " << steps << " pas en " << seconds << " s ("
+              << (seconds > 0 ? steps / seconds : 0) << " pas/s)" << (stats.has_failed() ? ", echec" : "") << std::endl;
+
+    //the zones are counted on the last density, in O(1) whatever the number of animals
+    for(int z = 0; z < settings.zones.size(); z++)
+    {
+        DensityMap const& density = world.get_density();
+        std::vector <int> const& zone = settings.zones[z];
+        SDL_Rect area = {zone[0], zone[1], zone[2], zone[3]};
+        std::cout << "zone " << zone[0] << "," << zone[1] << "," << zone[2] << "," << zone[3];
+
+        //the counts are those of the whole cells touched by the zone, clipped to the map
+        SDL_Rect cells = density.get_cells(area);
+        int cell = density.get_cell();
+        SDL_Rect counted = {cells.x * cell, cells.y * cell, std::min(scenario.width, (cells.x + cells.w) * cell) - cells.x * cell, std::min(scenario.height, (cells.y + cells.h) * cell) - cells.y * cell};
+        if(counted.x != area.x || counted.y != area.y || counted.w != area.w || counted.h != area.h)
+            std::cout << " (comptee sur les cases " << counted.x << "," << counted.y << "," << counted.w << "," << counted.h << ")";
+        std::cout << " : " << density.count(0, area) << " animaux";
+        for(int specie = 1; specie <= scenario.get_species_number(); specie++)
+            if(density.count(specie, area))
+                std::cout << ", " << scenario.species_name[specie - 1] << " " << density.count(specie, area) << " (" << density.get_density(specie, area) * 100 << " pour 100 blocs)";
+        std::cout << std::endl;
+    }
+
+    if(!settings.trace.empty() && !Profiler::write_trace(settings.trace))
+        std::cerr << settings.trace << " n'a pas pu etre ecrit" << std::endl;
+
+    if(settings.save && !stats.save(settings.directory, settings.id))
+    {
+        std::cerr << "les resultats n'ont pas pu etre sauvegardes" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <string>
+#include "Scenario.hpp"
+#include "Replay.hpp"
+
+//reads an event log without window: its range, its keyframes, and the populations at the given simulated seconds
+int main(int argc, char *argv[])
+{
+    if(argc < 2 || argc % 2 != 0)
+    {
+        std::cerr << "usage: simuworld_replay <log.swlog> [--settings directory] [--at s]..." << std::endl;
+        return 1;
+    }
+
+    std::string settings = "settings";
+    std::vector <int> times;
+    for(int i = 2; i + 1 < argc; i += 2)
+    {
+        std::string option = argv[i];
+        if(option == "--settings")
+            settings = argv[i + 1];
+        else if(option == "--at")
+            times.push_back(std::stoi(argv[i + 1]) * 1000);
+        else
+        {
+            std::cerr << "option inconnue : " << option << std::endl;
+            return 1;
+        }
+    }
+
+    Scenario scenario;
+    if(!scenario.load(settings))
+    {
+        std::vector <std::string> const& errors = scenario.get_errors();
+        for(int i = 0; i < errors.size(); i++)
+            std::cerr << errors[i] << std::endl;
+        return 1;
+    }
+
+    Replay replay(scenario);
+    if(!replay.open(argv[1]))
+    {
+        std::cerr << argv[1] << " n'a pas pu etre lu" << std::endl;
+        return 1;
+    }
+    std::cout << "de " << replay.get_start() / 1000 << " s a " << replay.get_end() / 1000 << " s, " << replay.get_keyframes_number() << " images cles" << std::endl;
+
+    for(int i = 0; i < times.size(); i++)
+    {
+        replay.advance(times[i]);
+        std::cout << replay.get_time() / 1000 << " s :";
+        for(int specie = 1; specie <= scenario.get_species_number(); specie++)
+            std::cout << " " << replay.get_number(specie);
+        std::cout << " (" << replay.get_number() << " animaux)" << std::endl;
+    }
+    return replay.get_error() ? 1 : 0;
+}
@@ -0,0 +1,25 @@
+#include <iostream>
+#include <string>
+#include "Sweep.hpp"
+
+//runs all the simulations described by a sweep file in this process, on several threads
+//or, with options, an ensemble: the replicates of the same settings, summarized by their mean and its confidence interval
+int main(int argc, char *argv[])
+{
+    Sweep sweep;
+    bool loaded = false;
+    if(argc == 2 && std::string(argv[1]).compare(0, 2, "--"))
+        loaded = sweep.load(std::string(argv[1]));
+    else if(argc >= 3)
+        loaded = sweep.load(argc, argv);
+    if(!loaded)
+    {
+        std::cerr << "usage: simuworld_sweep <sweep.txt>" << std::endl;
+        std::cerr << "       simuworld_sweep --replicates N [--seed N] [--settings dir] [--duration s] [--step ms] [--threads N] [--same-map 0|1] [--output file] [--summary file]" << std::endl;
+        return 1;
+    }
+
+    if(!sweep.run())
+        return 1;
+    return 0;
+}
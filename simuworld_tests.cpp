@@ -0,0 +1,785 @@
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include "Scenario.hpp"
+#include "World.hpp"
+#include "Replay.hpp"
+#include "StatsWriter.hpp"
+#include "Cluster.hpp"
+#include "Sweep.hpp"
+#include "Transport.hpp"
+
+#ifndef WIN32
+    #include <sys/types.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+//checks run by ctest: each one simulates a short world and compares two ways of getting the same result
+//usage: simuworld_tests <check> <directory for the files> [settings directory]
+
+static const int STEP = 100; //simulated ms per step
+
+static bool read_file(std::string const& file_name, std::vector <char> &content)
+{
+    std::ifstream file(file_name.c_str(), std::ios::binary);
+    if(!file)
+        return false;
+    content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static bool same_files(std::string const& first, std::string const& second)
+{
+    std::vector <char> a, b;
+    if(!read_file(first, a) || !read_file(second, b))
+    {
+        std::cerr << first << " ou " << second << " n'a pas pu etre lu" << std::endl;
+        return false;
+    }
+    if(a != b)
+    {
+        std::cerr << first << " et " << second << " sont differents" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static void run(World &world, int seconds)
+{
+    int end = world.get_time() + seconds * 1000;
+    while(world.get_time() < end)
+        world.update(STEP);
+}
+
+//a restored world saves the same checkpoint, and continues exactly as the original one
+static bool check_checkpoint(Scenario const& scenario, std::string const& directory)
+{
+    World original(scenario, 1);
+    original.generate();
+    run(original, 20);
+    if(!original.save_checkpoint(directory + "/checkpoint_a.bin"))
+        return false;
+
+    World restored(scenario, 2); //the seed comes from the checkpoint
+    restored.generate();
+    if(!restored.load_checkpoint(directory + "/checkpoint_a.bin") || !restored.save_checkpoint(directory + "/checkpoint_b.bin"))
+        return false;
+    if(!same_files(directory + "/checkpoint_a.bin", directory + "/checkpoint_b.bin"))
+        return false;
+
+    run(original, 20);
+    run(restored, 20);
+    return original.save_checkpoint(directory + "/checkpoint_c.bin") && restored.save_checkpoint(directory + "/checkpoint_d.bin")
+        && same_files(directory + "/checkpoint_c.bin", directory + "/checkpoint_d.bin");
+}
+
+//a seed simulated by the same number of threads always gives the same world, whatever the order the threads run in
+//(not the same world as with another number: a tile sees the animals of the others as they were at the start of the step)
+static bool check_threads(Scenario const& scenario, std::string const& directory)
+{
+    World first(scenario, 1), second(scenario, 1);
+    first.set_threads(4);
+    second.set_threads(4);
+    first.generate();
+    second.generate();
+    run(first, 40);
+    run(second, 40);
+
+    std::vector < std::vector <int> > const& a = first.get_stats().get_values();
+    std::vector < std::vector <int> > const& b = second.get_stats().get_values();
+    for(int t = 0; t < a.size() || t < b.size(); t++)
+    {
+        if(t >= a.size() || t >= b.size() || a[t] != b[t])
+        {
+            std::cerr << "les stats different a " << t << " s" << std::endl;
+            return false;
+        }
+    }
+    return first.save_checkpoint(directory + "/threads_a.bin") && second.save_checkpoint(directory + "/threads_b.bin")
+        && same_files(directory + "/threads_a.bin", directory + "/threads_b.bin");
+}
+
+#ifndef WIN32
+//the stats of a world simulated by forked workers, as simuworld_cluster does without --socket
+static bool run_cluster(Scenario const& scenario, std::string const& settings, int workers, int seconds, std::vector < std::vector <int> > &values)
+{
+    std::vector <SocketTransport*> sockets;
+    std::vector <Transport*> transports;
+    std::vector <pid_t> children;
+    bool success = true;
+    for(int w = 0; w < workers && success; w++)
+    {
+        SocketTransport *coordinator_end = NULL, *worker_end = NULL;
+        success = SocketTransport::create_pair(coordinator_end, worker_end);
+        if(!success)
+            break;
+        pid_t child = fork();
+        if(child == 0)
+        {
+            for(int i = 0; i < sockets.size(); i++) //the connections of the other workers
+                sockets[i]->close();
+            coordinator_end->close();
+            ClusterWorker worker(*worker_end);
+            _exit(worker.run());
+        }
+        delete worker_end;
+        success = child > 0;
+        if(!success)
+        {
+            delete coordinator_end;
+            break;
+        }
+        sockets.push_back(coordinator_end);
+        transports.push_back(coordinator_end);
+        children.push_back(child);
+    }
+
+    if(success)
+    {
+        ClusterCoordinator coordinator(scenario, transports);
+        success = coordinator.start(settings, 1);
+        while(success && coordinator.get_time() < seconds * 1000)
+            success = coordinator.update(STEP);
+        coordinator.stop();
+        values = coordinator.get_stats().get_values();
+    }
+    for(int i = 0; i < transports.size(); i++)
+        delete transports[i]; //the workers see the end of the connection
+    for(int i = 0; i < children.size(); i++)
+        waitpid(children[i], NULL, 0);
+    if(!success)
+        std::cerr << "le cluster s'est arrete : un processus ne repond plus" << std::endl;
+    return success;
+}
+#endif
+
+//a seed simulated by the same number of processes always gives the same stats, whatever the order the messages arrive in
+static bool check_cluster(Scenario const& scenario, std::string const& settings)
+{
+#ifndef WIN32
+    std::vector < std::vector <int> > a, b;
+    if(!run_cluster(scenario, settings, 3, 30, a) || !run_cluster(scenario, settings, 3, 30, b))
+        return false;
+    for(int t = 0; t < a.size() || t < b.size(); t++)
+    {
+        if(t >= a.size() || t >= b.size() || a[t] != b[t])
+        {
+            std::cerr << "les stats different a " << t << " s" << std::endl;
+            return false;
+        }
+    }
+    return !a.empty();
+#else
+    std::cerr << "le cluster n'est pas disponible sous Windows" << std::endl;
+    return false;
+#endif
+}
+
+//vital stats of an animal stepped one update per second, as they were before being computed from the last change
+struct SteppedVitals
+{
+    int update;
+    int health, life_expectancy, time_before_reproduction, time_before_decomposition;
+    int death; //update, -1 if alive
+    bool hungry;
+};
+
+static void step_vitals(SteppedVitals &vitals, SpecieSettings const& settings, int update)
+{
+    while(vitals.update < update)
+    {
+        vitals.update += 1;
+        if(vitals.death < 0)
+        {
+            vitals.life_expectancy -= 1;
+            vitals.health -= 1;
+            vitals.time_before_reproduction -= 1;
+            if(vitals.health < settings.hunger_threshold)
+                vitals.hungry = true;
+            else if(vitals.health > settings.satiated_threshold)
+                vitals.hungry = false;
+            if(vitals.life_expectancy <= 0 || vitals.health <= 0)
+            {
+                vitals.health = 0;
+                vitals.death = vitals.update;
+            }
+        }
+        else
+            vitals.time_before_decomposition -= 1;
+    }
+}
+
+static bool same_vitals(Animal const& animal, SteppedVitals &vitals, SpecieSettings const& settings, int now)
+{
+    step_vitals(vitals, settings, (now - animal.get_origin()) / 1000);
+    AnimalState state = animal.get_state(now);
+    bool same = state.alive == (vitals.death < 0) && state.hungry == vitals.hungry && state.health == vitals.health
+        && state.life_expectancy == vitals.life_expectancy && state.time_before_reproduction == vitals.time_before_reproduction
+        && state.time_before_decomposition == vitals.time_before_decomposition
+        && animal.is_decomposed(now) == (vitals.death >= 0 && vitals.time_before_decomposition <= 0);
+    if(same && vitals.death >= 0) //the time of the decomposition is known once he is dead
+    {
+        int at_death = vitals.time_before_decomposition + vitals.update - vitals.death;
+        same = animal.get_decomposition_time() == animal.get_origin() + (vitals.death + std::max(0, at_death)) * 1000;
+    }
+    if(!same)
+        std::cerr << "animal " << animal.get_id() << ", " << now << " ms : sante " << state.health << " au lieu de " << vitals.health
+                  << ", esperance de vie " << state.life_expectancy << " au lieu de " << vitals.life_expectancy
+                  << ", reproduction " << state.time_before_reproduction << " au lieu de " << vitals.time_before_reproduction
+                  << ", decomposition " << state.time_before_decomposition << " au lieu de " << vitals.time_before_decomposition
+                  << ", faim " << state.hungry << " au lieu de " << vitals.hungry << ", en vie " << state.alive << " au lieu de " << (vitals.death < 0) << std::endl;
+    return same;
+}
+
+//the vital stats computed from the last change are the ones of an animal stepped every second, whatever the damages, meals and births in between
+static bool check_vitals(Scenario const& scenario, std::string const&)
+{
+    Random random(5);
+    for(int specie = 1; specie <= scenario.get_species_number(); specie++)
+    {
+        for(int trial = 0; trial < 200; trial++)
+        {
+            int id = specie * 1000 + trial;
+            SpecieSettings settings = scenario.species[specie - 1];
+            if(trial % 2) //dies of old age too
+                settings.life_expectancy = 1 + random_int(random, settings.maximum_health, 0, id, 0, 0);
+            int now = random_int(random, 100000, 0, id, 0, 1);
+            Vector2d pos = {0, 0};
+            Animal animal(id, pos, specie, settings, random, now);
+            SteppedVitals vitals = {0, settings.hunger_threshold, settings.life_expectancy, settings.reproduction_time, settings.decomposition_time, -1, true};
+
+            for(int change = 1; !animal.is_decomposed(now) && change < 2000; change++)
+            {
+                now += 1 + random_int(random, 2500, 0, id, change, 0);
+                if(!same_vitals(animal, vitals, settings, now))
+                    return false;
+                if(vitals.death >= 0)
+                    continue;
+                int amount = random_int(random, 60, 0, id, change, 2);
+                switch(random_int(random, 4, 0, id, change, 1))
+                {
+                case 1:
+                    animal.take_damage(amount / 2, now);
+                    vitals.health -= amount / 2;
+                    if(vitals.health <= 0)
+                        vitals.death = vitals.update;
+                    break;
+                case 2:
+                    animal.regenerate(amount, now);
+                    vitals.health = std::min(vitals.health + amount, settings.maximum_health);
+                    break;
+                case 3:
+                    animal.reproduce(now);
+                    vitals.time_before_reproduction = settings.reproduction_time;
+                    break;
+                }
+                if(!same_vitals(animal, vitals, settings, now))
+                    return false;
+            }
+            if(!animal.is_decomposed(now))
+            {
+                std::cerr << "animal " << id << " : pas decompose" << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//the rows of a table written after a header line (stats.txt, summary of a sweep), whose names may contain spaces
+static bool read_rows(std::string const& file_name, std::vector < std::vector <double> > &rows)
+{
+    std::ifstream file(file_name.c_str());
+    std::string line;
+    if(!file || !std::getline(file, line))
+    {
+        std::cerr << file_name << " n'a pas pu etre lu" << std::endl;
+        return false;
+    }
+    while(std::getline(file, line))
+    {
+        std::istringstream row(line);
+        rows.push_back(std::vector <double>());
+        double value = 0;
+        while(row >> value)
+            rows.back().push_back(value);
+    }
+    return true;
+}
+
+//the summary of a sweep of the seeds, after the same simulations run one by one
+static bool check_summary(Scenario const& scenario, std::string const& settings, std::string const& directory)
+{
+    int const duration = 10; //simulated seconds
+    int const columns = scenario.get_species_number() + scenario.get_resources_number();
+    char const* seeds[] = {"1,1,1", "1,2"};
+    std::vector < std::vector <double> > summaries[2];
+    for(int s = 0; s < 2; s++)
+    {
+        std::string name = directory + "/summary_" + std::to_string(s);
+        std::ofstream file((name + ".sweep").c_str());
+        file << "settings=" << settings << "\nduration=" << duration << "\nstep=" << STEP << "\nseeds=" << seeds[s] << "\n";
+        file << "output=" << name << "_runs.txt\nsummary=" << name << ".txt\n";
+        file.close();
+        Sweep sweep;
+        if(!sweep.load(name + ".sweep") || !sweep.run() || !read_rows(name + ".txt", summaries[s]))
+            return false;
+    }
+
+    //the stats.txt of the seeds 1 and 2 simulated alone, with the series it leaves out (always 0)
+    std::vector < std::vector <double> > stats[2];
+    for(int seed = 1; seed <= 2; seed++)
+    {
+        World world(scenario, seed);
+        world.generate();
+        while(!world.get_stats().has_finished(duration))
+            world.update(STEP);
+        std::string file_name = directory + "/simulation_" + std::to_string(90 + seed) + "/stats.txt";
+        std::vector < std::vector <double> > rows;
+        if(!world.get_stats().save(directory, 90 + seed) || !read_rows(file_name, rows) || rows.empty())
+            return false;
+        std::vector < std::vector <int> > const& values = world.get_stats().get_values();
+        std::vector <bool> shown(columns, false);
+        for(int t = 0; t < values.size(); t++)
+            for(int i = 0; i < columns; i++)
+                shown[i] = shown[i] || values[t][i] > 0;
+        for(int t = 0; t < rows.size(); t++)
+        {
+            stats[seed - 1].push_back(std::vector <double>(columns, 0));
+            for(int i = 0, k = 1; i < columns; i++)
+                if(shown[i] && k < rows[t].size())
+                    stats[seed - 1][t][i] = rows[t][k++];
+        }
+    }
+
+    //the same seed three times: the mean of the replicates is the run, without width
+    //two seeds: Student's t with one degree of freedom, mean +- 12.706 * s / sqrt(2), where s = |a - b| / sqrt(2)
+    for(int s = 0; s < 2; s++)
+    {
+        if(summaries[s].size() < stats[0].size() || stats[1].size() != stats[0].size())
+        {
+            std::cerr << "graines " << seeds[s] << " : " << summaries[s].size() << " secondes dans le resume au lieu de " << stats[0].size() << std::endl;
+            return false;
+        }
+        for(int t = 0; t < stats[0].size(); t++)
+        {
+            std::vector <double> const& row = summaries[s][t]; //configuration, time, replicates, then the mean and the bounds of each column
+            if(row.size() != 3 + 3 * columns || row[1] != t || row[2] != (s ? 2 : 3))
+            {
+                std::cerr << "graines " << seeds[s] << " : ligne " << t << " du resume invalide" << std::endl;
+                return false;
+            }
+            for(int i = 0; i < columns; i++)
+            {
+                double a = stats[0][t][i], b = stats[1][t][i];
+                double expected = s ? (a + b) / 2 : a;
+                double margin = s ? 12.706 * std::fabs(a - b) / 2 : 0;
+                double mean = row[3 + 3 * i], low = row[4 + 3 * i], high = row[5 + 3 * i];
+                if(std::fabs(mean - expected) > 0.006 || std::fabs(low - (expected - margin)) > 0.006 || std::fabs(high - (expected + margin)) > 0.006)
+                {
+                    std::cerr << "graines " << seeds[s] << ", colonne " << i + 1 << " a " << t << " s : " << mean << " [" << low << ", " << high << "] au lieu de "
+                              << expected << " [" << expected - margin << ", " << expected + margin << "]" << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+//the nearest plant found through the fields of the map is the one a scan of the detection window finds
+class PlantSearchCheck
+{
+public:
+    static bool check(Scenario const& scenario)
+    {
+        World world(scenario, 1);
+        world.generate();
+        Map &map = world.get_map();
+        std::vector <int> before = get_resources(map);
+        run(world, 60);
+        std::vector <int> after = get_resources(map);
+        int appeared = 0, eaten = 0;
+        for(int i = 0; i < before.size(); i++)
+        {
+            appeared += !before[i] && after[i];
+            eaten += before[i] && !after[i];
+        }
+        if(!appeared || !eaten)
+        {
+            std::cerr << appeared << " plantes apparues, " << eaten << " mangees" << std::endl;
+            return false;
+        }
+
+        std::vector <int> herbivores;
+        for(int specie = 1; specie <= scenario.get_species_number(); specie++)
+            if(scenario.species[specie - 1].plants.size())
+                herbivores.push_back(specie);
+        if(herbivores.empty())
+            return false;
+
+        Population &population = world.get_population();
+        Random random(7);
+        for(int i = 0; i < 2000; i++)
+        {
+            int specie = herbivores[random_int(random, herbivores.size(), 0, i, 0, 0)];
+            Vector2d pos = {random_int(random, scenario.width * 100, 0, i, 0, 1) / 100.0, random_int(random, scenario.height * 100, 0, i, 0, 2) / 100.0};
+            Tile tile(false);
+            Animal animal(i, pos, specie, scenario.species[specie - 1], random, world.get_time());
+            tile.animals.push_back(&animal);
+
+            //the scan of every block of the detection window
+            int range = animal.get_plant_range_detection();
+            double shortest = -1;
+            for(int x = std::max(0, int(pos.x - range)); x < std::min(scenario.width, int(pos.x + range) + 1); x++)
+            {
+                for(int y = std::max(0, int(pos.y - range)); y < std::min(scenario.height, int(pos.y + range) + 1); y++)
+                {
+                    double distance = sqrt(pow(x + 0.5 - pos.x, 2) + pow(y + 0.5 - pos.y, 2));
+                    if(animal.is_my_plant(map.get_resource(x, y)) && distance <= range && (shortest < 0 || distance < shortest))
+                        shortest = distance;
+                }
+            }
+
+            bool found = population.AI_find_plant(tile, 0, map);
+            if(found != (shortest >= 0))
+            {
+                std::cerr << "espece " << specie << " en " << pos.x << "," << pos.y << " : plante " << (found ? "trouvee" : "pas trouvee") << " au lieu de l'inverse" << std::endl;
+                return false;
+            }
+            if(!found)
+                continue;
+
+            //the destination is the plant, or midway to it
+            Vector2d dest = animal.get_destination();
+            SDL_Point plant = {int(floor(2 * dest.x - pos.x)), int(floor(2 * dest.y - pos.y))};
+            Vector2d center = {plant.x + 0.5, plant.y + 0.5};
+            Vector2d midway = population.AI_midway(pos, center);
+            if(midway.x != dest.x || midway.y != dest.y)
+                plant = {int(dest.x), int(dest.y)};
+            double distance = sqrt(pow(plant.x + 0.5 - pos.x, 2) + pow(plant.y + 0.5 - pos.y, 2));
+            if(!animal.is_my_plant(map.get_resource(plant.x, plant.y)) || distance > shortest + 1)
+            {
+                std::cerr << "espece " << specie << " en " << pos.x << "," << pos.y << " : plante en " << plant.x << "," << plant.y << " a " << distance << " au lieu de " << shortest << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    static std::vector <int> get_resources(Map const& map)
+    {
+        SDL_Point size = map.get_size();
+        std::vector <int> resources;
+        for(int x = 0; x < size.x; x++)
+            for(int y = 0; y < size.y; y++)
+                resources.push_back(map.get_resource(x, y));
+        return resources;
+    }
+};
+
+static bool check_find_plant(Scenario const& scenario, std::string const&)
+{
+    return PlantSearchCheck::check(scenario);
+}
+
+template <typename T>
+static bool same_setting(T const& a, T const& b, std::string const& name)
+{
+    if(a != b)
+        std::cerr << name << " differe une fois compile" << std::endl;
+    return a == b;
+}
+
+//the scenario compiled by scenario_compile loads every setting of the directory it comes from
+static bool check_scenario(Scenario const& scenario, std::string const& directory)
+{
+    Scenario compiled;
+    if(!scenario.save_compiled(directory + "/scenario.bin") || !compiled.load(directory + "/scenario.bin"))
+    {
+        for(int i = 0; i < compiled.get_errors().size(); i++)
+            std::cerr << compiled.get_errors()[i] << std::endl;
+        return false;
+    }
+
+    bool same = same_setting(scenario.width, compiled.width, "width") && same_setting(scenario.height, compiled.height, "height")
+        && same_setting(scenario.biome_percent, compiled.biome_percent, "biome_percent")
+        && same_setting(scenario.species_init, compiled.species_init, "species_init")
+        && same_setting(scenario.species_name, compiled.species_name, "species_name")
+        && same_setting(scenario.resources_init, compiled.resources_init, "resources_init")
+        && same_setting(scenario.resources_name, compiled.resources_name, "resources_name")
+        && same_setting(scenario.nutritional_value, compiled.nutritional_value, "nutritional_value")
+        && same_setting(scenario.blood_disappearance_time, compiled.blood_disappearance_time, "blood_disappearance_time")
+        && same_setting(scenario.scent.cell, compiled.scent.cell, "scent.cell")
+        && same_setting(scenario.scent.diffusion, compiled.scent.diffusion, "scent.diffusion")
+        && same_setting(scenario.scent.decay, compiled.scent.decay, "scent.decay")
+        && same_setting(scenario.scent.contact_range, compiled.scent.contact_range, "scent.contact_range")
+        && same_setting(scenario.species.size(), compiled.species.size(), "species")
+        && same_setting(scenario.resources.size(), compiled.resources.size(), "resources");
+    for(int i = 0; same && i < scenario.species.size(); i++)
+    {
+        SpecieSettings const& a = scenario.species[i];
+        SpecieSettings const& b = compiled.species[i];
+        std::string name = "specie_" + std::to_string(i + 1) + ".";
+        same = same_setting(a.damage, b.damage, name + "damage") && same_setting(a.speed, b.speed, name + "speed")
+            && same_setting(a.life_expectancy, b.life_expectancy, name + "life_expectancy")
+            && same_setting(a.maximum_health, b.maximum_health, name + "maximum_health")
+            && same_setting(a.hunger_threshold, b.hunger_threshold, name + "hunger_threshold")
+            && same_setting(a.satiated_threshold, b.satiated_threshold, name + "satiated_threshold")
+            && same_setting(a.agressive, b.agressive, name + "agressive")
+            && same_setting(a.plant_range_detection, b.plant_range_detection, name + "plant_range_detection")
+            && same_setting(a.prey_range_detection, b.prey_range_detection, name + "prey_range_detection")
+            && same_setting(a.partner_range_detection, b.partner_range_detection, name + "partner_range_detection")
+            && same_setting(a.agressivity_range, b.agressivity_range, name + "agressivity_range")
+            && same_setting(a.search_distance, b.search_distance, name + "search_distance")
+            && same_setting(a.reproduction_time, b.reproduction_time, name + "reproduction_time")
+            && same_setting(a.decomposition_time, b.decomposition_time, name + "decomposition_time")
+            && same_setting(a.plants, b.plants, name + "plants") && same_setting(a.preys, b.preys, name + "preys")
+            && same_setting(a.colors, b.colors, name + "colors");
+    }
+    for(int i = 0; same && i < scenario.resources.size(); i++)
+    {
+        ResourceSettings const& a = scenario.resources[i];
+        ResourceSettings const& b = compiled.resources[i];
+        std::string name = "resource_" + std::to_string(i + 1) + ".";
+        same = same_setting(a.location, b.location, name + "location") && same_setting(a.adaptive, b.adaptive, name + "adaptive")
+            && same_setting(a.target, b.target, name + "target") && same_setting(a.add, b.add, name + "add");
+    }
+    return same;
+}
+
+//the stream written during the simulation converts to the stats.txt saved at its end
+static bool check_stats_stream(Scenario const& scenario, std::string const& directory)
+{
+    {
+        World world(scenario, 1);
+        world.generate();
+        if(!world.get_stats().stream(directory, 99))
+            return false;
+        run(world, 20);
+        if(!world.get_stats().save(directory, 99))
+            return false;
+    } //the stream is closed with the world
+    return convert_stats_stream(directory + "/stats_99.bin", directory + "/stats_99.txt")
+        && same_files(directory + "/simulation_99/stats.txt", directory + "/stats_99.txt");
+}
+
+//the summed-area tables count the same animals as a scan of all of them
+static bool check_density(Scenario const& scenario, std::string const&)
+{
+    World world(scenario, 1);
+    world.set_density(7, STEP); //rebuilt at every step, like the scan
+    world.generate();
+    world.get_density(); //created before the run, then rebuilt by the updates
+    run(world, 10);
+
+    DensityMap const& density = world.get_density();
+    std::vector <Animal*> const& animals = world.get_population().get_animals();
+    int cell = density.get_cell();
+    Random random(3);
+    for(int i = 0; i < 1000; i++)
+    {
+        SDL_Rect area;
+        area.x = random_int(random, scenario.width + 20, 0, i, 0, 0) - 10;
+        area.y = random_int(random, scenario.height + 20, 0, i, 0, 1) - 10;
+        area.w = random_int(random, scenario.width / 2, 0, i, 0, 2);
+        area.h = random_int(random, scenario.height / 2, 0, i, 0, 3);
+        SDL_Rect cells = density.get_cells(area);
+        for(int specie = 0; specie <= scenario.get_species_number(); specie++)
+        {
+            int expected = 0;
+            for(int a = 0; a < animals.size(); a++)
+            {
+                Animal const& animal = *animals[a];
+                int x = int(animal.get_position().x) / cell, y = int(animal.get_position().y) / cell;
+                if(animal.is_alive(world.get_time()) && (!specie || animal.get_specie() == specie) && x >= cells.x && x < cells.x + cells.w && y >= cells.y && y < cells.y + cells.h)
+                    expected += 1;
+            }
+            if(density.count(specie, area) != expected)
+            {
+                std::cerr << "zone " << area.x << "," << area.y << "," << area.w << "," << area.h << ", espece " << specie << " : " << density.count(specie, area) << " au lieu de " << expected << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//at each keyframe, the replay has the populations of the recorded stats, and between two keyframes the health of the animals
+static bool check_replay(Scenario const& scenario, std::string const& directory)
+{
+    int const keyframes = 5, seconds = 30, between = 17; //seconds
+    std::map <int, int> healths; //of the animals alive at the second "between", by id
+    {
+        World world(scenario, 1);
+        world.generate();
+        if(!world.record(directory + "/check.swlog", keyframes))
+            return false;
+        run(world, between);
+        std::vector <Animal*> const& animals = world.get_population().get_animals();
+        for(int a = 0; a < animals.size(); a++)
+            if(animals[a]->is_alive(world.get_time()))
+                healths[animals[a]->get_id()] = animals[a]->get_health(world.get_time());
+        run(world, seconds - between);
+    } //the end of the log is written with the world
+
+    Replay replay(scenario);
+    if(!replay.open(directory + "/check.swlog"))
+        return false;
+    std::vector < std::vector <int> > const& rows = replay.get_rows();
+    if(replay.get_keyframes_number() < seconds / keyframes)
+    {
+        std::cerr << replay.get_keyframes_number() << " images cles" << std::endl;
+        return false;
+    }
+    for(int k = 0; k < replay.get_keyframes_number(); k++)
+    {
+        int time = k * keyframes;
+        if(time >= rows.size())
+            break;
+        replay.seek(time * 1000);
+        for(int specie = 1; specie <= scenario.get_species_number(); specie++)
+        {
+            if(replay.get_number(specie) != rows[time][specie - 1])
+            {
+                std::cerr << time << " s, espece " << specie << " : " << replay.get_number(specie) << " au lieu de " << rows[time][specie - 1] << std::endl;
+                return false;
+            }
+        }
+    }
+
+    Snapshot snapshot;
+    SDL_Rect area = {0, 0, scenario.width, scenario.height};
+    replay.seek(between * 1000);
+    replay.snapshot(area, snapshot);
+    for(std::map <int, int>::const_iterator it = healths.begin(); it != healths.end(); ++it)
+    {
+        AnimalSnapshot const* animal = snapshot.get_animal(it->first);
+        if(!animal || animal->health != it->second)
+        {
+            std::cerr << between << " s, animal " << it->first << " : sante " << (animal ? animal->health : -1) << " au lieu de " << it->second << std::endl;
+            return false;
+        }
+    }
+    return !replay.get_error();
+}
+
+struct TrajectoryRecord //of an animal, as written in the trajectories
+{
+    float x, y;
+    int health, specie;
+    bool seen;
+};
+
+//the records of a step read back from the trajectories are the animals of the population at that step
+static bool check_trajectories(Scenario const& scenario, std::string const& directory)
+{
+    int const seconds = 10, recorded = 3000; //ms
+    std::map <int, TrajectoryRecord> expected; //by id
+    {
+        World world(scenario, 1);
+        world.generate();
+        if(!world.dump_trajectories(directory + "/check.swtraj", 1, std::vector <int>()))
+            return false;
+        run(world, recorded / 1000);
+        std::vector <Animal*> const& animals = world.get_population().get_animals();
+        for(int a = 0; a < animals.size(); a++)
+        {
+            Animal const& animal = *animals[a];
+            TrajectoryRecord record = {float(animal.get_position().x), float(animal.get_position().y), animal.get_health(world.get_time()), animal.get_specie(), false};
+            expected[animal.get_id()] = record;
+        }
+        run(world, seconds - recorded / 1000);
+    } //the last chunk is written with the world
+
+    TrajectoryReader reader;
+    if(!reader.open(directory + "/check.swtraj"))
+        return false;
+    int found = 0;
+    for(int c = 0; c < reader.get_chunks_number(); c++)
+    {
+        TrajectoryChunk chunk = reader.get_chunk(c);
+        if(chunk.first_time > recorded || chunk.last_time < recorded)
+            continue;
+        for(int r = 0; r < chunk.count; r++)
+        {
+            if(chunk.time[r] != recorded)
+                continue;
+            std::map <int, TrajectoryRecord>::iterator it = expected.find(chunk.id[r]);
+            if(it == expected.end() || it->second.seen || chunk.x[r] != it->second.x || chunk.y[r] != it->second.y
+               || chunk.health[r] != it->second.health || chunk.specie[r] != it->second.specie)
+            {
+                std::cerr << recorded << " ms, animal " << chunk.id[r] << " : " << chunk.x[r] << "," << chunk.y[r] << ", sante " << chunk.health[r]
+                          << (it == expected.end() ? " (inconnu)" : it->second.seen ? " (en double)" : "") << std::endl;
+                return false;
+            }
+            it->second.seen = true;
+            found += 1;
+        }
+    }
+    if(found != expected.size())
+    {
+        std::cerr << recorded << " ms : " << found << " animaux relus au lieu de " << expected.size() << std::endl;
+        return false;
+    }
+    return found > 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 3)
+    {
+        std::cerr << "usage: simuworld_tests <checkpoint|threads|cluster|vitals|find_plant|scenario|summary|stats_stream|density|replay|trajectories> <directory> [settings]" << std::endl;
+        return 1;
+    }
+
+    std::string settings = argc > 3 ? argv[3] : "settings";
+    Scenario scenario;
+    if(!scenario.load(settings))
+    {
+        for(int i = 0; i < scenario.get_errors().size(); i++)
+            std::cerr << scenario.get_errors()[i] << std::endl;
+        return 1;
+    }
+
+    std::string check = argv[1], directory = argv[2];
+    bool passed = false;
+    if(check == "checkpoint")
+        passed = check_checkpoint(scenario, directory);
+    else if(check == "threads")
+        passed = check_threads(scenario, directory);
+    else if(check == "cluster")
+        passed = check_cluster(scenario, settings);
+    else if(check == "vitals")
+        passed = check_vitals(scenario, directory);
+    else if(check == "find_plant")
+        passed = check_find_plant(scenario, directory);
+    else if(check == "scenario")
+        passed = check_scenario(scenario, directory);
+    else if(check == "summary")
+        passed = check_summary(scenario, settings, directory);
+    else if(check == "stats_stream")
+        passed = check_stats_stream(scenario, directory);
+    else if(check == "density")
+        passed = check_density(scenario, directory);
+    else if(check == "replay")
+        passed = check_replay(scenario, directory);
+    else if(check == "trajectories")
+        passed = check_trajectories(scenario, directory);
+    else
+    {
+        std::cerr << "verification inconnue : " << check << std::endl;
+        return 1;
+    }
+
+    std::cout << check << (passed ? " : ok" : " : echec") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+#include <iostream>
+#include <string>
+#include "StatsWriter.hpp"
+
+//converts a binary stats stream (written during the simulation) into the stats.txt format
+//with --all, the distributions of the species are kept after the counts
+int main(int argc, char *argv[])
+{
+    bool all_series = argc == 4 && std::string(argv[3]) == "--all";
+    if(argc != 3 && !all_series)
+    {
+        std::cerr << "usage: stats_convert <stats_N.bin> <stats.txt> [--all]" << std::endl;
+        return 1;
+    }
+
+    if(!convert_stats_stream(argv[1], argv[2], all_series))
+    {
+        std::cerr << argv[1] << " n'a pas pu etre converti" << std::endl;
+        return 1;
+    }
+    return 0;
+}
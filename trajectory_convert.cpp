@@ -0,0 +1,43 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include "Trajectory.hpp"
+
+//converts a trajectory file (written by simuworld_headless --trajectories) into a csv file, one line per record
+//the analyses of large files should rather use TrajectoryReader, which reads the columns without any conversion
+int main(int argc, char *argv[])
+{
+    if(argc != 3 && argc != 5)
+    {
+        std::cerr << "usage: trajectory_convert <file.swtraj> <file.csv> [--specie N]" << std::endl;
+        return 1;
+    }
+    int specie = argc == 5 && std::string(argv[3]) == "--specie" ? std::stoi(argv[4]) : 0;
+
+    TrajectoryReader reader;
+    if(!reader.open(argv[1]))
+    {
+        std::cerr << argv[1] << " n'a pas pu etre lu" << std::endl;
+        return 1;
+    }
+    std::ofstream file(argv[2]);
+    file << "time;id;specie;x;y;health;alive;male;hungry\n";
+    for(int c = 0; c < reader.get_chunks_number(); c++)
+    {
+        TrajectoryChunk chunk = reader.get_chunk(c);
+        for(uint32_t i = 0; i < chunk.count; i++)
+        {
+            if(specie && chunk.specie[i] != specie)
+                continue;
+            file << chunk.time[i] << ';' << chunk.id[i] << ';' << chunk.specie[i] << ';' << chunk.x[i] << ';' << chunk.y[i] << ';' << chunk.health[i] << ';'
+                 << bool(chunk.flags[i] & TRAJECTORY_ALIVE) << ';' << bool(chunk.flags[i] & TRAJECTORY_MALE) << ';' << bool(chunk.flags[i] & TRAJECTORY_HUNGRY) << '\n';
+        }
+    }
+    if(!file)
+    {
+        std::cerr << argv[2] << " n'a pas pu etre ecrit" << std::endl;
+        return 1;
+    }
+    std::cout << reader.get_records_number() << " enregistrements, " << reader.get_chunks_number() << " blocs" << std::endl;
+    return 0;
+}